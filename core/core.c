@@ -12,8 +12,9 @@
 #include "spp/services/databank/databank.h"
 #include "spp/services/pubsub/pubsub.h"
 #include "spp/services/log/log.h"
+#include "spp/services/segment/segment.h"
 
-#include <stdio.h>
+#include <string.h>
 
 /* ----------------------------------------------------------------
  * Private state
@@ -81,7 +82,8 @@ static spp_bool_t   s_logBusy = false;
 static void coreLogOutput(const char *p_tag, SPP_LogLevel_t level, const char *p_message)
 {
     static const char k_lvl[] = "?EWID V";
-    char lvlChar = k_lvl[(unsigned)level < sizeof(k_lvl) ? (unsigned)level : 0U];
+    char              prefix[4] = { '[', '?', ']', ' ' };
+    SPP_SegmentPart_t parts[4];
 
     if (s_logBusy)
     {
@@ -89,18 +91,27 @@ static void coreLogOutput(const char *p_tag, SPP_LogLevel_t level, const char *p
     }
     s_logBusy = true;
 
-    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
-    if (p_pkt != NULL)
+    prefix[1] = k_lvl[(unsigned)level < sizeof(k_lvl) ? (unsigned)level : 0U];
+    if (p_tag == NULL)
     {
-        char buf[K_SPP_PKT_PAYLOAD_MAX];
-        int n = snprintf(buf, sizeof(buf), "[%c] %s: %s", lvlChar, p_tag, p_message);
-        spp_uint16_t len =
-            (n > 0 && n < (int)sizeof(buf)) ? (spp_uint16_t)(n + 1U) : (spp_uint16_t)sizeof(buf);
-
-        (void)SPP_SERVICES_DATABANK_packetData(p_pkt, K_SPP_APID_LOG, s_logSeq++, buf, len);
-        (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+        p_tag = "";
     }
 
+    /* "[L] TAG: message\0", assembled straight into the leased packets: no
+     * line buffer on the caller's stack.  Short lines land in the smallest
+     * class that fits; longer ones go out as FIRST/…/LAST segments.
+     * Charged to K_SPP_APID_LOG so a quota can keep log storms from
+     * starving sensor producers. */
+    parts[0].p_data = prefix;
+    parts[0].len    = (spp_uint32_t)sizeof(prefix);
+    parts[1].p_data = p_tag;
+    parts[1].len    = (spp_uint32_t)strlen(p_tag);
+    parts[2].p_data = ": ";
+    parts[2].len    = 2U;
+    parts[3].p_data = p_message;
+    parts[3].len    = (spp_uint32_t)strlen(p_message) + 1U;
+    (void)SPP_SERVICES_SEGMENT_publishParts(K_SPP_APID_LOG, &s_logSeq, parts, 4U);
+
     s_logBusy = false;
 }
 
@@ -15,6 +15,13 @@
 #define SPP_PACKET_H
 
 #include "spp/core/types.h"
+#include "spp/util/macros.h"
+
+#include <stddef.h>
+
+#if SPP_PUBSUB_MPSC
+#include <stdatomic.h>
+#endif
 
 /* ----------------------------------------------------------------
  * Packet constants
@@ -23,8 +30,44 @@
 /** @brief Current SPP protocol version embedded in each packet. */
 #define K_SPP_PKT_VERSION     (1U)
 
-/** @brief Maximum payload size in bytes per packet. */
-#define K_SPP_PKT_PAYLOAD_MAX (48U)
+/**
+ * @brief Largest payload any packet can carry (bytes).
+ *
+ * Only the largest databank size class is this big; a pool packet has just
+ * SPP_SERVICES_DATABANK_payloadCapacity() bytes of payload storage.
+ */
+#ifndef K_SPP_PKT_PAYLOAD_MAX
+#define K_SPP_PKT_PAYLOAD_MAX (256U)
+#endif
+
+/* ----------------------------------------------------------------
+ * Segmentation flags (primaryHeader.seqFlags, CCSDS sequence flags)
+ * ---------------------------------------------------------------- */
+
+/** @brief Middle segment of a segmented record. */
+#define K_SPP_PKT_SEQ_CONTINUATION (0U)
+
+/** @brief First segment of a segmented record. */
+#define K_SPP_PKT_SEQ_FIRST        (1U)
+
+/** @brief Last segment of a segmented record. */
+#define K_SPP_PKT_SEQ_LAST         (2U)
+
+/** @brief Complete record in a single packet (default). */
+#define K_SPP_PKT_SEQ_UNSEGMENTED  (3U)
+
+/* ----------------------------------------------------------------
+ * APID space
+ * ---------------------------------------------------------------- */
+
+/** @brief Width of the APID field, as in the CCSDS primary header. */
+#define K_SPP_APID_BITS  (11U)
+
+/** @brief Number of APID values (0 … K_SPP_APID_MAX). */
+#define K_SPP_APID_COUNT (1U << K_SPP_APID_BITS)
+
+/** @brief Highest valid APID.  APID 0 is K_SPP_APID_NONE. */
+#define K_SPP_APID_MAX   (K_SPP_APID_COUNT - 1U)
 
 /* ----------------------------------------------------------------
  * Reserved APIDs
@@ -43,7 +86,8 @@
 typedef struct
 {
     spp_uint8_t  version;     /**< Protocol version (= K_SPP_PKT_VERSION).        */
-    spp_uint16_t apid;        /**< Application Process Identifier.                */
+    spp_uint8_t  seqFlags;    /**< K_SPP_PKT_SEQ_* segmentation flags.            */
+    spp_uint16_t apid;        /**< Application Process Identifier (11-bit).       */
     spp_uint16_t seq;         /**< Packet sequence counter (wraps at UINT16_MAX). */
     spp_uint16_t payloadLen;  /**< Length of the payload field in bytes.          */
 } SPP_PacketPrimary_t;
@@ -57,6 +101,33 @@ typedef struct
     spp_uint8_t  dropCounter; /**< Number of packets dropped since last reset. */
 } SPP_PacketSecondary_t;
 
+/* ----------------------------------------------------------------
+ * Queue link
+ * ---------------------------------------------------------------- */
+
+/** @brief Intrusive queues a packet can sit in at once (one per deferred
+ *  pub/sub priority level). */
+#define K_SPP_PKT_LINK_LEVELS (3U)
+
+/**
+ * @brief Intrusive queue link carried by every packet.
+ *
+ * Owned by pub/sub while the packet waits for deferred subscribers, so the
+ * deferred queues need no storage of their own and can hold every packet
+ * of the pool.  Not part of the wire format and not covered by the CRC;
+ * producers and consumers never touch it.
+ */
+typedef struct SPP_PacketLink
+{
+    struct SPP_PacketLink *p_next[K_SPP_PKT_LINK_LEVELS]; /**< Successor in each level's queue. */
+    spp_uint32_t           pending; /**< Subscribers still to be called.      */
+    spp_uint32_t           pubUs;   /**< Publish time, when pub/sub needs it. */
+    spp_uint8_t            levels;  /**< Bit n set while queued at level n.   */
+#if SPP_PUBSUB_MPSC
+    struct SPP_PacketLink *_Atomic p_intake; /**< Successor in the MPSC intake. */
+#endif
+} SPP_PacketLink_t;
+
 /* ----------------------------------------------------------------
  * Full packet type
  * ---------------------------------------------------------------- */
@@ -67,13 +138,26 @@ typedef struct
  * Producers fill @c primaryHeader, @c secondaryHeader, and @c payload, then
  * push the packet into the @c db_flow FIFO.  Consumers pop it, process it,
  * and return it to the databank.
+ *
+ * @c payload is declared at its maximum size, but databank packets are cut
+ * to their size class: only the first
+ * SPP_SERVICES_DATABANK_payloadCapacity() bytes exist.  Never copy, zero or
+ * take @c sizeof a whole pool packet — use @ref K_SPP_PKT_HEADER_SIZE plus
+ * @c primaryHeader.payloadLen.
+ *
+ * @c payload is 4-byte aligned so producers can write floats and 32-bit
+ * samples straight into it (see SPP_SERVICES_DATABANK_packetBegin()).
  */
 typedef struct
 {
     SPP_PacketPrimary_t   primaryHeader;          /**< Routing / framing header.  */
     SPP_PacketSecondary_t secondaryHeader;         /**< Timing / metadata header.  */
-    spp_uint8_t           payload[K_SPP_PKT_PAYLOAD_MAX]; /**< Raw payload bytes. */
-    spp_uint16_t          crc;                    /**< CRC-16 over the full packet (0 = not computed). */
+    spp_uint16_t          crc;                    /**< CRC-16 over headers + payload (0 = not computed). */
+    SPP_PacketLink_t      link;                   /**< Pub/sub queue linkage (private).  */
+    _Alignas(4) spp_uint8_t payload[K_SPP_PKT_PAYLOAD_MAX]; /**< Raw payload bytes (size-class bound, 4-byte aligned). */
 } SPP_Packet_t;
 
+/** @brief Bytes in front of the payload (headers, CRC, queue link and padding). */
+#define K_SPP_PKT_HEADER_SIZE ((spp_uint32_t)offsetof(SPP_Packet_t, payload))
+
 #endif /* SPP_PACKET_H */
@@ -122,6 +122,48 @@ SPP_RetVal_t SPP_HAL_storageUnmount(void *p_cfg)
     return p_port->storageUnmount(p_cfg);
 }
 
+void *SPP_HAL_storageOpen(const char *p_path)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port == NULL) || (p_port->storageOpen == NULL))
+    {
+        return NULL;
+    }
+    return p_port->storageOpen(p_path);
+}
+
+SPP_RetVal_t SPP_HAL_storageWrite(void *p_file, spp_uint32_t offset,
+                                  const void *p_data, spp_uint32_t len)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port == NULL) || (p_port->storageWrite == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NO_PORT);
+    }
+    return p_port->storageWrite(p_file, offset, p_data, len);
+}
+
+SPP_RetVal_t SPP_HAL_storageRead(void *p_file, spp_uint32_t offset,
+                                 void *p_data, spp_uint32_t len)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port == NULL) || (p_port->storageRead == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NO_PORT);
+    }
+    return p_port->storageRead(p_file, offset, p_data, len);
+}
+
+SPP_RetVal_t SPP_HAL_storageClose(void *p_file)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port == NULL) || (p_port->storageClose == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NO_PORT);
+    }
+    return p_port->storageClose(p_file);
+}
+
 /* ----------------------------------------------------------------
  * Time dispatch
  * ---------------------------------------------------------------- */
@@ -136,6 +178,16 @@ spp_uint32_t SPP_HAL_getTimeMs(void)
     return p_port->getTimeMs();
 }
 
+spp_uint32_t SPP_HAL_getTimeUs(void)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port != NULL) && (p_port->getTimeUs != NULL))
+    {
+        return p_port->getTimeUs();
+    }
+    return SPP_HAL_getTimeMs() * 1000U;
+}
+
 void SPP_HAL_delayMs(spp_uint32_t ms)
 {
     const SPP_HalPort_t *p_port = getPort();
@@ -144,3 +196,15 @@ void SPP_HAL_delayMs(spp_uint32_t ms)
         p_port->delayMs(ms);
     }
 }
+
+SPP_RetVal_t SPP_HAL_waitEvent(spp_uint32_t maxMs)
+{
+    const SPP_HalPort_t *p_port = getPort();
+    if ((p_port == NULL) || (p_port->waitEvent == NULL))
+    {
+        /* Optional hook — not recorded as an error. */
+        return K_SPP_ERROR_NO_PORT;
+    }
+    p_port->waitEvent(maxMs);
+    return K_SPP_OK;
+}
@@ -22,10 +22,16 @@
  *
  * The ISR sets @c *p_flag to @c SPP_TRUE when the interrupt fires.
  * The application superloop polls this flag to detect the event.
+ *
+ * When @c p_readyMask is non-NULL the ISR also ORs @c readyBit into it,
+ * atomically, so the module registry only visits modules whose interrupt
+ * fired (see SPP_SERVICES_bindReady()).  Zero-initialise the context.
  */
 typedef struct
 {
-    volatile spp_bool_t *p_flag; /**< Flag set by the ISR on interrupt. */
+    volatile spp_bool_t   *p_flag;      /**< Flag set by the ISR on interrupt.    */
+    volatile spp_uint32_t *p_readyMask; /**< Registry ready mask, or NULL.        */
+    spp_uint32_t           readyBit;    /**< Bit the ISR sets in *p_readyMask.    */
 } SPP_GpioIsrCtx_t;
 
 /* ----------------------------------------------------------------
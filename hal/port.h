@@ -121,6 +121,39 @@ typedef struct
      */
     SPP_RetVal_t (*storageUnmount)(void *p_cfg);
 
+    /**
+     * @brief Create (or truncate) a file for reading and writing.  NULL if
+     *        storage is not used.
+     *
+     * @param[in] p_path  File path on the mounted filesystem.
+     *
+     * @return Opaque file handle, or NULL on failure.
+     */
+    void *(*storageOpen)(const char *p_path);
+
+    /**
+     * @brief Write @p len bytes at byte @p offset, growing the file as needed.
+     *
+     * @return K_SPP_OK only if every byte was written.
+     */
+    SPP_RetVal_t (*storageWrite)(void *p_file, spp_uint32_t offset,
+                                 const void *p_data, spp_uint32_t len);
+
+    /**
+     * @brief Read @p len bytes from byte @p offset.
+     *
+     * @return K_SPP_OK only if every byte was read.
+     */
+    SPP_RetVal_t (*storageRead)(void *p_file, spp_uint32_t offset,
+                                void *p_data, spp_uint32_t len);
+
+    /**
+     * @brief Close a file returned by @c storageOpen.
+     *
+     * @return K_SPP_OK on success.
+     */
+    SPP_RetVal_t (*storageClose)(void *p_file);
+
     /* ---- Time -------------------------------------------------- */
 
     /**
@@ -132,6 +165,17 @@ typedef struct
      */
     spp_uint32_t (*getTimeMs)(void);
 
+    /**
+     * @brief Return the current hardware time in microseconds (optional).
+     *
+     * Used for sub-millisecond budgets such as
+     * SPP_SERVICES_PUBSUB_callConsumersBudget().  May be NULL; the dispatcher
+     * then derives it from getTimeMs().  Wraps at UINT32_MAX (~71 min).
+     *
+     * @return Elapsed time in µs.
+     */
+    spp_uint32_t (*getTimeUs)(void);
+
     /**
      * @brief Block for the requested number of milliseconds.
      *
@@ -142,6 +186,18 @@ typedef struct
      */
     void (*delayMs)(spp_uint32_t ms);
 
+    /**
+     * @brief Sleep until a GPIO interrupt fires or @p maxMs pass (optional).
+     *
+     * Used by SPP_SERVICES_idle() when no module is ready and nothing is
+     * queued.  The port's GPIO ISR must end the wait, including an
+     * interrupt that fired after the previous wait returned.  Waking early
+     * is allowed.  NULL = the superloop never sleeps.
+     *
+     * @param[in] maxMs  Longest sleep in milliseconds.
+     */
+    void (*waitEvent)(spp_uint32_t maxMs);
+
 } SPP_HalPort_t;
 
 #endif /* SPP_HAL_PORT_H */
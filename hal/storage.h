@@ -39,4 +39,37 @@ SPP_RetVal_t SPP_HAL_storageMount(void *p_cfg);
  */
 SPP_RetVal_t SPP_HAL_storageUnmount(void *p_cfg);
 
+/**
+ * @brief Create (or truncate) a file for positional reads and writes.
+ *
+ * @param[in] p_path  File path on the mounted filesystem.
+ *
+ * @return Opaque file handle, or NULL on failure or when the port has no
+ *         file support.
+ */
+void *SPP_HAL_storageOpen(const char *p_path);
+
+/**
+ * @brief Write @p len bytes at byte @p offset of an open file.
+ *
+ * @return K_SPP_OK if every byte was written, K_SPP_ERROR otherwise.
+ */
+SPP_RetVal_t SPP_HAL_storageWrite(void *p_file, spp_uint32_t offset,
+                                  const void *p_data, spp_uint32_t len);
+
+/**
+ * @brief Read @p len bytes from byte @p offset of an open file.
+ *
+ * @return K_SPP_OK if every byte was read, K_SPP_ERROR otherwise.
+ */
+SPP_RetVal_t SPP_HAL_storageRead(void *p_file, spp_uint32_t offset,
+                                 void *p_data, spp_uint32_t len);
+
+/**
+ * @brief Close a file returned by @ref SPP_HAL_storageOpen().
+ *
+ * @return K_SPP_OK on success.
+ */
+SPP_RetVal_t SPP_HAL_storageClose(void *p_file);
+
 #endif /* SPP_HAL_STORAGE_H */
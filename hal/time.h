@@ -10,6 +10,7 @@
 #define SPP_HAL_TIME_H
 
 #include "spp/core/types.h"
+#include "spp/core/returnTypes.h"
 
 /* ----------------------------------------------------------------
  * Public API
@@ -22,6 +23,16 @@
  */
 spp_uint32_t SPP_HAL_getTimeMs(void);
 
+/**
+ * @brief Return the current hardware time in microseconds.
+ *
+ * Falls back to millisecond resolution when the port has no @c getTimeUs.
+ * Compare readings by unsigned subtraction — the value wraps.
+ *
+ * @return Elapsed time in µs.
+ */
+spp_uint32_t SPP_HAL_getTimeUs(void);
+
 /**
  * @brief Block for the requested number of milliseconds.
  *
@@ -29,4 +40,17 @@ spp_uint32_t SPP_HAL_getTimeMs(void);
  */
 void SPP_HAL_delayMs(spp_uint32_t ms);
 
+/**
+ * @brief Sleep until a GPIO interrupt fires or @p maxMs pass.
+ *
+ * May return early.  An interrupt that fired since the last wait ends the
+ * wait at once, so checking for work and then waiting loses no wake-up.
+ *
+ * @param[in] maxMs  Longest sleep in milliseconds.
+ *
+ * @return K_SPP_OK after waiting.
+ * @return K_SPP_ERROR_NO_PORT if the port cannot sleep (returns at once).
+ */
+SPP_RetVal_t SPP_HAL_waitEvent(spp_uint32_t maxMs);
+
 #endif /* SPP_HAL_TIME_H */
@@ -19,7 +19,9 @@
 #include "sdmmc_cmd.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_cpu.h"
 
+#include <stdio.h>
 #include <string.h>
 
 /* ----------------------------------------------------------------
@@ -166,10 +168,19 @@ static SPP_RetVal_t SPP_PORTS_HAL_ESP32_spiTransmit(void *p_handle, spp_uint8_t
  * GPIO
  * ---------------------------------------------------------------- */
 
+/* Set by every GPIO interrupt, cleared when waitEvent() returns. */
+static volatile spp_bool_t s_gpioEvent = false;
+
 static void IRAM_ATTR SPP_PORTS_HAL_ESP32_gpioIsr(void *p_arg)
 {
     SPP_GpioIsrCtx_t *p_ctx = (SPP_GpioIsrCtx_t *)p_arg;
     *p_ctx->p_flag = true;
+    if (p_ctx->p_readyMask != NULL)
+    {
+        /* The other core may be taking the mask in callProducers(). */
+        (void)__atomic_fetch_or(p_ctx->p_readyMask, p_ctx->readyBit, __ATOMIC_RELEASE);
+    }
+    s_gpioEvent = true;
 }
 
 static SPP_RetVal_t SPP_PORTS_HAL_ESP32_gpioConfigInterrupt(spp_uint32_t pin, spp_uint32_t intrType,
@@ -259,6 +270,41 @@ static SPP_RetVal_t SPP_PORTS_HAL_ESP32_storageUnmount(void *p_cfg)
     return (ret == ESP_OK) ? K_SPP_OK : K_SPP_ERROR;
 }
 
+/* Files on the mounted card, through the VFS. */
+static void *SPP_PORTS_HAL_ESP32_storageOpen(const char *p_path)
+{
+    return (p_path != NULL) ? (void *)fopen(p_path, "w+b") : NULL;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_ESP32_storageWrite(void *p_file, spp_uint32_t offset,
+                                                    const void *p_data, spp_uint32_t len)
+{
+    FILE *p_f = (FILE *)p_file;
+    if ((p_f == NULL) || (fseek(p_f, (long)offset, SEEK_SET) != 0) ||
+        (fwrite(p_data, 1U, len, p_f) != len))
+    {
+        return K_SPP_ERROR;
+    }
+    return K_SPP_OK;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_ESP32_storageRead(void *p_file, spp_uint32_t offset,
+                                                   void *p_data, spp_uint32_t len)
+{
+    FILE *p_f = (FILE *)p_file;
+    if ((p_f == NULL) || (fseek(p_f, (long)offset, SEEK_SET) != 0) ||
+        (fread(p_data, 1U, len, p_f) != len))
+    {
+        return K_SPP_ERROR;
+    }
+    return K_SPP_OK;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_ESP32_storageClose(void *p_file)
+{
+    return ((p_file != NULL) && (fclose((FILE *)p_file) == 0)) ? K_SPP_OK : K_SPP_ERROR;
+}
+
 /* ----------------------------------------------------------------
  * Time
  * ---------------------------------------------------------------- */
@@ -268,6 +314,11 @@ static spp_uint32_t SPP_PORTS_HAL_ESP32_getTimeMs(void)
     return (spp_uint32_t)(esp_timer_get_time() / 1000LL);
 }
 
+static spp_uint32_t SPP_PORTS_HAL_ESP32_getTimeUs(void)
+{
+    return (spp_uint32_t)esp_timer_get_time();
+}
+
 static void SPP_PORTS_HAL_ESP32_delayMs(spp_uint32_t ms)
 {
     spp_uint32_t start = SPP_PORTS_HAL_ESP32_getTimeMs();
@@ -276,6 +327,18 @@ static void SPP_PORTS_HAL_ESP32_delayMs(spp_uint32_t ms)
     }
 }
 
+/* Halt the core until the next interrupt (the tick wakes it at least once
+ * per tick) and stop at the first GPIO event or after maxMs. */
+static void SPP_PORTS_HAL_ESP32_waitEvent(spp_uint32_t maxMs)
+{
+    spp_uint32_t start = SPP_PORTS_HAL_ESP32_getTimeMs();
+    while (!s_gpioEvent && ((SPP_PORTS_HAL_ESP32_getTimeMs() - start) < maxMs))
+    {
+        esp_cpu_wait_for_intr();
+    }
+    s_gpioEvent = false;
+}
+
 /* ----------------------------------------------------------------
  * Port descriptor
  * ---------------------------------------------------------------- */
@@ -289,6 +352,12 @@ const SPP_HalPort_t g_esp32HalPort = {
     .gpioRegisterIsr     = SPP_PORTS_HAL_ESP32_gpioRegisterIsr,
     .storageMount        = SPP_PORTS_HAL_ESP32_storageMount,
     .storageUnmount      = SPP_PORTS_HAL_ESP32_storageUnmount,
+    .storageOpen         = SPP_PORTS_HAL_ESP32_storageOpen,
+    .storageWrite        = SPP_PORTS_HAL_ESP32_storageWrite,
+    .storageRead         = SPP_PORTS_HAL_ESP32_storageRead,
+    .storageClose        = SPP_PORTS_HAL_ESP32_storageClose,
     .getTimeMs           = SPP_PORTS_HAL_ESP32_getTimeMs,
+    .getTimeUs           = SPP_PORTS_HAL_ESP32_getTimeUs,
     .delayMs             = SPP_PORTS_HAL_ESP32_delayMs,
+    .waitEvent           = SPP_PORTS_HAL_ESP32_waitEvent,
 };
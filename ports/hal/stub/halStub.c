@@ -2,9 +2,10 @@
  * @file halStub.c
  * @brief Stub HAL port for host-side unit testing.
  *
- * All SPI, GPIO, and storage functions return K_SPP_OK without doing any real
+ * All SPI, GPIO, and mount functions return K_SPP_OK without doing any real
  * hardware access.  This allows the full SPP service layer to be exercised
- * on a development machine without an attached MCU.
+ * on a development machine without an attached MCU.  Storage files are
+ * ordinary host files.
  */
 
 #include "spp/hal/port.h"
@@ -12,6 +13,7 @@
 #include "spp/core/types.h"
 
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/time.h>
 
 /* ----------------------------------------------------------------
@@ -35,6 +37,41 @@ static SPP_RetVal_t SPP_PORTS_HAL_STUB_gpioRegisterIsr(spp_uint32_t pin, void *p
 static SPP_RetVal_t SPP_PORTS_HAL_STUB_storageMount(void *p_cfg)                             { (void)p_cfg; return K_SPP_OK; }
 static SPP_RetVal_t SPP_PORTS_HAL_STUB_storageUnmount(void *p_cfg)                           { (void)p_cfg; return K_SPP_OK; }
 
+/* Storage files — the posix port backs them with plain stdio files. */
+static void *SPP_PORTS_HAL_STUB_storageOpen(const char *p_path)
+{
+    return (p_path != NULL) ? (void *)fopen(p_path, "w+b") : NULL;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_STUB_storageWrite(void *p_file, spp_uint32_t offset,
+                                                    const void *p_data, spp_uint32_t len)
+{
+    FILE *p_f = (FILE *)p_file;
+    if ((p_f == NULL) || (fseek(p_f, (long)offset, SEEK_SET) != 0) ||
+        (fwrite(p_data, 1U, len, p_f) != len))
+    {
+        return K_SPP_ERROR;
+    }
+    return K_SPP_OK;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_STUB_storageRead(void *p_file, spp_uint32_t offset,
+                                                   void *p_data, spp_uint32_t len)
+{
+    FILE *p_f = (FILE *)p_file;
+    if ((p_f == NULL) || (fseek(p_f, (long)offset, SEEK_SET) != 0) ||
+        (fread(p_data, 1U, len, p_f) != len))
+    {
+        return K_SPP_ERROR;
+    }
+    return K_SPP_OK;
+}
+
+static SPP_RetVal_t SPP_PORTS_HAL_STUB_storageClose(void *p_file)
+{
+    return ((p_file != NULL) && (fclose((FILE *)p_file) == 0)) ? K_SPP_OK : K_SPP_ERROR;
+}
+
 static spp_uint32_t SPP_PORTS_HAL_STUB_getTimeMs(void)
 {
     struct timeval tv;
@@ -42,6 +79,13 @@ static spp_uint32_t SPP_PORTS_HAL_STUB_getTimeMs(void)
     return (spp_uint32_t)((tv.tv_sec * 1000UL) + (tv.tv_usec / 1000UL));
 }
 
+static spp_uint32_t SPP_PORTS_HAL_STUB_getTimeUs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (spp_uint32_t)((tv.tv_sec * 1000000UL) + tv.tv_usec);
+}
+
 static void SPP_PORTS_HAL_STUB_delayMs(spp_uint32_t ms) { (void)ms; }
 
 /* ----------------------------------------------------------------
@@ -57,6 +101,11 @@ const SPP_HalPort_t g_stubHalPort = {
     .gpioRegisterIsr     = SPP_PORTS_HAL_STUB_gpioRegisterIsr,
     .storageMount        = SPP_PORTS_HAL_STUB_storageMount,
     .storageUnmount      = SPP_PORTS_HAL_STUB_storageUnmount,
+    .storageOpen         = SPP_PORTS_HAL_STUB_storageOpen,
+    .storageWrite        = SPP_PORTS_HAL_STUB_storageWrite,
+    .storageRead         = SPP_PORTS_HAL_STUB_storageRead,
+    .storageClose        = SPP_PORTS_HAL_STUB_storageClose,
     .getTimeMs           = SPP_PORTS_HAL_STUB_getTimeMs,
+    .getTimeUs           = SPP_PORTS_HAL_STUB_getTimeUs,
     .delayMs             = SPP_PORTS_HAL_STUB_delayMs,
 };
@@ -0,0 +1,267 @@
+/**
+ * @file blackboard.c
+ * @brief Latest-value cache per APID, written from publish() under a seqlock.
+ */
+
+#include "spp/services/blackboard/blackboard.h"
+#include "spp/core/error.h"
+
+#include <string.h>
+
+#if SPP_PUBSUB_MPSC
+#include <stdatomic.h>
+#endif
+
+#if (K_SPP_BLACKBOARD_ENTRIES == 0U) || (K_SPP_BLACKBOARD_ENTRIES > 32U)
+#error "K_SPP_BLACKBOARD_ENTRIES must be 1..32"
+#endif
+
+/* ----------------------------------------------------------------
+ * Private types
+ * ---------------------------------------------------------------- */
+
+#if SPP_PUBSUB_MPSC
+/* Writers run in producer context on any core; every shared word is an
+ * atomic so a torn read is retried rather than undefined. */
+#define BOARD_ATOMIC        _Atomic
+#define BOARD_LOAD(p_w)     atomic_load_explicit((p_w), memory_order_relaxed)
+#define BOARD_STORE(p_w, v) atomic_store_explicit((p_w), (v), memory_order_relaxed)
+#else
+/* Writer and readers share one core; volatile keeps the compiler from
+ * moving the data accesses across the sequence updates, so a read that
+ * interrupts a write (or is interrupted by one) sees the sequence move. */
+#define BOARD_ATOMIC        volatile
+#define BOARD_LOAD(p_w)     (*(p_w))
+#define BOARD_STORE(p_w, v) (*(p_w) = (v))
+#endif
+
+#define K_BOARD_DATA_WORDS ((K_SPP_BLACKBOARD_PAYLOAD + 3U) / 4U)
+
+typedef struct
+{
+    BOARD_ATOMIC spp_uint32_t seq;                      /* Odd while a write is in progress. */
+    BOARD_ATOMIC spp_uint32_t head;                     /* len | packet seq << 16.           */
+    BOARD_ATOMIC spp_uint32_t timestampMs;
+    BOARD_ATOMIC spp_uint32_t data[K_BOARD_DATA_WORDS];
+    spp_uint16_t              apid;                     /* Fixed at init.                    */
+} BoardEntry_t;
+
+/* ----------------------------------------------------------------
+ * Private state
+ * ---------------------------------------------------------------- */
+
+static BoardEntry_t s_entries[K_SPP_BLACKBOARD_ENTRIES];
+static spp_uint8_t  s_count = 0U;
+
+/* ----------------------------------------------------------------
+ * Private helpers
+ * ---------------------------------------------------------------- */
+
+static BoardEntry_t *entryFind(spp_uint16_t apid)
+{
+    spp_uint8_t i;
+
+    for (i = 0U; i < s_count; i++)
+    {
+        if (s_entries[i].apid == apid)
+        {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void entryWrite(BoardEntry_t *p_entry, const SPP_Packet_t *p_packet)
+{
+    spp_uint16_t len = p_packet->primaryHeader.payloadLen;
+    spp_uint32_t seq;
+    spp_uint16_t off;
+
+    if (len > K_SPP_BLACKBOARD_PAYLOAD)
+    {
+        len = (spp_uint16_t)K_SPP_BLACKBOARD_PAYLOAD;
+    }
+
+#if SPP_PUBSUB_MPSC
+    /* Claim the entry; a second producer of the same APID backs off. */
+    seq = atomic_load_explicit(&p_entry->seq, memory_order_relaxed);
+    do
+    {
+        if ((seq & 1U) != 0U)
+        {
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&p_entry->seq, &seq, seq + 1U,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+    atomic_thread_fence(memory_order_release);
+#else
+    seq           = p_entry->seq;
+    p_entry->seq  = seq + 1U;
+#endif
+
+    BOARD_STORE(&p_entry->head,
+                (spp_uint32_t)len | ((spp_uint32_t)p_packet->primaryHeader.seq << 16U));
+    BOARD_STORE(&p_entry->timestampMs, p_packet->secondaryHeader.timestampMs);
+    for (off = 0U; off < len; off += 4U)
+    {
+        spp_uint32_t word = 0U;
+        size_t       n    = (size_t)len - off;
+        memcpy(&word, &p_packet->payload[off], (n < 4U) ? n : 4U);
+        BOARD_STORE(&p_entry->data[off / 4U], word);
+    }
+
+#if SPP_PUBSUB_MPSC
+    atomic_store_explicit(&p_entry->seq, seq + 2U, memory_order_release);
+#else
+    p_entry->seq = seq + 2U;
+#endif
+}
+
+/* SYNC batch handler: only the newest packet of each APID in the batch is
+ * written. */
+static void boardOnPackets(const SPP_Packet_t *const *pp_packets, spp_uint16_t count, void *p_ctx)
+{
+    spp_uint32_t written = 0U;
+    spp_uint16_t k       = count;
+
+    (void)p_ctx;
+
+    while (k > 0U)
+    {
+        const SPP_Packet_t *p_packet = pp_packets[--k];
+        BoardEntry_t       *p_entry  = entryFind(p_packet->primaryHeader.apid);
+        spp_uint32_t        bit;
+
+        if (p_entry == NULL)
+        {
+            continue;
+        }
+        bit = (spp_uint32_t)1U << (spp_uint32_t)(p_entry - s_entries);
+        if ((written & bit) == 0U)
+        {
+            written |= bit;
+            entryWrite(p_entry, p_packet);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------- */
+
+SPP_RetVal_t SPP_SERVICES_BLACKBOARD_init(const SPP_ApidSet_t *p_apids)
+{
+    SPP_PubSub_SubCfg_t cfg;
+    spp_uint16_t        apid;
+    spp_uint8_t         count = 0U;
+
+    if (p_apids == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    for (apid = 0U; apid < K_SPP_APID_COUNT; apid++)
+    {
+        if ((p_apids->words[apid >> 5U] & ((spp_uint32_t)1U << (apid & 31U))) == 0U)
+        {
+            continue;
+        }
+        if (count == K_SPP_BLACKBOARD_ENTRIES)
+        {
+            s_count = 0U;
+            SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+        }
+        memset(&s_entries[count], 0, sizeof(s_entries[count]));
+        s_entries[count].apid = apid;
+        count++;
+    }
+    s_count = count;
+
+    if (count == 0U)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.p_apidSet    = p_apids;
+    cfg.prio         = K_SPP_PUBSUB_PRIO_SYNC;
+    cfg.batchHandler = boardOnPackets;
+    return SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+}
+
+SPP_RetVal_t SPP_SERVICES_BLACKBOARD_read(spp_uint16_t apid, void *p_out, spp_uint16_t maxLen,
+                                          SPP_BlackboardInfo_t *p_info)
+{
+    const BoardEntry_t *p_entry;
+    spp_uint8_t        *p_dst = (spp_uint8_t *)p_out;
+    spp_uint32_t        tries;
+
+    if (p_out == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    p_entry = entryFind(apid);
+    if (p_entry == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    for (tries = 0U; tries < K_SPP_BLACKBOARD_READ_RETRIES; tries++)
+    {
+        spp_uint32_t seq;
+        spp_uint32_t head;
+        spp_uint32_t stampMs;
+        spp_uint16_t len;
+        spp_uint16_t off;
+
+#if SPP_PUBSUB_MPSC
+        seq = atomic_load_explicit(&p_entry->seq, memory_order_acquire);
+#else
+        seq = p_entry->seq;
+#endif
+        if (seq == 0U)
+        {
+            /* Not an error worth recording: the producer has not run yet. */
+            return K_SPP_ERROR;
+        }
+        if ((seq & 1U) != 0U)
+        {
+            continue;
+        }
+
+        head    = BOARD_LOAD(&p_entry->head);
+        stampMs = BOARD_LOAD(&p_entry->timestampMs);
+        len     = (spp_uint16_t)(head & 0xFFFFU);
+        if (len > maxLen)
+        {
+            len = maxLen;
+        }
+        for (off = 0U; off < len; off += 4U)
+        {
+            spp_uint32_t word = BOARD_LOAD(&p_entry->data[off / 4U]);
+            size_t       n    = (size_t)len - off;
+            memcpy(&p_dst[off], &word, (n < 4U) ? n : 4U);
+        }
+
+#if SPP_PUBSUB_MPSC
+        atomic_thread_fence(memory_order_acquire);
+#endif
+        if (BOARD_LOAD(&p_entry->seq) != seq)
+        {
+            continue;
+        }
+
+        if (p_info != NULL)
+        {
+            p_info->len         = (spp_uint16_t)(head & 0xFFFFU);
+            p_info->seq         = (spp_uint16_t)(head >> 16U);
+            p_info->timestampMs = stampMs;
+            p_info->updates     = seq / 2U;
+        }
+        return K_SPP_OK;
+    }
+
+    SPP_ERR_RETURN(K_SPP_ERROR_TIMEOUT);
+}
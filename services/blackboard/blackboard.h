@@ -0,0 +1,97 @@
+/**
+ * @file blackboard.h
+ * @brief Latest-value cache per APID, read without subscribing.
+ *
+ * State consumers (a fusion loop, a display) often need only the most
+ * recent sample of a stream, not every packet.  The blackboard keeps a
+ * copy of the last packet published on each tracked APID; it is written
+ * from inside @ref SPP_SERVICES_PUBSUB_publish() by one SYNC subscription,
+ * so reading it costs no queue slot, no dispatch and no pool packet.
+ *
+ * Each entry is a seqlock: the writer makes the sequence odd, copies the
+ * packet and makes it even again; a reader copies the entry and retries
+ * when the sequence moved underneath it.  Readers never block the writer.
+ * Under SPP_PUBSUB_MPSC the sequence and the data words are atomics, so
+ * reads are safe from any core or ISR; otherwise they are volatile, and
+ * reads are safe from the superloop and from ISRs on the writer's core.
+ * Entries assume one producer per APID: a write that finds another write
+ * of the same APID in progress is skipped.
+ *
+ * Naming conventions used in this file:
+ * - Constants/macros: K_SPP_BLACKBOARD_*
+ * - Types: SPP_BlackboardInfo_t
+ * - Public functions: SPP_SERVICES_BLACKBOARD_*()
+ * - Pointer parameters: p_*
+ */
+
+#ifndef SPP_BLACKBOARD_H
+#define SPP_BLACKBOARD_H
+
+#include "spp/core/returnTypes.h"
+#include "spp/core/types.h"
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/util/macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * Types
+ * ---------------------------------------------------------------- */
+
+/** @brief Header fields of the value returned by a blackboard read. */
+typedef struct
+{
+    spp_uint16_t len;         /**< Payload bytes stored (truncated to K_SPP_BLACKBOARD_PAYLOAD). */
+    spp_uint16_t seq;         /**< Packet sequence counter.                                     */
+    spp_uint32_t timestampMs; /**< Packet creation time (ms).                                   */
+    spp_uint32_t updates;     /**< Writes since init; compare to detect a new value.            */
+} SPP_BlackboardInfo_t;
+
+/* ----------------------------------------------------------------
+ * API
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Clear the blackboard and start tracking a set of APIDs.
+ *
+ * Takes one entry per APID in @p p_apids and registers one SYNC batch
+ * subscription for all of them.  Call once, after
+ * @ref SPP_SERVICES_PUBSUB_init() and before any tracked APID is published.
+ *
+ * @param[in] p_apids  APIDs to track; read during the call only.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_apids is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if the set is empty or holds more
+ *         than @ref K_SPP_BLACKBOARD_ENTRIES APIDs.
+ * @return The error of @ref SPP_SERVICES_PUBSUB_subscribeEx() otherwise.
+ */
+SPP_RetVal_t SPP_SERVICES_BLACKBOARD_init(const SPP_ApidSet_t *p_apids);
+
+/**
+ * @brief Copy the latest value of a tracked APID.
+ *
+ * Lock-free: copies the entry and retries, up to
+ * @ref K_SPP_BLACKBOARD_READ_RETRIES times, while a write overlaps the copy.
+ *
+ * @param[in]  apid    Tracked APID.
+ * @param[out] p_out   Receives up to @p maxLen payload bytes.
+ * @param[in]  maxLen  Capacity of @p p_out.
+ * @param[out] p_info  Receives the header fields; may be NULL.
+ *
+ * @return K_SPP_OK if a consistent value was copied.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_out is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p apid is not tracked.
+ * @return K_SPP_ERROR if nothing has been published on @p apid yet.
+ * @return K_SPP_ERROR_TIMEOUT if writes kept overtaking the copy.
+ */
+SPP_RetVal_t SPP_SERVICES_BLACKBOARD_read(spp_uint16_t apid, void *p_out, spp_uint16_t maxLen,
+                                          SPP_BlackboardInfo_t *p_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPP_BLACKBOARD_H */
@@ -58,6 +58,7 @@ void SPP_SERVICES_BMP390_init(void *p_data)
 
     p_bmp->drdyFlag = false;
     p_bmp->isr_ctx.p_flag = &p_bmp->drdyFlag;
+    p_bmp->isr_ctx.p_readyMask = NULL;
 
     SPP_HAL_gpioConfigInterrupt(p_bmp->intPin, p_bmp->intIntrType, p_bmp->intPull);
     SPP_HAL_gpioRegisterIsr(p_bmp->intPin, (void *)&p_bmp->isr_ctx);
@@ -520,22 +521,24 @@ SPP_RetVal_t SPP_SERVICES_BMP390_intEnableDrdy(void *p_spi)
 static void bmp390Task(void *p_ctx)
 {
     BMP390_t *ctx = (BMP390_t *)p_ctx;
-    float altitude    = 0.0f;
-    float pressure    = 0.0f;
-    float temperature = 0.0f;
 
     if (!ctx->bmpData.drdyFlag) return;
     ctx->bmpData.drdyFlag = false;
 
-    SPP_Packet_t *p_packet = SPP_SERVICES_DATABANK_getPacket();
+    SPP_Packet_t *p_packet = SPP_SERVICES_DATABANK_getPacketFor(K_BMP390_SERVICE_APID,
+                                                                K_BMP_SERVICE_PAYLOAD_LEN);
     if (p_packet == NULL)
     {
         SPP_LOGW(k_svcTag, "No free packet");
         return;
     }
 
+    /* Payload layout {altitude, pressure, temperature} — written in place. */
+    float *p_out = (float *)SPP_SERVICES_DATABANK_packetBegin(p_packet, K_BMP390_SERVICE_APID,
+                                                              ctx->seq);
+
     SPP_RetVal_t ret = SPP_SERVICES_BMP390_getAltitude(ctx->p_spi, &ctx->bmpData,
-                                                        &altitude, &pressure, &temperature);
+                                                        &p_out[0], &p_out[1], &p_out[2]);
     if (ret != K_SPP_OK)
     {
         SPP_LOGE(k_svcTag, "getAltitude failed ret=%d", (int)ret);
@@ -544,18 +547,17 @@ static void bmp390Task(void *p_ctx)
     }
 
 #ifdef SPP_DEBUG_PRINT
-    printf("[BMP] alt=%.1fm P=%.1fhPa T=%.2fC\n", altitude, pressure / 100.0f, temperature);
+    printf("[BMP] alt=%.1fm P=%.1fhPa T=%.2fC\n", p_out[0], p_out[1] / 100.0f, p_out[2]);
 #endif
 
-    float payload[3] = {altitude, pressure, temperature};
-    ret = SPP_SERVICES_DATABANK_packetData(p_packet, K_BMP390_SERVICE_APID, ctx->seq++,
-                                           payload, (spp_uint16_t)sizeof(payload));
+    ret = SPP_SERVICES_DATABANK_packetCommit(p_packet, K_BMP_SERVICE_PAYLOAD_LEN);
     if (ret != K_SPP_OK)
     {
-        SPP_LOGE(k_svcTag, "packetData failed ret=%d", (int)ret);
+        SPP_LOGE(k_svcTag, "packetCommit failed ret=%d", (int)ret);
         (void)SPP_SERVICES_DATABANK_returnPacket(p_packet);
         return;
     }
+    ctx->seq++;
 
     (void)SPP_SERVICES_PUBSUB_publish(p_packet);
 }
@@ -577,6 +579,7 @@ static SPP_RetVal_t bmp390Init(void *p_ctx)
     ctx->bmpData.intPull     = ctx->intPull;
 
     SPP_SERVICES_BMP390_init(&ctx->bmpData);
+    (void)SPP_SERVICES_bindReady(p_ctx, &ctx->bmpData.isr_ctx);
 
     ret = SPP_SERVICES_BMP390_auxConfig(ctx->p_spi);
     if (ret != K_SPP_OK) return ret;
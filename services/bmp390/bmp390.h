@@ -199,7 +199,7 @@ typedef struct
     spp_uint16_t  seq;        /**< Packet sequence counter.        */
 } BMP390_t;
 
-/** @brief APID produced by the BMP390 module (single bit, bitmask scheme). */
+/** @brief APID produced by the BMP390 module. */
 #define K_BMP390_SERVICE_APID (0x0004U)
 
 /**
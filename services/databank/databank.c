@@ -13,19 +13,399 @@
 #include <string.h>
 #include <stddef.h>
 
+/* ----------------------------------------------------------------
+ * Size classes
+ *
+ * All packets live in one byte arena, class after class.  A slot is cut to
+ * the header plus its class payload, rounded up to the packet alignment, so
+ * a 16-byte slot does not pay for a 256-byte payload array.  Slots are
+ * numbered globally (class 0 first) for the metadata tables.
+ * ---------------------------------------------------------------- */
+
+_Static_assert(K_SPP_DATABANK_SIZE > 0U, "databank needs at least one packet");
+_Static_assert(K_SPP_DATABANK_SIZE < K_SPP_DATABANK_NIL,
+               "K_SPP_DATABANK_SIZE must fit a 16-bit slot index");
+_Static_assert((K_SPP_DATABANK_SMALL_PAYLOAD < K_SPP_DATABANK_MEDIUM_PAYLOAD) &&
+               (K_SPP_DATABANK_MEDIUM_PAYLOAD < K_SPP_DATABANK_LARGE_PAYLOAD),
+               "databank class payloads must be strictly ascending");
+_Static_assert(K_SPP_DATABANK_LARGE_PAYLOAD <= K_SPP_PKT_PAYLOAD_MAX,
+               "largest databank class exceeds K_SPP_PKT_PAYLOAD_MAX");
+
+#define K_SLOT_ALIGN ((spp_uint32_t)_Alignof(SPP_Packet_t))
+#define K_SLOT_STRIDE(payload) \
+    ((K_SPP_PKT_HEADER_SIZE + (spp_uint32_t)(payload) + K_SLOT_ALIGN - 1U) & ~(K_SLOT_ALIGN - 1U))
+
+#define K_SMALL_BYTES  (K_SPP_DATABANK_SMALL_COUNT * K_SLOT_STRIDE(K_SPP_DATABANK_SMALL_PAYLOAD))
+#define K_MEDIUM_BYTES (K_SPP_DATABANK_MEDIUM_COUNT * K_SLOT_STRIDE(K_SPP_DATABANK_MEDIUM_PAYLOAD))
+#define K_LARGE_BYTES  (K_SPP_DATABANK_LARGE_COUNT * K_SLOT_STRIDE(K_SPP_DATABANK_LARGE_PAYLOAD))
+
+/** @brief Static layout of one size class. */
+typedef struct
+{
+    spp_uint16_t payloadMax; /**< Payload bytes backed by each slot.  */
+    spp_uint16_t count;      /**< Number of slots in the class.       */
+    spp_uint16_t firstSlot;  /**< Global index of the first slot.     */
+    spp_uint16_t stride;     /**< Bytes between consecutive slots.    */
+    spp_uint32_t offset;     /**< Byte offset of the class in s_arena. */
+} DatabankClass_t;
+
+static const DatabankClass_t k_classes[K_SPP_DATABANK_CLASSES] = {
+    {K_SPP_DATABANK_SMALL_PAYLOAD, K_SPP_DATABANK_SMALL_COUNT, 0U,
+     K_SLOT_STRIDE(K_SPP_DATABANK_SMALL_PAYLOAD), 0U},
+    {K_SPP_DATABANK_MEDIUM_PAYLOAD, K_SPP_DATABANK_MEDIUM_COUNT, K_SPP_DATABANK_SMALL_COUNT,
+     K_SLOT_STRIDE(K_SPP_DATABANK_MEDIUM_PAYLOAD), K_SMALL_BYTES},
+    {K_SPP_DATABANK_LARGE_PAYLOAD, K_SPP_DATABANK_LARGE_COUNT,
+     K_SPP_DATABANK_SMALL_COUNT + K_SPP_DATABANK_MEDIUM_COUNT,
+     K_SLOT_STRIDE(K_SPP_DATABANK_LARGE_PAYLOAD), K_SMALL_BYTES + K_MEDIUM_BYTES},
+};
+
 /* ----------------------------------------------------------------
  * Private state
  * ---------------------------------------------------------------- */
 
-/** @brief Static storage for all packets. */
-static SPP_Packet_t s_packets[K_SPP_DATABANK_SIZE];
+/** @brief Static storage for all packets of all classes. */
+static _Alignas(SPP_Packet_t) spp_uint8_t s_arena[K_SMALL_BYTES + K_MEDIUM_BYTES + K_LARGE_BYTES];
 
-/** @brief Control structure (free-list stack). */
+/** @brief Control structure (free lists and slot metadata). */
 static SPP_Databank_t s_databank;
 
 /** @brief Tracks whether the pool has been initialised. */
 static spp_bool_t s_initialized = false;
 
+/* ----------------------------------------------------------------
+ * Slot metadata access — atomic only in lock-free builds
+ * ---------------------------------------------------------------- */
+
+#if SPP_DATABANK_LOCKFREE
+#define SLOT_LOAD(obj)          atomic_load_explicit(&(obj), memory_order_acquire)
+#define SLOT_STORE(obj, val)    atomic_store_explicit(&(obj), (val), memory_order_release)
+#define COUNTER_INC(obj)        atomic_fetch_add_explicit(&(obj), 1U, memory_order_relaxed)
+#define COUNTER_DEC(obj)        atomic_fetch_sub_explicit(&(obj), 1U, memory_order_relaxed)
+#else
+#define SLOT_LOAD(obj)          (obj)
+#define SLOT_STORE(obj, val)    ((obj) = (val))
+#define COUNTER_INC(obj)        ((obj)++)
+#define COUNTER_DEC(obj)        ((obj)--)
+#endif
+
+/* ----------------------------------------------------------------
+ * Reference counts
+ *
+ * Both helpers return the count before the update.  A count of 0 means the
+ * slot is free, so it is never incremented from 0 (retain of a free
+ * packet) nor decremented below 0 (double return).
+ * ---------------------------------------------------------------- */
+
+static spp_uint8_t refIncrement(spp_uint32_t idx)
+{
+#if SPP_DATABANK_LOCKFREE
+    spp_uint8_t rc = atomic_load_explicit(&s_databank.refCount[idx], memory_order_relaxed);
+    do
+    {
+        if ((rc == 0U) || (rc == K_SPP_DATABANK_REF_MAX))
+        {
+            return rc;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&s_databank.refCount[idx], &rc,
+                                                    (spp_uint8_t)(rc + 1U),
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+    return rc;
+#else
+    spp_uint8_t rc = s_databank.refCount[idx];
+    if ((rc != 0U) && (rc != K_SPP_DATABANK_REF_MAX))
+    {
+        s_databank.refCount[idx] = (spp_uint8_t)(rc + 1U);
+    }
+    return rc;
+#endif
+}
+
+static spp_uint8_t refDecrement(spp_uint32_t idx)
+{
+#if SPP_DATABANK_LOCKFREE
+    /* acq_rel: every holder's reads happen-before the slot is reused. */
+    spp_uint8_t rc = atomic_load_explicit(&s_databank.refCount[idx], memory_order_relaxed);
+    do
+    {
+        if (rc == 0U)
+        {
+            return rc;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&s_databank.refCount[idx], &rc,
+                                                    (spp_uint8_t)(rc - 1U),
+                                                    memory_order_acq_rel,
+                                                    memory_order_relaxed));
+    return rc;
+#else
+    spp_uint8_t rc = s_databank.refCount[idx];
+    if (rc != 0U)
+    {
+        s_databank.refCount[idx] = (spp_uint8_t)(rc - 1U);
+    }
+    return rc;
+#endif
+}
+
+/** @brief Return the packet stored in global slot @p idx of class @p cls. */
+static inline SPP_Packet_t *slotPacket(spp_uint32_t cls, spp_uint32_t idx)
+{
+    const DatabankClass_t *p_cls = &k_classes[cls];
+    return (SPP_Packet_t *)(void *)&s_arena[p_cls->offset +
+                                            ((idx - p_cls->firstSlot) * p_cls->stride)];
+}
+
+/** @brief Return the class that owns global slot @p idx. */
+static spp_uint32_t slotClass(spp_uint32_t idx)
+{
+    spp_uint32_t cls = 0U;
+    while ((cls + 1U < K_SPP_DATABANK_CLASSES) &&
+           (idx >= k_classes[cls + 1U].firstSlot))
+    {
+        cls++;
+    }
+    return cls;
+}
+
+/**
+ * @brief Map a packet pointer to its global slot index, or K_SPP_DATABANK_NIL.
+ *
+ * @param[out] p_cls  Receives the slot's class (may be NULL).
+ */
+static spp_uint32_t slotIndex(const SPP_Packet_t *p_packet, spp_uint32_t *p_cls)
+{
+    const spp_uint8_t *p_byte = (const spp_uint8_t *)p_packet;
+    if ((p_byte < &s_arena[0]) || (p_byte >= &s_arena[sizeof(s_arena)]))
+    {
+        return K_SPP_DATABANK_NIL;
+    }
+
+    spp_uint32_t offset = (spp_uint32_t)(p_byte - &s_arena[0]);
+    spp_uint32_t cls    = K_SPP_DATABANK_CLASSES - 1U;
+    while (offset < k_classes[cls].offset)
+    {
+        cls--;
+    }
+
+    spp_uint32_t rel = offset - k_classes[cls].offset;
+    if ((rel % k_classes[cls].stride) != 0U)
+    {
+        return K_SPP_DATABANK_NIL; /* Points into the middle of a slot. */
+    }
+    if (p_cls != NULL)
+    {
+        *p_cls = cls;
+    }
+    return k_classes[cls].firstSlot + (rel / k_classes[cls].stride);
+}
+
+/* ----------------------------------------------------------------
+ * Quotas
+ *
+ * reservedFree is the sum over all entries of max(0, reserve - inUse):
+ * the packets still held back for APIDs that have not used their
+ * reservation.  A request that is not consuming its own reservation may
+ * only take a packet while more than that many are free.
+ * ---------------------------------------------------------------- */
+
+_Static_assert(K_SPP_DATABANK_MAX_QUOTAS < K_SPP_DATABANK_QUOTA_NONE,
+               "K_SPP_DATABANK_MAX_QUOTAS must fit the 8-bit slot quota index");
+
+static spp_uint32_t quotaFind(spp_uint16_t apid)
+{
+    for (spp_uint32_t i = 0U; i < s_databank.quotaCount; i++)
+    {
+        if (s_databank.quotas[i].apid == apid)
+        {
+            return i;
+        }
+    }
+    return K_SPP_DATABANK_QUOTA_NONE;
+}
+
+/** @brief Charge one packet to @p p_q unless it is at quota; reports prior inUse. */
+static spp_bool_t quotaCharge(SPP_DatabankQuota_t *p_q, spp_uint16_t *p_prev)
+{
+#if SPP_DATABANK_LOCKFREE
+    spp_uint16_t n = atomic_load_explicit(&p_q->inUse, memory_order_relaxed);
+    do
+    {
+        if (n >= p_q->quota)
+        {
+            return false;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&p_q->inUse, &n, (spp_uint16_t)(n + 1U),
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+    *p_prev = n;
+#else
+    if (p_q->inUse >= p_q->quota)
+    {
+        return false;
+    }
+    *p_prev = p_q->inUse++;
+#endif
+    if (*p_prev < p_q->reserve)
+    {
+        (void)COUNTER_DEC(s_databank.reservedFree); /* Took one of its own. */
+    }
+    return true;
+}
+
+static void quotaUncharge(spp_uint32_t qi)
+{
+    SPP_DatabankQuota_t *p_q = &s_databank.quotas[qi];
+    if (COUNTER_DEC(p_q->inUse) <= p_q->reserve)
+    {
+        (void)COUNTER_INC(s_databank.reservedFree);
+    }
+}
+
+static void quotaRecomputeReserved(void)
+{
+    spp_uint32_t reserved = 0U;
+    for (spp_uint32_t i = 0U; i < s_databank.quotaCount; i++)
+    {
+        spp_uint16_t inUse = SLOT_LOAD(s_databank.quotas[i].inUse);
+        if (inUse < s_databank.quotas[i].reserve)
+        {
+            reserved += (spp_uint32_t)s_databank.quotas[i].reserve - inUse;
+        }
+    }
+    SLOT_STORE(s_databank.reservedFree, reserved);
+}
+
+/* ----------------------------------------------------------------
+ * Free lists — lock-free tagged stacks, one per class
+ *
+ * Each head packs a 16-bit slot index with a 16-bit tag that is bumped on
+ * every successful update, so a pop that read a stale next[] link fails
+ * its compare-and-swap instead of corrupting the list (ABA).
+ * ---------------------------------------------------------------- */
+
+#if SPP_DATABANK_LOCKFREE
+
+#define K_HEAD_INDEX(head) ((spp_uint16_t)((head) & 0xFFFFU))
+#define K_HEAD_NEXT(head, idx) ((((head) + 0x10000U) & 0xFFFF0000U) | (spp_uint32_t)(idx))
+
+static void freeListReset(void)
+{
+    for (spp_uint32_t cls = 0U; cls < K_SPP_DATABANK_CLASSES; cls++)
+    {
+        const DatabankClass_t *p_cls = &k_classes[cls];
+        spp_uint32_t end = (spp_uint32_t)p_cls->firstSlot + p_cls->count;
+
+        for (spp_uint32_t i = p_cls->firstSlot; i < end; i++)
+        {
+            /* First slot on top so the first pop returns the lowest address. */
+            spp_uint16_t next = (i + 1U < end) ? (spp_uint16_t)(i + 1U)
+                                               : (spp_uint16_t)K_SPP_DATABANK_NIL;
+            atomic_init(&s_databank.next[i], next);
+        }
+        atomic_init(&s_databank.head[cls], (p_cls->count > 0U) ? p_cls->firstSlot
+                                                               : K_SPP_DATABANK_NIL);
+        atomic_init(&s_databank.freeCount[cls], p_cls->count);
+    }
+}
+
+static spp_uint32_t freeListPop(spp_uint32_t cls)
+{
+    _Atomic spp_uint32_t *p_head = &s_databank.head[cls];
+    spp_uint32_t head = atomic_load_explicit(p_head, memory_order_acquire);
+    spp_uint16_t idx;
+
+    do
+    {
+        idx = K_HEAD_INDEX(head);
+        if (idx == K_SPP_DATABANK_NIL)
+        {
+            return K_SPP_DATABANK_NIL;
+        }
+        spp_uint16_t next = atomic_load_explicit(&s_databank.next[idx], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(p_head, &head,
+                                                  K_HEAD_NEXT(head, next),
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire))
+        {
+            break;
+        }
+    } while (true);
+
+    (void)atomic_fetch_sub_explicit(&s_databank.freeCount[cls], 1U, memory_order_relaxed);
+    return idx;
+}
+
+static void freeListPush(spp_uint32_t cls, spp_uint32_t idx)
+{
+    _Atomic spp_uint32_t *p_head = &s_databank.head[cls];
+    spp_uint32_t head = atomic_load_explicit(p_head, memory_order_relaxed);
+    do
+    {
+        atomic_store_explicit(&s_databank.next[idx], K_HEAD_INDEX(head), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(p_head, &head,
+                                                    K_HEAD_NEXT(head, idx),
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+
+    (void)atomic_fetch_add_explicit(&s_databank.freeCount[cls], 1U, memory_order_relaxed);
+}
+
+static spp_uint32_t freeListCount(spp_uint32_t cls)
+{
+    return atomic_load_explicit(&s_databank.freeCount[cls], memory_order_relaxed);
+}
+
+#else /* !SPP_DATABANK_LOCKFREE */
+
+/* ----------------------------------------------------------------
+ * Free lists — plain stacks (single context only)
+ *
+ * Class c owns freeSlots[firstSlot .. firstSlot + count).
+ * ---------------------------------------------------------------- */
+
+static void freeListReset(void)
+{
+    for (spp_uint32_t cls = 0U; cls < K_SPP_DATABANK_CLASSES; cls++)
+    {
+        const DatabankClass_t *p_cls = &k_classes[cls];
+
+        s_databank.freeCount[cls] = 0U;
+        for (spp_uint32_t i = 0U; i < p_cls->count; i++)
+        {
+            /* Lowest slot on top so the first pop returns the lowest address. */
+            s_databank.freeSlots[p_cls->firstSlot + i] =
+                (spp_uint16_t)(p_cls->firstSlot + p_cls->count - 1U - i);
+            s_databank.freeCount[cls]++;
+        }
+    }
+}
+
+static spp_uint32_t freeListPop(spp_uint32_t cls)
+{
+    if (s_databank.freeCount[cls] == 0U)
+    {
+        return K_SPP_DATABANK_NIL;
+    }
+
+    s_databank.freeCount[cls]--;
+    return s_databank.freeSlots[k_classes[cls].firstSlot + s_databank.freeCount[cls]];
+}
+
+static void freeListPush(spp_uint32_t cls, spp_uint32_t idx)
+{
+    /* Cannot overflow: the slot state guarantees each index is pushed once. */
+    s_databank.freeSlots[k_classes[cls].firstSlot + s_databank.freeCount[cls]] =
+        (spp_uint16_t)idx;
+    s_databank.freeCount[cls]++;
+}
+
+static spp_uint32_t freeListCount(spp_uint32_t cls)
+{
+    return s_databank.freeCount[cls];
+}
+
+#endif /* SPP_DATABANK_LOCKFREE */
+
 /* ----------------------------------------------------------------
  * Public API
  * ---------------------------------------------------------------- */
@@ -37,14 +417,16 @@ SPP_RetVal_t SPP_SERVICES_DATABANK_init(void)
         SPP_ERR_RETURN(K_SPP_ERROR_ALREADY_INITIALIZED);
     }
 
-    memset(s_packets, 0, sizeof(s_packets));
-    s_databank.freeCount = 0U;
-
+    memset(s_arena, 0, sizeof(s_arena));
     for (spp_uint32_t i = 0U; i < K_SPP_DATABANK_SIZE; i++)
     {
-        s_databank.p_freePackets[i] = &s_packets[K_SPP_DATABANK_SIZE - 1U - i];
-        s_databank.freeCount++;
+        SLOT_STORE(s_databank.state[i], K_SPP_DATABANK_SLOT_FREE);
+        SLOT_STORE(s_databank.refCount[i], 0U);
+        SLOT_STORE(s_databank.quotaIdx[i], K_SPP_DATABANK_QUOTA_NONE);
+        SLOT_STORE(s_databank.ownerApid[i], K_SPP_APID_NONE);
+        SLOT_STORE(s_databank.acquiredMs[i], 0U);
     }
+    freeListReset();
 
     s_initialized = true;
     return K_SPP_OK;
@@ -52,16 +434,129 @@ SPP_RetVal_t SPP_SERVICES_DATABANK_init(void)
 
 SPP_Packet_t *SPP_SERVICES_DATABANK_getPacket(void)
 {
-    if (!s_initialized || (s_databank.freeCount == 0U))
+    return SPP_SERVICES_DATABANK_getPacketSized(K_SPP_DATABANK_DEFAULT_PAYLOAD);
+}
+
+SPP_Packet_t *SPP_SERVICES_DATABANK_getPacketSized(spp_uint16_t payloadLen)
+{
+    return SPP_SERVICES_DATABANK_getPacketFor(K_SPP_APID_NONE, payloadLen);
+}
+
+SPP_Packet_t *SPP_SERVICES_DATABANK_getPacketFor(spp_uint16_t apid, spp_uint16_t payloadLen)
+{
+    if (!s_initialized)
     {
         return NULL;
     }
 
-    s_databank.freeCount--;
-    return s_databank.p_freePackets[s_databank.freeCount];
+    spp_uint32_t         qi         = quotaFind(apid);
+    SPP_DatabankQuota_t *p_q        = (qi != K_SPP_DATABANK_QUOTA_NONE) ? &s_databank.quotas[qi]
+                                                                        : NULL;
+    spp_bool_t           ownReserve = false;
+
+    if (p_q != NULL)
+    {
+        spp_uint16_t prev;
+        if (!quotaCharge(p_q, &prev))
+        {
+            (void)COUNTER_INC(p_q->exhausted);
+            return NULL;
+        }
+        ownReserve = (prev < p_q->reserve);
+    }
+
+    /* Leave other APIDs' reservations alone. */
+    spp_uint32_t reserved = SLOT_LOAD(s_databank.reservedFree);
+    spp_bool_t   allowed  = ownReserve || (reserved == 0U) ||
+                            (SPP_SERVICES_DATABANK_freeCount() > reserved);
+
+    for (spp_uint32_t cls = 0U; allowed && (cls < K_SPP_DATABANK_CLASSES); cls++)
+    {
+        if (k_classes[cls].payloadMax < payloadLen)
+        {
+            continue;
+        }
+
+        spp_uint32_t idx = freeListPop(cls);
+        if (idx != K_SPP_DATABANK_NIL)
+        {
+            SLOT_STORE(s_databank.ownerApid[idx], apid);
+            SLOT_STORE(s_databank.quotaIdx[idx], (spp_uint8_t)qi);
+            SLOT_STORE(s_databank.acquiredMs[idx], SPP_HAL_getTimeMs());
+            SLOT_STORE(s_databank.state[idx], K_SPP_DATABANK_SLOT_ACQUIRED);
+            SLOT_STORE(s_databank.refCount[idx], 1U);
+            return slotPacket(cls, idx);
+        }
+    }
+
+    if (p_q != NULL)
+    {
+        quotaUncharge(qi);
+        (void)COUNTER_INC(p_q->exhausted);
+    }
+    return NULL;
+}
+
+SPP_RetVal_t SPP_SERVICES_DATABANK_setQuota(spp_uint16_t apid, spp_uint16_t reserve,
+                                            spp_uint16_t quota)
+{
+    if ((apid == K_SPP_APID_NONE) || (reserve > quota))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    spp_uint32_t qi = quotaFind(apid);
+    spp_uint32_t reservedOthers = 0U;
+    for (spp_uint32_t i = 0U; i < s_databank.quotaCount; i++)
+    {
+        reservedOthers += (i != qi) ? s_databank.quotas[i].reserve : 0U;
+    }
+    if ((reservedOthers + reserve) > K_SPP_DATABANK_SIZE)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    if (qi == K_SPP_DATABANK_QUOTA_NONE)
+    {
+        if (s_databank.quotaCount >= K_SPP_DATABANK_MAX_QUOTAS)
+        {
+            SPP_ERR_RETURN(K_SPP_ERROR);
+        }
+        qi = s_databank.quotaCount;
+        s_databank.quotas[qi].apid = apid;
+        SLOT_STORE(s_databank.quotas[qi].inUse, 0U);
+        SLOT_STORE(s_databank.quotas[qi].exhausted, 0U);
+        s_databank.quotaCount++;
+    }
+
+    s_databank.quotas[qi].reserve = reserve;
+    s_databank.quotas[qi].quota   = quota;
+    quotaRecomputeReserved();
+    return K_SPP_OK;
+}
+
+spp_uint32_t SPP_SERVICES_DATABANK_exhaustedCount(spp_uint16_t apid)
+{
+    spp_uint32_t qi = quotaFind(apid);
+    return (qi != K_SPP_DATABANK_QUOTA_NONE) ? SLOT_LOAD(s_databank.quotas[qi].exhausted) : 0U;
+}
+
+spp_uint16_t SPP_SERVICES_DATABANK_payloadCapacity(const SPP_Packet_t *p_packet)
+{
+    spp_uint32_t cls;
+    if ((p_packet == NULL) || (slotIndex(p_packet, &cls) == K_SPP_DATABANK_NIL))
+    {
+        return 0U;
+    }
+    return k_classes[cls].payloadMax;
 }
 
 SPP_RetVal_t SPP_SERVICES_DATABANK_returnPacket(SPP_Packet_t *p_packet)
+{
+    return SPP_SERVICES_DATABANK_release(p_packet);
+}
+
+SPP_RetVal_t SPP_SERVICES_DATABANK_release(const SPP_Packet_t *p_packet)
 {
     if (p_packet == NULL)
     {
@@ -69,34 +564,135 @@ SPP_RetVal_t SPP_SERVICES_DATABANK_returnPacket(SPP_Packet_t *p_packet)
     }
 
     /* Validate that the pointer belongs to the static pool. */
-    if ((p_packet < &s_packets[0]) ||
-        (p_packet > &s_packets[K_SPP_DATABANK_SIZE - 1U]))
+    spp_uint32_t cls;
+    spp_uint32_t idx = slotIndex(p_packet, &cls);
+    if (idx == K_SPP_DATABANK_NIL)
     {
         SPP_ERR_RETURN(K_SPP_ERROR);
     }
 
-    /* Guard against double-return. */
-    for (spp_uint32_t i = 0U; i < s_databank.freeCount; i++)
+    /* Guard against double-return: a free slot has no references left, and
+     * exactly one caller drops the last one, so this is also race-free in
+     * lock-free builds. */
+    spp_uint8_t prev = refDecrement(idx);
+    if (prev == 0U)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_ALREADY_INITIALIZED); /* Already in free list. */
+    }
+
+    if (prev == 1U)
     {
-        if (s_databank.p_freePackets[i] == p_packet)
+        spp_uint8_t qi = SLOT_LOAD(s_databank.quotaIdx[idx]);
+        if (qi != K_SPP_DATABANK_QUOTA_NONE)
         {
-            SPP_ERR_RETURN(K_SPP_ERROR_ALREADY_INITIALIZED); /* Already in free list. */
+            quotaUncharge(qi);
         }
+        SLOT_STORE(s_databank.state[idx], K_SPP_DATABANK_SLOT_FREE);
+        freeListPush(cls, idx);
     }
+    return K_SPP_OK;
+}
 
-    if (s_databank.freeCount >= K_SPP_DATABANK_SIZE)
+SPP_RetVal_t SPP_SERVICES_DATABANK_retain(const SPP_Packet_t *p_packet)
+{
+    if (p_packet == NULL)
     {
-        SPP_ERR_RETURN(K_SPP_ERROR); /* Pool is already full — should not happen. */
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    spp_uint32_t idx = slotIndex(p_packet, NULL);
+    if (idx == K_SPP_DATABANK_NIL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR);
     }
 
-    s_databank.p_freePackets[s_databank.freeCount] = p_packet;
-    s_databank.freeCount++;
+    spp_uint8_t prev = refIncrement(idx);
+    if ((prev == 0U) || (prev == K_SPP_DATABANK_REF_MAX))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR); /* Free slot, or too many holders. */
+    }
+    return K_SPP_OK;
+}
+
+spp_uint8_t SPP_SERVICES_DATABANK_refCount(const SPP_Packet_t *p_packet)
+{
+    spp_uint32_t idx = (p_packet != NULL) ? slotIndex(p_packet, NULL) : K_SPP_DATABANK_NIL;
+    return (idx != K_SPP_DATABANK_NIL) ? SLOT_LOAD(s_databank.refCount[idx]) : 0U;
+}
+
+SPP_RetVal_t SPP_SERVICES_DATABANK_markQueued(const SPP_Packet_t *p_packet)
+{
+    if (p_packet == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    spp_uint32_t idx = slotIndex(p_packet, NULL);
+    if ((idx == K_SPP_DATABANK_NIL) ||
+        (SLOT_LOAD(s_databank.state[idx]) == K_SPP_DATABANK_SLOT_FREE))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+
+    SLOT_STORE(s_databank.state[idx], K_SPP_DATABANK_SLOT_QUEUED);
     return K_SPP_OK;
 }
 
 spp_uint32_t SPP_SERVICES_DATABANK_freeCount(void)
 {
-    return s_databank.freeCount;
+    spp_uint32_t count = 0U;
+    for (spp_uint32_t cls = 0U; cls < K_SPP_DATABANK_CLASSES; cls++)
+    {
+        count += freeListCount(cls);
+    }
+    return count;
+}
+
+spp_uint32_t SPP_SERVICES_DATABANK_freeCountSized(spp_uint16_t payloadLen)
+{
+    spp_uint32_t count = 0U;
+    for (spp_uint32_t cls = 0U; cls < K_SPP_DATABANK_CLASSES; cls++)
+    {
+        if (k_classes[cls].payloadMax >= payloadLen)
+        {
+            count += freeListCount(cls);
+        }
+    }
+    return count;
+}
+
+spp_uint32_t SPP_SERVICES_DATABANK_leakReport(spp_uint32_t thresholdMs,
+                                              SPP_DatabankLeak_t *p_out,
+                                              spp_uint32_t maxOut)
+{
+    spp_uint32_t now   = SPP_HAL_getTimeMs();
+    spp_uint32_t count = 0U;
+
+    for (spp_uint32_t i = 0U; i < K_SPP_DATABANK_SIZE; i++)
+    {
+        spp_uint8_t state = SLOT_LOAD(s_databank.state[i]);
+        if (state == K_SPP_DATABANK_SLOT_FREE)
+        {
+            continue;
+        }
+
+        spp_uint32_t heldMs = now - SLOT_LOAD(s_databank.acquiredMs[i]);
+        if (heldMs < thresholdMs)
+        {
+            continue;
+        }
+
+        if ((p_out != NULL) && (count < maxOut))
+        {
+            p_out[count].p_packet  = slotPacket(slotClass(i), i);
+            p_out[count].ownerApid = SLOT_LOAD(s_databank.ownerApid[i]);
+            p_out[count].state     = state;
+            p_out[count].refCount  = SLOT_LOAD(s_databank.refCount[i]);
+            p_out[count].heldMs    = heldMs;
+        }
+        count++;
+    }
+    return count;
 }
 
 /* ----------------------------------------------------------------
@@ -105,44 +701,86 @@ spp_uint32_t SPP_SERVICES_DATABANK_freeCount(void)
 
 static spp_uint16_t packetCrc(const SPP_Packet_t *p_packet)
 {
-    /* CRC covers all bytes up to (but not including) the crc field.
-     * The packet is zeroed before filling, so padding bytes are 0
-     * and contribute deterministically to the checksum. */
-    return SPP_UTIL_crc16((const spp_uint8_t *)p_packet,
-                          (spp_uint32_t)offsetof(SPP_Packet_t, crc));
+    /* CRC covers the header bytes in front of the crc field, then the used
+     * payload — the same byte order as a wire image with the CRC appended.
+     * packetBegin() zeroes the headers before filling, so padding bytes are
+     * 0 and contribute deterministically to the checksum. */
+    spp_uint16_t crc = SPP_UTIL_crc16((const spp_uint8_t *)p_packet,
+                                      (spp_uint32_t)offsetof(SPP_Packet_t, crc));
+    return SPP_UTIL_crc16Update(crc, p_packet->payload, p_packet->primaryHeader.payloadLen);
 }
 
 /* ----------------------------------------------------------------
- * Packet fill helper
+ * Packet fill helpers
  * ---------------------------------------------------------------- */
 
-SPP_RetVal_t SPP_SERVICES_DATABANK_packetData(SPP_Packet_t *p_packet, spp_uint16_t apid,
-                                      spp_uint16_t seq, const void *p_data,
-                                      spp_uint16_t dataLen)
+/** @brief Payload capacity of @p p_packet; non-pool packets (e.g. on the
+ *  caller's stack) are full-sized. */
+static spp_uint32_t packetCapacity(const SPP_Packet_t *p_packet)
 {
-    if ((p_packet == NULL) || (p_data == NULL))
+    spp_uint32_t cls;
+    return (slotIndex(p_packet, &cls) != K_SPP_DATABANK_NIL) ? k_classes[cls].payloadMax
+                                                             : K_SPP_PKT_PAYLOAD_MAX;
+}
+
+void *SPP_SERVICES_DATABANK_packetBegin(SPP_Packet_t *p_packet, spp_uint16_t apid,
+                                        spp_uint16_t seq)
+{
+    if (p_packet == NULL)
     {
-        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+        return NULL;
     }
-    if (dataLen > K_SPP_PKT_PAYLOAD_MAX)
+
+    /* Only the header bytes in front of crc are hashed — zero just those so
+     * their padding is deterministic.  The payload is left untouched. */
+    memset(p_packet, 0, offsetof(SPP_Packet_t, crc));
+
+    p_packet->primaryHeader.version  = K_SPP_PKT_VERSION;
+    p_packet->primaryHeader.seqFlags = K_SPP_PKT_SEQ_UNSEGMENTED;
+    p_packet->primaryHeader.apid     = apid;
+    p_packet->primaryHeader.seq      = seq;
+
+    spp_uint32_t idx = slotIndex(p_packet, NULL);
+    if (idx != K_SPP_DATABANK_NIL)
     {
-        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+        SLOT_STORE(s_databank.ownerApid[idx], apid);
     }
 
-    /* Zero the whole struct so padding bytes are deterministic. */
-    memset(p_packet, 0, sizeof(SPP_Packet_t));
+    return p_packet->payload;
+}
 
-    p_packet->primaryHeader.version    = K_SPP_PKT_VERSION;
-    p_packet->primaryHeader.apid       = apid;
-    p_packet->primaryHeader.seq        = seq;
-    p_packet->primaryHeader.payloadLen = dataLen;
+SPP_RetVal_t SPP_SERVICES_DATABANK_packetCommit(SPP_Packet_t *p_packet, spp_uint16_t dataLen)
+{
+    if (p_packet == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    if (dataLen > packetCapacity(p_packet))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
 
+    p_packet->primaryHeader.payloadLen    = dataLen;
     p_packet->secondaryHeader.timestampMs = SPP_HAL_getTimeMs();
     p_packet->secondaryHeader.dropCounter = 0U;
 
-    memcpy(p_packet->payload, p_data, dataLen);
-
     p_packet->crc = packetCrc(p_packet);
-
     return K_SPP_OK;
 }
+
+SPP_RetVal_t SPP_SERVICES_DATABANK_packetData(SPP_Packet_t *p_packet, spp_uint16_t apid,
+                                      spp_uint16_t seq, const void *p_data,
+                                      spp_uint16_t dataLen)
+{
+    if ((p_packet == NULL) || (p_data == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    if (dataLen > packetCapacity(p_packet))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    memcpy(SPP_SERVICES_DATABANK_packetBegin(p_packet, apid, seq), p_data, dataLen);
+    return SPP_SERVICES_DATABANK_packetCommit(p_packet, dataLen);
+}
@@ -7,7 +7,26 @@
  * fill it, and pass it to the @c db_flow FIFO.  Consumers return packets
  * via @ref SPP_SERVICES_DATABANK_returnPacket() after processing.
  *
- * The pool size is controlled by @ref K_SPP_DATABANK_SIZE (default 5).
+ * The pool is split into size classes (K_SPP_DATABANK_SMALL/MEDIUM/LARGE_*
+ * in macros.h).  Each packet only backs the payload bytes of its class, so
+ * small sensor samples do not pay for the largest payload.
+ * @ref SPP_SERVICES_DATABANK_getPacketSized() picks the smallest class that
+ * fits and falls back to larger classes when it is empty.
+ *
+ * Packets are reference counted.  getPacket() hands out one reference;
+ * @ref SPP_SERVICES_DATABANK_retain() adds one and
+ * @ref SPP_SERVICES_DATABANK_release() drops one, and the slot goes back to
+ * its free list when the last reference is dropped.  This lets subscribers
+ * keep packets past their callback (e.g. to batch SD card writes) without
+ * copying them.
+ *
+ * Per-APID quotas (@ref SPP_SERVICES_DATABANK_setQuota()) cap how many
+ * packets one APID may hold and reserve a minimum that no other APID can
+ * take, so a log storm cannot starve the sensor producers.
+ *
+ * With @ref SPP_DATABANK_LOCKFREE set to 1 the free list is an index-based
+ * Treiber stack whose head carries a 16-bit ABA tag, so packets can be
+ * acquired and returned from ISRs and from several cores at once.
  *
  * Naming conventions used in this file:
  * - Constants/macros: K_SPP_DATABANK_*
@@ -24,10 +43,60 @@
 #include "spp/core/types.h"
 #include "spp/util/macros.h"
 
+#if SPP_DATABANK_LOCKFREE
+#include <stdatomic.h>
+#endif
+
 /* ----------------------------------------------------------------
  * Databank state type
  * ---------------------------------------------------------------- */
 
+/** @brief Free-list link value meaning "no next slot" (lock-free mode). */
+#define K_SPP_DATABANK_NIL (0xFFFFU)
+
+/** @brief Number of databank size classes. */
+#define K_SPP_DATABANK_CLASSES (3U)
+
+/** @brief Payload capacity of packets returned by SPP_SERVICES_DATABANK_getPacket(). */
+#define K_SPP_DATABANK_DEFAULT_PAYLOAD K_SPP_DATABANK_MEDIUM_PAYLOAD
+
+/** @brief Slot state: in the free list. */
+#define K_SPP_DATABANK_SLOT_FREE     (0U)
+
+/** @brief Slot state: leased by a producer or held by a consumer. */
+#define K_SPP_DATABANK_SLOT_ACQUIRED (1U)
+
+/** @brief Slot state: waiting in the pub/sub deferred queue. */
+#define K_SPP_DATABANK_SLOT_QUEUED   (2U)
+
+/** @brief Maximum number of simultaneous references to one packet. */
+#define K_SPP_DATABANK_REF_MAX       (0xFFU)
+
+/** @brief Quota value meaning "no upper limit". */
+#define K_SPP_DATABANK_QUOTA_UNLIMITED (0xFFFFU)
+
+/** @brief Slot quota index meaning "not charged to any APID". */
+#define K_SPP_DATABANK_QUOTA_NONE      (0xFFU)
+
+/** @brief Per-slot metadata is atomic only in lock-free builds. */
+#if SPP_DATABANK_LOCKFREE
+#define SPP_DATABANK_ATOMIC _Atomic
+#else
+#define SPP_DATABANK_ATOMIC
+#endif
+
+/**
+ * @brief Per-APID quota entry (see @ref SPP_SERVICES_DATABANK_setQuota()).
+ */
+typedef struct
+{
+    spp_uint16_t                     apid;      /**< APID the entry applies to.               */
+    spp_uint16_t                     reserve;   /**< Packets kept free for this APID only.    */
+    spp_uint16_t                     quota;     /**< Max packets held, or QUOTA_UNLIMITED.    */
+    SPP_DATABANK_ATOMIC spp_uint16_t inUse;     /**< Packets currently charged to the APID.   */
+    SPP_DATABANK_ATOMIC spp_uint32_t exhausted; /**< Requests refused (quota, reserve, empty). */
+} SPP_DatabankQuota_t;
+
 /**
  * @brief Internal databank control structure.
  *
@@ -36,10 +105,37 @@
  */
 typedef struct
 {
-    SPP_Packet_t  *p_freePackets[K_SPP_DATABANK_SIZE]; /**< Free packet stack.  */
-    spp_uint32_t   freeCount;                          /**< Free packets count. */
+#if SPP_DATABANK_LOCKFREE
+    _Atomic spp_uint32_t head[K_SPP_DATABANK_CLASSES];      /**< (tag << 16) | top slot, per class. */
+    _Atomic spp_uint16_t next[K_SPP_DATABANK_SIZE];         /**< Free-list links by slot.          */
+    _Atomic spp_uint32_t freeCount[K_SPP_DATABANK_CLASSES]; /**< Free packets per class.           */
+#else
+    spp_uint16_t   freeSlots[K_SPP_DATABANK_SIZE];        /**< Per-class free slot stacks, back to back. */
+    spp_uint32_t   freeCount[K_SPP_DATABANK_CLASSES];     /**< Free packets per class.                   */
+#endif
+    SPP_DATABANK_ATOMIC spp_uint8_t  state[K_SPP_DATABANK_SIZE];      /**< K_SPP_DATABANK_SLOT_*.      */
+    SPP_DATABANK_ATOMIC spp_uint8_t  refCount[K_SPP_DATABANK_SIZE];   /**< Live references (0 = free). */
+    SPP_DATABANK_ATOMIC spp_uint16_t ownerApid[K_SPP_DATABANK_SIZE];  /**< APID of the current owner.  */
+    SPP_DATABANK_ATOMIC spp_uint32_t acquiredMs[K_SPP_DATABANK_SIZE]; /**< Time the slot was leased.   */
+    SPP_DATABANK_ATOMIC spp_uint8_t  quotaIdx[K_SPP_DATABANK_SIZE];   /**< Charged entry, or QUOTA_NONE. */
+
+    SPP_DatabankQuota_t              quotas[K_SPP_DATABANK_MAX_QUOTAS]; /**< Configured APIDs.           */
+    spp_uint8_t                      quotaCount;                        /**< Entries used in quotas[].   */
+    SPP_DATABANK_ATOMIC spp_uint32_t reservedFree; /**< Reserved packets not yet taken by their APID. */
 } SPP_Databank_t;
 
+/**
+ * @brief One entry of @ref SPP_SERVICES_DATABANK_leakReport().
+ */
+typedef struct
+{
+    const SPP_Packet_t *p_packet;  /**< Held packet.                               */
+    spp_uint16_t        ownerApid; /**< Requesting or packetData() APID, or NONE.  */
+    spp_uint8_t         state;     /**< K_SPP_DATABANK_SLOT_ACQUIRED or _QUEUED.   */
+    spp_uint8_t         refCount;  /**< Live references at the time of the report. */
+    spp_uint32_t        heldMs;    /**< Time since getPacket() handed it out (ms). */
+} SPP_DatabankLeak_t;
+
 /* ----------------------------------------------------------------
  * Public API
  * ---------------------------------------------------------------- */
@@ -58,50 +154,258 @@ SPP_RetVal_t SPP_SERVICES_DATABANK_init(void);
 /**
  * @brief Acquire a free packet from the pool.
  *
- * The returned packet is removed from the free list until returned via
- * @ref SPP_SERVICES_DATABANK_returnPacket().
+ * Equivalent to @ref SPP_SERVICES_DATABANK_getPacketSized() with
+ * @ref K_SPP_DATABANK_DEFAULT_PAYLOAD.  The returned packet is removed from
+ * the free list until returned via @ref SPP_SERVICES_DATABANK_returnPacket().
+ * ISR- and multicore-safe when built with @ref SPP_DATABANK_LOCKFREE.
  *
  * @return Pointer to a free @ref SPP_Packet_t, or NULL if the pool is empty.
  */
 SPP_Packet_t *SPP_SERVICES_DATABANK_getPacket(void);
 
+/**
+ * @brief Acquire a free packet able to carry @p payloadLen bytes.
+ *
+ * Tries the smallest size class whose payload capacity is at least
+ * @p payloadLen, then each larger class in turn.
+ *
+ * @param[in] payloadLen  Payload bytes the caller intends to write.
+ *
+ * @return Pointer to a free @ref SPP_Packet_t, or NULL if every fitting
+ *         class is empty or @p payloadLen exceeds the largest class.
+ */
+SPP_Packet_t *SPP_SERVICES_DATABANK_getPacketSized(spp_uint16_t payloadLen);
+
+/**
+ * @brief Acquire a packet on behalf of @p apid, honouring quotas.
+ *
+ * Like @ref SPP_SERVICES_DATABANK_getPacketSized(), but the packet is
+ * charged to @p apid until its last reference is released.  The request is
+ * refused, and the APID's exhaustion counter incremented, when:
+ * - @p apid already holds its quota, or
+ * - @p apid has used up its own reservation and the only free packets left
+ *   are reserved for other APIDs, or
+ * - no fitting class has a free packet.
+ *
+ * APIDs without an entry may only use packets not reserved by others.
+ * @ref SPP_SERVICES_DATABANK_getPacket() and getPacketSized() request on
+ * behalf of @ref K_SPP_APID_NONE.  In lock-free mode the reservation check
+ * is a snapshot, so concurrent callers may briefly dip into a reservation.
+ *
+ * @param[in] apid        Requesting APID.
+ * @param[in] payloadLen  Payload bytes the caller intends to write.
+ *
+ * @return Pointer to a free @ref SPP_Packet_t, or NULL if refused.
+ */
+SPP_Packet_t *SPP_SERVICES_DATABANK_getPacketFor(spp_uint16_t apid, spp_uint16_t payloadLen);
+
+/**
+ * @brief Configure the reservation and quota for one APID.
+ *
+ * Call before producers start; the table itself is not updated atomically.
+ * Calling again for the same APID replaces its limits (counters are kept).
+ *
+ * @param[in] apid     APID to configure (not @ref K_SPP_APID_NONE).
+ * @param[in] reserve  Packets that only @p apid may take (0 = none).
+ * @param[in] quota    Max packets @p apid may hold at once, or
+ *                     @ref K_SPP_DATABANK_QUOTA_UNLIMITED.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p apid is NONE, @p reserve
+ *         exceeds @p quota, or all reservations together exceed the pool.
+ * @return K_SPP_ERROR if @ref K_SPP_DATABANK_MAX_QUOTAS APIDs are configured.
+ */
+SPP_RetVal_t SPP_SERVICES_DATABANK_setQuota(spp_uint16_t apid, spp_uint16_t reserve,
+                                            spp_uint16_t quota);
+
+/**
+ * @brief Return how many requests for @p apid were refused.
+ *
+ * @param[in] apid  Configured APID.
+ *
+ * @return Cumulative refusal count, or 0 if @p apid has no quota entry.
+ */
+spp_uint32_t SPP_SERVICES_DATABANK_exhaustedCount(spp_uint16_t apid);
+
+/**
+ * @brief Return the payload capacity of a pool packet.
+ *
+ * @param[in] p_packet  Pointer previously returned by the databank.
+ *
+ * @return Payload bytes backed by the packet's size class, or 0 if
+ *         @p p_packet is not a pool packet.
+ */
+spp_uint16_t SPP_SERVICES_DATABANK_payloadCapacity(const SPP_Packet_t *p_packet);
+
 /**
  * @brief Return a packet to the pool after processing.
  *
+ * Drops the caller's reference, exactly like
+ * @ref SPP_SERVICES_DATABANK_release(); the packet only re-enters the free
+ * list once every reference taken with @ref SPP_SERVICES_DATABANK_retain()
+ * has been released too.
+ *
  * @param[in] p_packet  Pointer previously returned by @ref SPP_SERVICES_DATABANK_getPacket().
  *
+ * The double-return guard is a single lookup in the per-slot reference
+ * count, so the cost does not grow with @ref K_SPP_DATABANK_SIZE.
+ *
  * @return K_SPP_OK on success.
  * @return K_SPP_ERROR_NULL_POINTER if @p p_packet is NULL.
- * @return K_SPP_ERROR if @p p_packet is not a valid pool address (double-return guard).
+ * @return K_SPP_ERROR if @p p_packet is not a valid pool address.
  * @return K_SPP_ERROR_ALREADY_INITIALIZED if the packet is already in the free list.
  */
 SPP_RetVal_t SPP_SERVICES_DATABANK_returnPacket(SPP_Packet_t *p_packet);
 
+/**
+ * @brief Take an additional reference to a leased packet.
+ *
+ * Call from a pub/sub handler to keep the packet valid after the handler
+ * returns.  A retained packet is read-only: other subscribers may still be
+ * reading it.
+ *
+ * @param[in] p_packet  Packet currently out of the pool.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_packet is NULL.
+ * @return K_SPP_ERROR if @p p_packet is not a leased pool packet or already
+ *         has @ref K_SPP_DATABANK_REF_MAX references.
+ */
+SPP_RetVal_t SPP_SERVICES_DATABANK_retain(const SPP_Packet_t *p_packet);
+
+/**
+ * @brief Drop one reference; the last one returns the packet to the pool.
+ *
+ * @param[in] p_packet  Packet previously retained (or leased).
+ *
+ * @return Same codes as @ref SPP_SERVICES_DATABANK_returnPacket().
+ */
+SPP_RetVal_t SPP_SERVICES_DATABANK_release(const SPP_Packet_t *p_packet);
+
+/**
+ * @brief Return the number of live references to a pool packet.
+ *
+ * @param[in] p_packet  Pool packet.
+ *
+ * @return Reference count (0 = in the free list or not a pool packet).
+ */
+spp_uint8_t SPP_SERVICES_DATABANK_refCount(const SPP_Packet_t *p_packet);
+
+/**
+ * @brief Mark a leased packet as waiting in the pub/sub deferred queue.
+ *
+ * Called by @ref SPP_SERVICES_PUBSUB_publish(); only affects what
+ * @ref SPP_SERVICES_DATABANK_leakReport() reports.
+ *
+ * @param[in] p_packet  Leased packet.
+ *
+ * @return K_SPP_OK, K_SPP_ERROR_NULL_POINTER, or K_SPP_ERROR if @p p_packet
+ *         is not a leased pool packet.
+ */
+SPP_RetVal_t SPP_SERVICES_DATABANK_markQueued(const SPP_Packet_t *p_packet);
+
+/**
+ * @brief List packets that have been out of the pool for too long.
+ *
+ * Walks the slot table once; intended for periodic diagnostics, not the
+ * hot path.
+ *
+ * @param[in]  thresholdMs  Report packets held at least this long.
+ * @param[out] p_out        Array receiving up to @p maxOut entries (may be NULL).
+ * @param[in]  maxOut       Capacity of @p p_out.
+ *
+ * @return Total number of packets over the threshold (may exceed @p maxOut).
+ */
+spp_uint32_t SPP_SERVICES_DATABANK_leakReport(spp_uint32_t thresholdMs,
+                                              SPP_DatabankLeak_t *p_out,
+                                              spp_uint32_t maxOut);
+
 /**
  * @brief Return the number of free packets currently available.
  *
+ * In lock-free mode the value is a snapshot and may already be stale when
+ * other cores are acquiring or returning packets.
+ *
  * @return Free packet count (0 … K_SPP_DATABANK_SIZE).
  */
 spp_uint32_t SPP_SERVICES_DATABANK_freeCount(void);
 
+/**
+ * @brief Return how many free packets could hold @p payloadLen bytes.
+ *
+ * Counts every class at least that large, since
+ * @ref SPP_SERVICES_DATABANK_getPacketSized() falls back to them.  Like
+ * @ref SPP_SERVICES_DATABANK_freeCount(), a snapshot in lock-free mode.
+ *
+ * @param[in] payloadLen  Payload size in bytes.
+ *
+ * @return Free packets of fitting classes.
+ */
+spp_uint32_t SPP_SERVICES_DATABANK_freeCountSized(spp_uint16_t payloadLen);
+
+/**
+ * @brief Start building a packet in place.
+ *
+ * Zeroes the header bytes (including struct padding) and writes the
+ * version, @p apid and @p seq; @c seqFlags defaults to
+ * @ref K_SPP_PKT_SEQ_UNSEGMENTED and may be changed before commit.  The
+ * payload is not touched: the producer writes its samples straight into
+ * the returned pointer, then calls
+ * @ref SPP_SERVICES_DATABANK_packetCommit().  The pointer is 4-byte aligned
+ * and valid for SPP_SERVICES_DATABANK_payloadCapacity() bytes.
+ *
+ * @code
+ * float *p_out = (float *)SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_MY_APID, s_seq);
+ * p_out[0] = ax; p_out[1] = ay; p_out[2] = az;
+ * if (SPP_SERVICES_DATABANK_packetCommit(p_pkt, 3U * sizeof(float)) == K_SPP_OK) s_seq++;
+ * @endcode
+ *
+ * @param[in,out] p_packet  Leased packet.
+ * @param[in]     apid      Application Process Identifier (also recorded as owner).
+ * @param[in]     seq       Packet sequence counter (maintained by the caller).
+ *
+ * @return Pointer to the payload, or NULL if @p p_packet is NULL.
+ */
+void *SPP_SERVICES_DATABANK_packetBegin(SPP_Packet_t *p_packet, spp_uint16_t apid,
+                                        spp_uint16_t seq);
+
+/**
+ * @brief Finish a packet started with @ref SPP_SERVICES_DATABANK_packetBegin().
+ *
+ * Sets @c payloadLen, captures the timestamp via @ref SPP_HAL_getTimeMs()
+ * and computes the CRC over the headers and the first @p dataLen payload
+ * bytes only.
+ *
+ * @param[in,out] p_packet  Packet passed to packetBegin().
+ * @param[in]     dataLen   Payload bytes written.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_packet is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p dataLen exceeds the payload capacity.
+ */
+SPP_RetVal_t SPP_SERVICES_DATABANK_packetCommit(SPP_Packet_t *p_packet, spp_uint16_t dataLen);
+
 /**
  * @brief Fill a packet with data and compute its CRC.
  *
- * Zeroes the entire packet (including any struct padding), writes all header
- * fields, copies @p p_data into the payload, and computes a CRC-16/CCITT
- * checksum over every byte of the packet except the @c crc field itself.
+ * Copying convenience wrapper: @ref SPP_SERVICES_DATABANK_packetBegin(),
+ * memcpy of @p p_data into the payload, then
+ * @ref SPP_SERVICES_DATABANK_packetCommit().  Prefer begin/commit when the
+ * payload can be written in place.
  *
  * The timestamp is captured automatically via @ref SPP_HAL_getTimeMs().
+ * @p apid is also recorded as the slot owner for leak reports.
  *
  * @param[out] p_packet  Packet previously acquired from @ref SPP_SERVICES_DATABANK_getPacket().
  * @param[in]  apid      Application Process Identifier.
  * @param[in]  seq       Packet sequence counter (maintained by the caller).
  * @param[in]  p_data    Pointer to the payload data to copy.
- * @param[in]  dataLen   Number of bytes to copy (must be ≤ K_SPP_PKT_PAYLOAD_MAX).
+ * @param[in]  dataLen   Number of bytes to copy (must fit the packet's size
+ *                       class, or K_SPP_PKT_PAYLOAD_MAX for non-pool packets).
  *
  * @return K_SPP_OK on success.
  * @return K_SPP_ERROR_NULL_POINTER if @p p_packet or @p p_data is NULL.
- * @return K_SPP_ERROR_INVALID_PARAMETER if @p dataLen exceeds K_SPP_PKT_PAYLOAD_MAX.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p dataLen exceeds the payload capacity.
  */
 SPP_RetVal_t SPP_SERVICES_DATABANK_packetData(SPP_Packet_t *p_packet, spp_uint16_t apid,
                                       spp_uint16_t seq, const void *p_data,
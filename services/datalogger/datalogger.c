@@ -2,17 +2,29 @@
  * @file datalogger.c
  * @brief SD card packet logger — writes every published packet to a text file.
  *
- * This module is a pure consumer: it has no produce() function and never reads
- * hardware directly.  It receives packets through pub/sub at PRIO_LOW, meaning
- * callConsumers() dispatches it one call at a time so SD card writes never
- * delay sensor reads.
+ * This module is a consumer: it never reads hardware directly.  It receives
+ * packets through pub/sub at PRIO_LOW, meaning callConsumers() dispatches it
+ * one batch per call so SD card writes never delay sensor reads.  It has
+ * no produce() hook, so it never keeps the superloop from sleeping.
  *
  * Log format:
  *   Log messages:   "[I] TAG: message text"
  *   Sensor packets: "ts=12345 apid=0x0004 seq=7 len=12 payload_hex=44 9A ..."
  *
- * Flush strategy: fflush() is called every K_FLUSH_EVERY packets.  Buffering
- * the writes in the C library reduces the number of physical SD card sectors
+ * Segmented log lines are written back-to-back and terminated only by their
+ * LAST segment, so the file shows one line per message.  If a segment is
+ * lost (pool dry, queue overflow, TTL), the fragment is ended with
+ * " [truncated]" and a newline, and a line that lost its FIRST segment
+ * starts with "[truncated] ", so the next message never runs on.
+ * Segmented sensor packets carry an extra "seg=<flags>" field before the
+ * payload.
+ *
+ * Batch strategy: pub/sub hands the handler every packet waiting for it at
+ * once.  If that makes K_SPP_DATALOGGER_BATCH packets, they are written
+ * straight away with a single fflush(); otherwise they are retained, not
+ * copied, until enough arrive or the oldest is K_SPP_DATALOGGER_MAX_HOLD_MS
+ * old; a one-shot timer, armed only while packets are held, enforces the
+ * latter.  One flush per batch reduces the number of physical SD card sectors
  * written per packet, which is the main bottleneck on a microSD card.
  */
 
@@ -20,13 +32,27 @@
 
 #include "spp/hal/storage.h"
 #include "spp/core/packet.h"
+#include "spp/services/databank/databank.h"
 #include "spp/services/log/log.h"
 #include "spp/core/types.h"
 
-#define K_FLUSH_EVERY (20U)
-
 static const char *const k_tag = "DATALOGGER";
 
+/* Medium packets left for log segments while a sensor burst is leased
+ * (up to K_SPP_PUBSUB_BATCH_MAX before publishMany()) and the logger
+ * retains a full batch. */
+#define K_DATALOGGER_MEDIUM_HEADROOM (8U)
+
+/* Marks where a log line lost segments. */
+#define K_DATALOGGER_CUT_MARK "[truncated]"
+
+#if K_SPP_DATABANK_MEDIUM_COUNT < \
+    (K_SPP_PUBSUB_BATCH_MAX + K_SPP_DATALOGGER_BATCH + K_DATALOGGER_MEDIUM_HEADROOM)
+#error "K_SPP_DATABANK_MEDIUM_COUNT too small for a sensor burst plus a retained logger batch"
+#endif
+
+static void dataloggerHoldExpired(void *p_ctx);
+
 /* ----------------------------------------------------------------
  * Mount / open / close
  * ---------------------------------------------------------------- */
@@ -48,22 +74,54 @@ SPP_RetVal_t SPP_SERVICES_DATALOGGER_init(Datalogger_t *p_logger)
         return K_SPP_ERROR;
     }
 
-    p_logger->is_open       = true;
+    p_logger->is_open        = true;
     p_logger->logged_packets = 0U;
+    p_logger->batch_count    = 0U;
+    p_logger->log_open       = false;
+    (void)SPP_SERVICES_TIMER_setup(&p_logger->hold_timer, dataloggerHoldExpired, p_logger);
     SPP_LOGI(k_tag, "Ready — logging to %s", p_logger->p_filePath);
     return K_SPP_OK;
 }
 
-SPP_RetVal_t SPP_SERVICES_DATALOGGER_flush(Datalogger_t *p_logger)
+/* Write the retained packets, then @p count more the caller still owns,
+ * and fflush() once for all of them. */
+static SPP_RetVal_t dataloggerWrite(Datalogger_t *p_logger,
+                                    const SPP_Packet_t *const *pp_packets, spp_uint16_t count)
 {
-    if (!p_logger->is_open) return K_SPP_ERROR;
+    SPP_RetVal_t ret = K_SPP_OK;
+    for (spp_uint8_t i = 0U; i < p_logger->batch_count; i++)
+    {
+        if (SPP_SERVICES_DATALOGGER_logPacket(p_logger, p_logger->p_batch[i]) != K_SPP_OK)
+        {
+            ret = K_SPP_ERROR;
+        }
+        (void)SPP_SERVICES_DATABANK_release(p_logger->p_batch[i]);
+        p_logger->p_batch[i] = NULL;
+    }
+    p_logger->batch_count = 0U;
+    (void)SPP_SERVICES_TIMER_cancel(&p_logger->hold_timer);
+
+    for (spp_uint16_t i = 0U; i < count; i++)
+    {
+        if (SPP_SERVICES_DATALOGGER_logPacket(p_logger, pp_packets[i]) != K_SPP_OK)
+        {
+            ret = K_SPP_ERROR;
+        }
+    }
 
     if (fflush(p_logger->p_file) != 0)
     {
         SPP_LOGE(k_tag, "fflush failed");
         return K_SPP_ERROR;
     }
-    return K_SPP_OK;
+    return ret;
+}
+
+SPP_RetVal_t SPP_SERVICES_DATALOGGER_flush(Datalogger_t *p_logger)
+{
+    if (!p_logger->is_open) return K_SPP_ERROR;
+
+    return dataloggerWrite(p_logger, NULL, 0U);
 }
 
 SPP_RetVal_t SPP_SERVICES_DATALOGGER_deinit(Datalogger_t *p_logger)
@@ -72,7 +130,12 @@ SPP_RetVal_t SPP_SERVICES_DATALOGGER_deinit(Datalogger_t *p_logger)
 
     if (p_logger->is_open)
     {
-        (void)fflush(p_logger->p_file);
+        (void)SPP_SERVICES_DATALOGGER_flush(p_logger);
+        if (p_logger->log_open)
+        {
+            (void)fprintf(p_logger->p_file, " " K_DATALOGGER_CUT_MARK "\n");
+            p_logger->log_open = false;
+        }
         fclose(p_logger->p_file);
         p_logger->p_file = NULL;
         p_logger->is_open = false;
@@ -105,22 +168,46 @@ SPP_RetVal_t SPP_SERVICES_DATALOGGER_logPacket(Datalogger_t *p_logger,
 
     if (p_packet->primaryHeader.apid == K_SPP_APID_LOG)
     {
-        /* Log message — payload is a null-terminated string, write as-is. */
-        n = fprintf(p_logger->p_file, "%.*s\n",
+        /* Log message — payload is a string (null-terminated in its last
+         * segment), write as-is and end the line once the message is whole. */
+        spp_uint8_t  flags   = p_packet->primaryHeader.seqFlags;
+        spp_uint16_t seq     = p_packet->primaryHeader.seq;
+        spp_bool_t   isStart = (spp_bool_t)((flags == K_SPP_PKT_SEQ_FIRST) ||
+                                            (flags == K_SPP_PKT_SEQ_UNSEGMENTED));
+        spp_bool_t   isEnd   = (spp_bool_t)((flags == K_SPP_PKT_SEQ_LAST) ||
+                                            (flags == K_SPP_PKT_SEQ_UNSEGMENTED));
+
+        /* A new line or a seq gap while one is open: its tail was lost. */
+        if (p_logger->log_open && (isStart || (seq != p_logger->log_next_seq)))
+        {
+            (void)fprintf(p_logger->p_file, " " K_DATALOGGER_CUT_MARK "\n");
+            p_logger->log_open = false;
+        }
+        n = fprintf(p_logger->p_file, "%s%.*s%s",
+                    (!isStart && !p_logger->log_open) ? K_DATALOGGER_CUT_MARK " " : "",
                     (int)p_packet->primaryHeader.payloadLen,
-                    (const char *)p_packet->payload);
+                    (const char *)p_packet->payload, isEnd ? "\n" : "");
+        p_logger->log_open     = (spp_bool_t)!isEnd;
+        p_logger->log_next_seq = (spp_uint16_t)(seq + 1U);
     }
     else
     {
         /* Sensor packet — write header fields then payload bytes as hex. */
         n = fprintf(p_logger->p_file,
-                    "ts=%lu apid=0x%04X seq=%u len=%u payload_hex=",
+                    "ts=%lu apid=0x%04X seq=%u len=%u",
                     (unsigned long)p_packet->secondaryHeader.timestampMs,
                     (unsigned)p_packet->primaryHeader.apid,
                     (unsigned)p_packet->primaryHeader.seq,
                     (unsigned)p_packet->primaryHeader.payloadLen);
         if (n < 0) return K_SPP_ERROR;
 
+        if (p_packet->primaryHeader.seqFlags != K_SPP_PKT_SEQ_UNSEGMENTED)
+        {
+            (void)fprintf(p_logger->p_file, " seg=%u",
+                          (unsigned)p_packet->primaryHeader.seqFlags);
+        }
+        (void)fprintf(p_logger->p_file, " payload_hex=");
+
         for (spp_uint16_t i = 0U; i < p_packet->primaryHeader.payloadLen; i++)
         {
             (void)fprintf(p_logger->p_file, "%s%02X",
@@ -140,18 +227,45 @@ SPP_RetVal_t SPP_SERVICES_DATALOGGER_logPacket(Datalogger_t *p_logger,
  * Module descriptor — called by register(), never by main.c directly
  * ---------------------------------------------------------------- */
 
-static void dataloggerOnPacket(const SPP_Packet_t *p_packet, void *p_ctx)
+static void dataloggerOnPackets(const SPP_Packet_t *const *pp_packets, spp_uint16_t count,
+                               void *p_ctx)
 {
     Datalogger_t *p_logger = (Datalogger_t *)p_ctx;
 
-    (void)SPP_SERVICES_DATALOGGER_logPacket(p_logger, p_packet);
+    if (!p_logger->is_open) return;
 
-    /* Flush to SD card every K_FLUSH_EVERY packets.  Infrequent flushing lets
-     * the C library buffer multiple writes, reducing microSD sector pressure. */
-    if ((p_logger->logged_packets % K_FLUSH_EVERY) == 0U)
+    /* Enough for a batch: write it now, while pub/sub still holds the
+     * packets, together with anything retained earlier. */
+    if (((spp_uint32_t)p_logger->batch_count + count) >= K_SPP_DATALOGGER_BATCH)
     {
-        (void)SPP_SERVICES_DATALOGGER_flush(p_logger);
+        (void)dataloggerWrite(p_logger, pp_packets, count);
+        return;
     }
+
+    /* Otherwise keep them; fall back to an immediate write if a packet
+     * cannot be retained (e.g. not a databank packet). */
+    spp_bool_t wasEmpty = (spp_bool_t)(p_logger->batch_count == 0U);
+    for (spp_uint16_t i = 0U; i < count; i++)
+    {
+        if (SPP_SERVICES_DATABANK_retain(pp_packets[i]) != K_SPP_OK)
+        {
+            (void)SPP_SERVICES_DATALOGGER_logPacket(p_logger, pp_packets[i]);
+            continue;
+        }
+        p_logger->p_batch[p_logger->batch_count++] = pp_packets[i];
+    }
+
+    /* Bound how long retained packets stay out of the pool at low rates. */
+    if (wasEmpty && (p_logger->batch_count > 0U))
+    {
+        (void)SPP_SERVICES_TIMER_start(&p_logger->hold_timer, K_SPP_DATALOGGER_MAX_HOLD_MS, 0U);
+    }
+}
+
+/* Hold timer: the oldest retained packet has waited long enough. */
+static void dataloggerHoldExpired(void *p_ctx)
+{
+    (void)SPP_SERVICES_DATALOGGER_flush((Datalogger_t *)p_ctx);
 }
 
 static SPP_RetVal_t dataloggerInit(void *p_ctx)
@@ -170,15 +284,16 @@ static SPP_RetVal_t dataloggerDeinit(void *p_ctx)
 }
 
 const SPP_Module_t g_sdLoggerModule = {
-    .p_name       = "sd_logger",
-    .apid         = K_SPP_APID_NONE,       /* produces nothing          */
-    .ctxSize      = sizeof(Datalogger_t),
-    .init         = dataloggerInit,
-    .start        = NULL,
-    .stop         = dataloggerStop,         /* flush on stop             */
-    .deinit       = dataloggerDeinit,
-    .produce      = NULL,                   /* consumer only — no sensor */
-    .consumesApid = K_SPP_APID_ALL,        /* receives every packet     */
-    .onPacket     = dataloggerOnPacket,
-    .onPacketPrio = K_SPP_PUBSUB_PRIO_LOW, /* deferred — never blocks sensors */
+    .p_name        = "sd_logger",
+    .apid          = K_SPP_APID_NONE,       /* produces nothing          */
+    .ctxSize       = sizeof(Datalogger_t),
+    .init          = dataloggerInit,
+    .start         = NULL,
+    .stop          = dataloggerStop,        /* flush on stop             */
+    .deinit        = dataloggerDeinit,
+    .produce       = NULL,                  /* aged batches: hold timer  */
+    .consumesApid  = K_SPP_APID_ALL,        /* receives every packet     */
+    .onPacket      = NULL,
+    .onPacketPrio  = K_SPP_PUBSUB_PRIO_LOW, /* deferred — never blocks sensors */
+    .onPacketBatch = dataloggerOnPackets,   /* everything waiting, per call */
 };
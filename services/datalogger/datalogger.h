@@ -18,6 +18,7 @@
 #include "spp/core/returnTypes.h"
 #include "spp/core/packet.h"
 #include "spp/services/service.h"
+#include "spp/services/timer/timer.h"
 #include "spp/util/macros.h"
 
 #include <stdio.h>
@@ -27,6 +28,20 @@
 extern "C" {
 #endif
 
+/* ----------------------------------------------------------------
+ * Constants
+ * ---------------------------------------------------------------- */
+
+/** @brief Packets retained by the logger before they are written in one batch. */
+#ifndef K_SPP_DATALOGGER_BATCH
+#define K_SPP_DATALOGGER_BATCH (8U)
+#endif
+
+/** @brief Longest a retained packet may wait before its batch is written (ms). */
+#ifndef K_SPP_DATALOGGER_MAX_HOLD_MS
+#define K_SPP_DATALOGGER_MAX_HOLD_MS (250U)
+#endif
+
 /* ----------------------------------------------------------------
  * Data types
  * ---------------------------------------------------------------- */
@@ -54,13 +69,26 @@ typedef struct
     FILE       *p_file;          /**< Open file handle, or NULL if not open. */
     spp_bool_t  is_open;         /**< true once mounted and file is open.    */
     uint32_t    logged_packets;  /**< Number of packets written so far.      */
+
+    const SPP_Packet_t *p_batch[K_SPP_DATALOGGER_BATCH]; /**< Retained, not yet written. */
+    spp_uint8_t         batch_count;                     /**< Entries used in p_batch.   */
+    SPP_Timer_t         hold_timer;                      /**< Runs while p_batch is used. */
+
+    spp_bool_t   log_open;     /**< A segmented log line awaits its LAST segment. */
+    spp_uint16_t log_next_seq; /**< Sequence count the open log line expects next. */
 } Datalogger_t;
 
 /**
  * @brief SD card logger module descriptor — pass to SPP_SERVICES_register().
  *
  * Subscribes to K_SPP_APID_ALL at K_SPP_PUBSUB_PRIO_LOW; every published
- * packet is appended to the log file.
+ * packet is appended to the log file.  Pub/sub hands it every waiting
+ * packet per dispatch; they are written in batches of
+ * @ref K_SPP_DATALOGGER_BATCH (retained, not copied, until then), or once
+ * the oldest has waited @ref K_SPP_DATALOGGER_MAX_HOLD_MS.  It has no
+ * produce hook: a one-shot timer, armed only while packets are retained,
+ * writes aged batches, so the logger never keeps SPP_SERVICES_idle()
+ * awake.
  */
 extern const SPP_Module_t g_sdLoggerModule;
 
@@ -91,11 +119,14 @@ SPP_RetVal_t SPP_SERVICES_DATALOGGER_init(Datalogger_t *p_logger);
 SPP_RetVal_t SPP_SERVICES_DATALOGGER_logPacket(Datalogger_t *p_logger, const SPP_Packet_t *p_packet);
 
 /**
- * @brief Flush buffered data to the SD card.
+ * @brief Write the pending packet batch and flush buffered data to the SD card.
+ *
+ * Every retained packet is written and released, then the C library buffer
+ * is flushed once for the whole batch.
  *
  * @param[in,out] p_logger  Datalogger context.
  *
- * @return K_SPP_OK on success, K_SPP_ERROR on flush failure.
+ * @return K_SPP_OK on success, K_SPP_ERROR on write or flush failure.
  */
 SPP_RetVal_t SPP_SERVICES_DATALOGGER_flush(Datalogger_t *p_logger);
 
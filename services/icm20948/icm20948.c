@@ -44,6 +44,7 @@
 #define K_ICM20948_DMP_START_ADDR_MSB    0x10U
 #define K_ICM20948_DMP_START_ADDR_LSB    0x00U
 #define K_ICM20948_LOG_TAG               "ICM"
+#define K_ICM20948_SERVICE_PAYLOAD_LEN   (9U * (spp_uint16_t)sizeof(float))
 
 /* ----------------------------------------------------------------
  * Private types
@@ -1333,6 +1334,35 @@ SPP_RetVal_t SPP_SERVICES_ICM20948_configDmpInit(void *p_data)
     return K_SPP_OK;
 }
 
+/* Lease a packet and write lastData into it, or NULL if none is free.
+ * A pool miss is not logged here: the caller reports once per burst. */
+static SPP_Packet_t *icm20948SamplePacket(ICM20948_t *p_ctx)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketFor(K_ICM20948_SERVICE_APID,
+                                                             K_ICM20948_SERVICE_PAYLOAD_LEN);
+    if (p_pkt == NULL)
+    {
+        return NULL;
+    }
+
+    /* Write the 9 samples straight into the packet — no staging buffer. */
+    float *p_out = (float *)SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_ICM20948_SERVICE_APID,
+                                                              p_ctx->seq);
+    p_out[0] = p_ctx->lastData.ax; p_out[1] = p_ctx->lastData.ay; p_out[2] = p_ctx->lastData.az;
+    p_out[3] = p_ctx->lastData.gx; p_out[4] = p_ctx->lastData.gy; p_out[5] = p_ctx->lastData.gz;
+    p_out[6] = p_ctx->lastData.mx; p_out[7] = p_ctx->lastData.my; p_out[8] = p_ctx->lastData.mz;
+
+    SPP_RetVal_t ret = SPP_SERVICES_DATABANK_packetCommit(p_pkt, K_ICM20948_SERVICE_PAYLOAD_LEN);
+    if (ret != K_SPP_OK)
+    {
+        SPP_LOGE(K_ICM20948_LOG_TAG, "packetCommit failed ret=%d", (int)ret);
+        (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+        return NULL;
+    }
+    p_ctx->seq++;
+    return p_pkt;
+}
+
 void SPP_SERVICES_ICM20948_checkFifoData(ICM20948_t *p_ctx)
 {
     void *p_spi = p_ctx->p_spi;
@@ -1399,7 +1429,10 @@ void SPP_SERVICES_ICM20948_checkFifoData(ICM20948_t *p_ctx)
                 }
 
                 {
-                    spp_uint16_t numPackets = fifoCount / K_ICM20948_DMP_PACKET_SIZE_BYTES;
+                    spp_uint16_t  numPackets = fifoCount / K_ICM20948_DMP_PACKET_SIZE_BYTES;
+                    SPP_Packet_t *p_batch[K_SPP_PUBSUB_BATCH_MAX];
+                    spp_uint16_t  batched    = 0U;
+                    spp_uint16_t  dropped    = 0U;
 
                     for (spp_uint16_t i = 0U; i < numPackets; i++)
                     {
@@ -1410,7 +1443,7 @@ void SPP_SERVICES_ICM20948_checkFifoData(ICM20948_t *p_ctx)
                         ret = readFifoBurst(p_spi, fifoBuffer, K_ICM20948_DMP_PACKET_SIZE_BYTES);
                         if (ret != K_SPP_OK)
                         {
-                            return;
+                            break; /* Still publish the samples read so far. */
                         }
 
                         if (i == 0U)
@@ -1475,6 +1508,32 @@ void SPP_SERVICES_ICM20948_checkFifoData(ICM20948_t *p_ctx)
                             p_ctx->lastData.mz        = 0.0f;
                             p_ctx->lastData.dataReady = true;
                         }
+
+                        p_batch[batched] = icm20948SamplePacket(p_ctx);
+                        if (p_batch[batched] != NULL)
+                        {
+                            batched++;
+                        }
+                        else
+                        {
+                            dropped++;
+                        }
+                        if (batched == K_SPP_PUBSUB_BATCH_MAX)
+                        {
+                            (void)SPP_SERVICES_PUBSUB_publishMany(p_batch, batched);
+                            batched = 0U;
+                        }
+                    }
+
+                    /* The rest of the burst, matched in one pass. */
+                    if (batched != 0U)
+                    {
+                        (void)SPP_SERVICES_PUBSUB_publishMany(p_batch, batched);
+                    }
+                    if (dropped != 0U)
+                    {
+                        SPP_LOGI(K_ICM20948_LOG_TAG, "No free packet for %u of %u samples",
+                                 (unsigned)dropped, (unsigned)numPackets);
                     }
                 }
             }
@@ -1488,8 +1547,9 @@ void SPP_SERVICES_ICM20948_checkFifoData(ICM20948_t *p_ctx)
 
 void SPP_SERVICES_ICM20948_init(ICM20948_Data_t *p_icm)
 {
-    p_icm->drdyFlag       = false;
-    p_icm->isr_ctx.p_flag = &p_icm->drdyFlag;
+    p_icm->drdyFlag            = false;
+    p_icm->isr_ctx.p_flag      = &p_icm->drdyFlag;
+    p_icm->isr_ctx.p_readyMask = NULL;
     SPP_HAL_gpioConfigInterrupt(p_icm->intPin, p_icm->intIntrType, p_icm->intPull);
     SPP_HAL_gpioRegisterIsr(p_icm->intPin, (void *)&p_icm->isr_ctx);
 }
@@ -1506,37 +1566,8 @@ static void icm20948Task(void *p_arg)
     ctx->icmData.drdyFlag      = false;
     ctx->lastData.dataReady    = false;
 
+    /* Publishes every FIFO sample, a burst at a time. */
     SPP_SERVICES_ICM20948_checkFifoData(ctx);
-
-    if (!ctx->lastData.dataReady)
-    {
-        return;
-    }
-
-    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
-    if (p_pkt == NULL)
-    {
-        SPP_LOGI(K_ICM20948_LOG_TAG, "No free packet");
-        return;
-    }
-
-    float payload[9] = {
-        ctx->lastData.ax, ctx->lastData.ay, ctx->lastData.az,
-        ctx->lastData.gx, ctx->lastData.gy, ctx->lastData.gz,
-        ctx->lastData.mx, ctx->lastData.my, ctx->lastData.mz,
-    };
-
-    SPP_RetVal_t ret = SPP_SERVICES_DATABANK_packetData(p_pkt, K_ICM20948_SERVICE_APID,
-                                                ctx->seq++, payload,
-                                                (spp_uint16_t)sizeof(payload));
-    if (ret != K_SPP_OK)
-    {
-        SPP_LOGE(K_ICM20948_LOG_TAG, "packetData failed ret=%d", (int)ret);
-        (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
-        return;
-    }
-
-    (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
 }
 
 /* Stub implementations for functions declared in the header but not yet
@@ -1587,6 +1618,7 @@ static SPP_RetVal_t icm20948Init(void *p_ctx)
     ctx->icmData.intPull     = ctx->intPull;
 
     SPP_SERVICES_ICM20948_init(&ctx->icmData);
+    (void)SPP_SERVICES_bindReady(p_ctx, &ctx->icmData.isr_ctx);
 
     SPP_LOGI(K_ICM20948_LOG_TAG, "Init (spiDevIdx=%u intPin=%u)", ctx->spiDevIdx, ctx->intPin);
     return K_SPP_OK;
@@ -423,7 +423,7 @@ typedef union
  * Service types
  * ---------------------------------------------------------------- */
 
-/** @brief APID produced by the ICM20948 module (single bit, bitmask scheme). */
+/** @brief APID produced by the ICM20948 module. */
 #define K_ICM20948_SERVICE_APID (0x0002U)
 
 /**
@@ -8,6 +8,18 @@
 #include "spp/util/macros.h"
 #include "spp/services/log/log.h"
 #include "spp/core/error.h"
+#include "spp/hal/time.h"
+#include "spp/hal/storage.h"
+#include "spp/util/structof.h"
+
+#include <string.h>
+
+#if SPP_PUBSUB_MPSC
+#include <stdatomic.h>
+#if !SPP_DATABANK_LOCKFREE
+#error "SPP_PUBSUB_MPSC requires SPP_DATABANK_LOCKFREE"
+#endif
+#endif
 
 /* ----------------------------------------------------------------
  * Private types
@@ -15,17 +27,86 @@
 
 typedef struct
 {
-    spp_uint16_t         apid;
-    spp_uint8_t          prio;
-    SPP_PubSub_Handler_t handler;
-    void                *p_ctx;
+    spp_uint8_t               prio;
+    SPP_PubSub_Handler_t      handler;
+    SPP_PubSub_BatchHandler_t batchHandler; /* Set instead of handler. */
+    spp_uint16_t              batchMax;     /* Packets per call; 1 for handler. */
+    void                     *p_ctx;
+    spp_uint16_t              decimation;
+    spp_uint16_t              skip;         /* Matches still to discard before the next delivery. */
+    spp_uint32_t              minPeriodMs;
+    spp_uint32_t              lastMs;       /* Time of the last delivery, if delivered. */
+    spp_bool_t                delivered;
+    spp_uint32_t              deadlineUs;   /* Relative deadline, 0 = none. */
+    spp_uint16_t              misses;       /* Deliveries that finished late. */
+    spp_uint32_t              maxAgeMs;     /* Skip packets older than this, 0 = none. */
+    spp_uint8_t               group;        /* Consumer group, 0 = none. */
+    spp_uint16_t              queued;       /* Deliveries waiting; kept for group members only. */
+#if !SPP_NO_PUBSUB_STATS
+    SPP_PubSub_SubStats_t     stats;
+#endif
 } SubEntry_t;
 
+/* Bit i of a SubMask_t stands for s_subs[i].  The table is sorted by prio,
+ * so lowest set bit first is priority order. */
+typedef spp_uint32_t SubMask_t;
+
+#if K_SPP_PUBSUB_MAX_SUBSCRIBERS > 32U
+#error "K_SPP_PUBSUB_MAX_SUBSCRIBERS must fit in a 32-bit subscriber mask"
+#endif
+
+#if (K_SPP_PUBSUB_MAX_APIDS > 128U) || ((K_SPP_PUBSUB_MAX_APIDS & (K_SPP_PUBSUB_MAX_APIDS - 1U)) != 0U)
+#error "K_SPP_PUBSUB_MAX_APIDS must be a power of 2, <= 128"
+#endif
+
+#if K_SPP_PUBSUB_ROUTE_BLOCKS > 254U
+#error "K_SPP_PUBSUB_ROUTE_BLOCKS must be <= 254"
+#endif
+
+#if K_SPP_PUBSUB_PRIO_LOW != K_SPP_PKT_LINK_LEVELS
+#error "SPP_PacketLink_t needs one successor per deferred priority level"
+#endif
+
+/* One intrusive FIFO per deferred priority, threaded through the packets'
+ * links, so a slow LOW subscriber never holds up HIGH work queued behind
+ * it.  A packet holds one reference per level it is queued at, and its
+ * link's pending mask carries the subscribers of all of them. */
+typedef struct
+{
+    SPP_PacketLink_t *p_head;
+    SPP_PacketLink_t *p_tail;
+    spp_uint16_t      count;
+    spp_uint16_t      limit; /* Depth that triggers the overflow policy, 0 = none. */
+} LevelQueue_t;
+
+#define K_PUBSUB_LEVELS (K_SPP_PUBSUB_PRIO_LOW)
+
+#if !SPP_NO_STORAGE
+/* Header of a spilled packet; its payload follows it in the file. */
 typedef struct
 {
-    SPP_Packet_t *p_pkt;
-    spp_uint8_t   nextSubIdx;
-} QueueEntry_t;
+    SPP_PacketPrimary_t   primary;
+    SPP_PacketSecondary_t secondary;
+    spp_uint16_t          crc;
+    SubMask_t             pending;
+    spp_uint32_t          pubUs;
+} SpillRecord_t;
+#endif
+
+/* Per-APID entry shared by APIDs that found no free one. */
+#define K_APID_OTHER (K_SPP_PUBSUB_MAX_APIDS)
+
+/* The routing table splits the APID space into pages of 32. */
+#define K_ROUTE_PAGE_BITS (5U)
+#define K_ROUTE_PAGE_SIZE (1U << K_ROUTE_PAGE_BITS)
+#define K_ROUTE_PAGES     (K_SPP_APID_COUNT / K_ROUTE_PAGE_SIZE)
+
+#if SPP_PUBSUB_MPSC
+/* Producers look APID entries up while the consumer adds them. */
+#define PUBSUB_ATOMIC _Atomic
+#else
+#define PUBSUB_ATOMIC
+#endif
 
 /* ----------------------------------------------------------------
  * Private state
@@ -37,223 +118,2221 @@ static SubEntry_t  s_subs[K_SPP_PUBSUB_MAX_SUBSCRIBERS];
 static spp_uint8_t s_count       = 0U;
 static spp_bool_t  s_initialized = false;
 
-static QueueEntry_t s_queue[K_SPP_PUBSUB_QUEUE_SIZE];
-static spp_uint8_t  s_head   = 0U;
-static spp_uint8_t  s_tail   = 0U;
-static spp_uint8_t  s_qCount = 0U;
+/* s_levels[0] = HIGH … s_levels[K_PUBSUB_LEVELS - 1] = LOW. */
+static LevelQueue_t s_levels[K_PUBSUB_LEVELS];
+
+/* Per-APID entries, open-addressed by APID (K_SPP_APID_NONE = free), plus
+ * the shared K_APID_OTHER entry at the end of each table. */
+static PUBSUB_ATOMIC spp_uint16_t s_apidKey[K_SPP_PUBSUB_MAX_APIDS];
+
+/* Overflow counters, in total and per policy that resolved the overflow. */
+static spp_uint16_t s_overflowCount[K_SPP_PUBSUB_MAX_APIDS + 1U];
+static spp_uint16_t s_policyCount[K_SPP_PUBSUB_MAX_APIDS + 1U][K_SPP_PUBSUB_OVF_POLICIES];
 
-/* One counter per bit position of the 16-bit APID field. */
-static spp_uint16_t s_overflowCount[16U];
+#if SPP_PUBSUB_MPSC
+/* Intrusive MPSC intake (Vyukov): producers swap themselves in at the head,
+ * the consumer walks from the tail.  The stub keeps the list non-empty so a
+ * push never has to touch the tail. */
+static SPP_PacketLink_t          s_intakeStub;
+static SPP_PacketLink_t *_Atomic s_intakeHead; /* Swapped by producers. */
+static SPP_PacketLink_t         *s_intakeTail; /* Consumer only.        */
+#endif
+
+#if !SPP_NO_STORAGE
+/* Spill FIFO, a ring in the file: records from s_spillRd up to s_spillWr,
+ * oldest first.  Once the writer has wrapped to the top, s_spillEnd marks
+ * the end of the older records and the reader wraps there (0 = not
+ * wrapped).  The head record's header is kept once read, while it waits
+ * for room. */
+static void         *s_spillFile      = NULL;
+static spp_uint32_t  s_spillRd        = 0U;
+static spp_uint32_t  s_spillWr        = 0U;
+static spp_uint32_t  s_spillEnd       = 0U;
+static spp_uint32_t  s_spillCount     = 0U;
+static spp_uint16_t  s_spillLowWater  = 0U;
+static SpillRecord_t s_spillHead;
+static spp_bool_t    s_spillHeadValid = false;
+
+/* Records waiting in the file per APID entry, so packets lost with the
+ * file are counted against their own APIDs. */
+static spp_uint32_t s_spillApid[K_APID_OTHER + 1U];
+
+/* Packets bound for the spill file, linked through p_next[0]; written by
+ * the consumer so producers never wait on storage. */
+static SPP_PacketLink_t *s_spillBackHead = NULL;
+static SPP_PacketLink_t *s_spillBackTail = NULL;
+#endif
+
+/* Overflow policy and DROP_LOWEST rank per APID entry; the K_APID_OTHER
+ * values are the defaults new entries start from. */
+static spp_uint8_t s_policy[K_SPP_PUBSUB_MAX_APIDS + 1U];
+static spp_uint8_t s_rank[K_SPP_PUBSUB_MAX_APIDS + 1U];
+
+/* Time-to-live and expired-packet counter per APID entry; s_apidTtl is set
+ * once any entry has a TTL, so dispatch only reads the clock when needed. */
+static spp_uint32_t s_maxAgeMs[K_SPP_PUBSUB_MAX_APIDS + 1U];
+static spp_uint16_t s_expiredCount[K_SPP_PUBSUB_MAX_APIDS + 1U];
+static spp_bool_t   s_apidTtl = false;
+
+/* Routing table, extended on subscribe.  s_pageAll[p] holds the subscribers
+ * taking every APID of page p; a page some subscriber covers only in part
+ * also gets a block of per-APID masks (s_pageBlock[p] = block index + 1).
+ * Wildcard subscribers sit in s_routeAll and match every packet. */
+static SubMask_t   s_routeAll = 0U;
+static SubMask_t   s_pageAll[K_ROUTE_PAGES];
+static spp_uint8_t s_pageBlock[K_ROUTE_PAGES];
+static SubMask_t   s_blocks[K_SPP_PUBSUB_ROUTE_BLOCKS][K_ROUTE_PAGE_SIZE];
+static spp_uint8_t s_blocksUsed = 0U;
+
+/* Rebuilt on subscribe: the SYNC subset and the subset served by each
+ * deferred level. */
+static SubMask_t s_syncSubs = 0U;
+static SubMask_t s_levelSubs[K_PUBSUB_LEVELS];
+
+/* Subscribers with a decimation or rate-limit filter. */
+static SubMask_t s_filterSubs = 0U;
+
+/* Subscribers with a deadline, served earliest deadline first. */
+static SubMask_t s_edfSubs = 0U;
+
+/* Subscribers with a maximum packet age. */
+static SubMask_t s_ttlSubs = 0U;
+
+/* Consumer groups: members of each group, all members, and per group the
+ * mode and the member that got the last packet. */
+static SubMask_t   s_groupSubs[K_SPP_PUBSUB_MAX_GROUPS];
+static SubMask_t   s_groupedSubs = 0U;
+static spp_uint8_t s_groupMode[K_SPP_PUBSUB_MAX_GROUPS];
+static spp_uint8_t s_groupLast[K_SPP_PUBSUB_MAX_GROUPS];
+
+#if !SPP_NO_PUBSUB_STATS
+/* Per APID entry, like the overflow counters. */
+static SPP_PubSub_Hist_t s_apidWait[K_SPP_PUBSUB_MAX_APIDS + 1U];
+static SPP_PubSub_Hist_t s_apidLife[K_SPP_PUBSUB_MAX_APIDS + 1U];
+#endif
 
 /* ----------------------------------------------------------------
  * Private helpers
  * ---------------------------------------------------------------- */
 
-#define K_QUEUE_MASK ((spp_uint8_t)(K_SPP_PUBSUB_QUEUE_SIZE - 1U))
-
-static spp_bool_t apidMatches(spp_uint16_t subApid, spp_uint16_t pktApid)
+static spp_uint8_t lowestBit(SubMask_t mask)
 {
-    if (subApid == K_SPP_APID_NONE) return false;
-    if (subApid == K_SPP_APID_ALL)  return true;
-    return (spp_bool_t)((subApid & pktApid) != 0U);
+#if defined(__GNUC__)
+    return (spp_uint8_t)__builtin_ctz(mask);
+#else
+    spp_uint8_t bit = 0U;
+    while ((mask & 1U) == 0U)
+    {
+        mask >>= 1U;
+        bit++;
+    }
+    return bit;
+#endif
 }
 
-static void overflowIncrement(spp_uint16_t apid)
+/* Rebuild the subscriber classes (SYNC, per level, filtered) from s_subs. */
+static void classRebuild(void)
 {
-    spp_uint8_t bit;
-    for (bit = 0U; bit < 16U; bit++)
+    spp_uint8_t i;
+
+    s_syncSubs    = 0U;
+    s_filterSubs  = 0U;
+    s_edfSubs     = 0U;
+    s_ttlSubs     = 0U;
+    s_groupedSubs = 0U;
+    for (i = 0U; i < K_PUBSUB_LEVELS; i++)
+    {
+        s_levelSubs[i] = 0U;
+    }
+    for (i = 0U; i < K_SPP_PUBSUB_MAX_GROUPS; i++)
+    {
+        s_groupSubs[i] = 0U;
+    }
+
+    for (i = 0U; i < s_count; i++)
     {
-        if ((apid & (spp_uint16_t)(1U << bit)) != 0U)
+        SubMask_t m = (SubMask_t)1U << i;
+
+        if (s_subs[i].prio == K_SPP_PUBSUB_PRIO_SYNC)
         {
-            if (s_overflowCount[bit] < 0xFFFFU)
-            {
-                s_overflowCount[bit]++;
-            }
+            s_syncSubs |= m;
+        }
+        else
+        {
+            s_levelSubs[s_subs[i].prio - 1U] |= m;
+        }
+        if ((s_subs[i].decimation > 1U) || (s_subs[i].minPeriodMs != 0U))
+        {
+            s_filterSubs |= m;
+        }
+        if (s_subs[i].deadlineUs != 0U)
+        {
+            s_edfSubs |= m;
+        }
+        if (s_subs[i].maxAgeMs != 0U)
+        {
+            s_ttlSubs |= m;
+        }
+        if (s_subs[i].group != 0U)
+        {
+            s_groupSubs[s_subs[i].group - 1U] |= m;
+            s_groupedSubs                     |= m;
         }
     }
 }
 
-/* ----------------------------------------------------------------
- * Public API
- * ---------------------------------------------------------------- */
+/* Open a zero bit at position pos so queued masks keep pointing at the same
+ * subscribers after an insertion into the sorted table. */
+static SubMask_t maskInsertAt(SubMask_t mask, spp_uint8_t pos)
+{
+    SubMask_t low = mask & (((SubMask_t)1U << pos) - 1U);
+    return low | ((mask & ~low) << 1U);
+}
 
-void SPP_SERVICES_PUBSUB_init(void)
+/* APIDs of one page that a subscription covers (bit j = APID page*32 + j).
+ * Wildcards are routed separately and cover nothing here. */
+static spp_uint32_t coverWord(const SPP_PubSub_SubCfg_t *p_cfg, spp_uint8_t page)
 {
-    spp_uint8_t i;
+    spp_uint32_t word;
 
-    for (i = 0U; i < K_SPP_PUBSUB_MAX_SUBSCRIBERS; i++)
+    if (p_cfg->p_apidSet != NULL)
     {
-        s_subs[i].apid    = 0U;
-        s_subs[i].prio    = 0U;
-        s_subs[i].handler = NULL;
-        s_subs[i].p_ctx   = NULL;
+        word = p_cfg->p_apidSet->words[page];
     }
-    for (i = 0U; i < K_SPP_PUBSUB_QUEUE_SIZE; i++)
+    else
     {
-        s_queue[i].p_pkt      = NULL;
-        s_queue[i].nextSubIdx = 0U;
+        spp_uint16_t first = p_cfg->apid;
+        spp_uint16_t last  = (p_cfg->apidLast > first) ? p_cfg->apidLast : first;
+        spp_uint16_t base  = (spp_uint16_t)(page * K_ROUTE_PAGE_SIZE);
+        spp_uint16_t top   = (spp_uint16_t)(base + K_ROUTE_PAGE_SIZE - 1U);
+        spp_uint16_t lo;
+        spp_uint16_t hi;
+
+        if ((first == K_SPP_APID_ALL) || (last < base) || (first > top))
+        {
+            return 0U;
+        }
+        lo   = (first > base) ? (spp_uint16_t)(first - base) : 0U;
+        hi   = (last < top) ? (spp_uint16_t)(last - base) : (spp_uint16_t)(K_ROUTE_PAGE_SIZE - 1U);
+        word = (0xFFFFFFFFUL >> (31U - hi)) & (0xFFFFFFFFUL << lo);
     }
-    for (i = 0U; i < 16U; i++)
+
+    if (page == 0U)
     {
-        s_overflowCount[i] = 0U;
+        word &= ~1UL; /* APID 0 is K_SPP_APID_NONE. */
     }
-
-    s_count       = 0U;
-    s_head        = 0U;
-    s_tail        = 0U;
-    s_qCount      = 0U;
-    s_initialized = true;
+    return word;
 }
 
-SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribe(spp_uint16_t apid, spp_uint8_t prio,
-                                            SPP_PubSub_Handler_t handler, void *p_ctx)
+/* Routing blocks a subscription would add. */
+static spp_uint8_t routeBlocksNeeded(const SPP_PubSub_SubCfg_t *p_cfg)
 {
-    spp_uint8_t ins;
-    spp_uint8_t i;
+    spp_uint8_t needed = 0U;
+    spp_uint8_t page;
 
-    if (!s_initialized)
+    for (page = 0U; page < K_ROUTE_PAGES; page++)
     {
-        SPP_ERR_RETURN(K_SPP_ERROR_NOT_INITIALIZED);
+        spp_uint32_t word = coverWord(p_cfg, page);
+        if ((word != 0U) && (word != 0xFFFFFFFFUL) && (s_pageBlock[page] == 0U))
+        {
+            needed++;
+        }
     }
-    if (handler == NULL)
+    return needed;
+}
+
+/* Enter the subscriber just inserted at ins into the routing table.  Every
+ * mask is widened first so existing bits keep their subscribers. */
+static void routeInsert(spp_uint8_t ins, const SPP_PubSub_SubCfg_t *p_cfg)
+{
+    SubMask_t   m = (SubMask_t)1U << ins;
+    spp_uint8_t page;
+    spp_uint8_t b;
+
+    s_routeAll = maskInsertAt(s_routeAll, ins);
+    for (page = 0U; page < K_ROUTE_PAGES; page++)
     {
-        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+        s_pageAll[page] = maskInsertAt(s_pageAll[page], ins);
     }
-    if (s_count >= K_SPP_PUBSUB_MAX_SUBSCRIBERS)
+    for (b = 0U; b < s_blocksUsed; b++)
     {
-        SPP_LOGE(k_tag, "Subscriber table full (%u)", (unsigned)K_SPP_PUBSUB_MAX_SUBSCRIBERS);
-        SPP_ERR_RETURN(K_SPP_ERROR);
+        spp_uint8_t j;
+        for (j = 0U; j < K_ROUTE_PAGE_SIZE; j++)
+        {
+            s_blocks[b][j] = maskInsertAt(s_blocks[b][j], ins);
+        }
     }
 
-    /* Find insertion point — keep array sorted by prio ascending. */
-    ins = 0U;
-    while ((ins < s_count) && (s_subs[ins].prio <= prio))
+    if ((p_cfg->p_apidSet == NULL) && (p_cfg->apid == K_SPP_APID_ALL))
     {
-        ins++;
+        s_routeAll |= m;
+        return;
     }
 
-    /* Shift existing entries right to make room. */
-    for (i = s_count; i > ins; i--)
+    for (page = 0U; page < K_ROUTE_PAGES; page++)
     {
-        s_subs[i] = s_subs[i - 1U];
-    }
+        spp_uint32_t word = coverWord(p_cfg, page);
+        SubMask_t   *p_block;
 
-    s_subs[ins].apid    = apid;
-    s_subs[ins].prio    = prio;
-    s_subs[ins].handler = handler;
-    s_subs[ins].p_ctx   = p_ctx;
-    s_count++;
-    return K_SPP_OK;
+        if (word == 0xFFFFFFFFUL)
+        {
+            s_pageAll[page] |= m;
+            continue;
+        }
+        if (word == 0U)
+        {
+            continue;
+        }
+
+        if (s_pageBlock[page] == 0U)
+        {
+            s_blocksUsed++;
+            s_pageBlock[page] = s_blocksUsed;
+        }
+        p_block = s_blocks[s_pageBlock[page] - 1U];
+        while (word != 0U)
+        {
+            p_block[lowestBit(word)] |= m;
+            word &= word - 1U;
+        }
+    }
 }
 
-SPP_RetVal_t SPP_SERVICES_PUBSUB_publish(SPP_Packet_t *p_packet)
+/* Subscribers matching pktApid — one page lookup, plus one block lookup for
+ * partly covered pages. */
+static SubMask_t routeLookup(spp_uint16_t pktApid)
 {
-    spp_uint8_t  i;
-    spp_bool_t   hasDeferred = false;
+    SubMask_t   mask = s_routeAll;
+    spp_uint8_t page;
 
-    if (p_packet == NULL)
+    if ((pktApid == K_SPP_APID_NONE) || (pktApid > K_SPP_APID_MAX))
     {
-        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+        return mask;
+    }
+    page  = (spp_uint8_t)(pktApid >> K_ROUTE_PAGE_BITS);
+    mask |= s_pageAll[page];
+    if (s_pageBlock[page] != 0U)
+    {
+        mask |= s_blocks[s_pageBlock[page] - 1U][pktApid & (K_ROUTE_PAGE_SIZE - 1U)];
     }
+    return mask;
+}
 
-    /* 1. Dispatch CRITICAL subscribers synchronously.  Since the array is
-     *    sorted by prio, all CRITICAL entries appear first; break on the
-     *    first non-CRITICAL entry. */
-    for (i = 0U; i < s_count; i++)
+/* Drop the subscribers whose decimation or rate limit rejects this packet.
+ * Advances their filter state, so call it once per packet, from one
+ * context. */
+static SubMask_t filterApply(SubMask_t mask)
+{
+    SubMask_t    check   = mask & s_filterSubs;
+    spp_uint32_t now     = 0U;
+    spp_bool_t   haveNow = false;
+
+    while (check != 0U)
     {
-        if (s_subs[i].prio != K_SPP_PUBSUB_PRIO_SYNC) break;
-        if (apidMatches(s_subs[i].apid, p_packet->primaryHeader.apid))
+        spp_uint8_t  i     = lowestBit(check);
+        SubEntry_t  *p_sub = &s_subs[i];
+        SubMask_t    m     = (SubMask_t)1U << i;
+
+        check &= check - 1U;
+
+        if (p_sub->skip != 0U)
+        {
+            p_sub->skip--;
+            mask &= ~m;
+            continue;
+        }
+        if (p_sub->decimation > 1U)
         {
-            s_subs[i].handler(p_packet, s_subs[i].p_ctx);
+            p_sub->skip = (spp_uint16_t)(p_sub->decimation - 1U);
+        }
+
+        if (p_sub->minPeriodMs != 0U)
+        {
+            if (!haveNow)
+            {
+                now     = SPP_HAL_getTimeMs();
+                haveNow = true;
+            }
+            if (p_sub->delivered && ((now - p_sub->lastMs) < p_sub->minPeriodMs))
+            {
+                mask &= ~m;
+                continue;
+            }
+            p_sub->lastMs    = now;
+            p_sub->delivered = true;
         }
     }
+    return mask;
+}
 
-    /* 2. Check whether any deferred (non-CRITICAL) subscriber matches. */
-    for (i = 0U; i < s_count; i++)
+/* Entry of apid in the per-APID tables, or K_APID_OTHER if it has none.
+ * With alloc set a free entry is claimed (consumer context only); it starts
+ * from the default policy and rank. */
+static spp_uint8_t apidSlot(spp_uint16_t apid, spp_bool_t alloc)
+{
+    spp_uint8_t i;
+    spp_uint8_t n;
+
+    if ((apid == K_SPP_APID_NONE) || (apid > K_SPP_APID_MAX))
     {
-        if (s_subs[i].prio == K_SPP_PUBSUB_PRIO_SYNC) continue;
-        if (apidMatches(s_subs[i].apid, p_packet->primaryHeader.apid))
+        return K_APID_OTHER;
+    }
+    i = (spp_uint8_t)(apid & (K_SPP_PUBSUB_MAX_APIDS - 1U));
+    for (n = 0U; n < K_SPP_PUBSUB_MAX_APIDS; n++)
+    {
+        spp_uint16_t key = s_apidKey[i];
+
+        if (key == apid)
         {
-            hasDeferred = true;
-            break;
+            return i;
         }
+        if (key == K_SPP_APID_NONE)
+        {
+            if (!alloc)
+            {
+                break;
+            }
+            s_policy[i]   = s_policy[K_APID_OTHER];
+            s_rank[i]     = s_rank[K_APID_OTHER];
+            s_maxAgeMs[i] = s_maxAgeMs[K_APID_OTHER];
+            s_apidKey[i]  = apid; /* Last, so producers see a ready entry. */
+            return i;
+        }
+        i = (spp_uint8_t)((i + 1U) & (K_SPP_PUBSUB_MAX_APIDS - 1U));
     }
+    return K_APID_OTHER;
+}
 
-    if (!hasDeferred)
+static void satIncrement(spp_uint16_t *p_count)
+{
+    if (*p_count < 0xFFFFU)
     {
-        (void)SPP_SERVICES_DATABANK_returnPacket(p_packet);
-        return K_SPP_OK;
+        (*p_count)++;
     }
+}
 
-    /* 3. Enqueue packet for deferred dispatch. */
-    if (s_qCount >= K_SPP_PUBSUB_QUEUE_SIZE)
+/* Wrap-safe "a is earlier than b" for SPP_HAL_getTimeUs() values. */
+static spp_bool_t timeBefore(spp_uint32_t a, spp_uint32_t b)
+{
+    return (spp_bool_t)((spp_int32_t)(a - b) < 0);
+}
+
+#if !SPP_NO_PUBSUB_STATS
+static void histAdd(SPP_PubSub_Hist_t *p_hist, spp_uint32_t us)
+{
+    spp_uint32_t v = us;
+    spp_uint8_t  b = 0U;
+
+    while ((v != 0U) && (b < (K_SPP_PUBSUB_HIST_BUCKETS - 1U)))
     {
-        /* Queue full — drop newest, record overflow. */
-        SPP_LOGW(k_tag, "Queue full — dropping apid=0x%04X", (unsigned)p_packet->primaryHeader.apid);
-        overflowIncrement(p_packet->primaryHeader.apid);
-        (void)SPP_SERVICES_DATABANK_returnPacket(p_packet);
-        return K_SPP_OK;
+        v >>= 1U;
+        b++;
+    }
+    p_hist->bucket[b]++;
+    p_hist->samples++;
+    p_hist->sumUs += us;
+    if (us > p_hist->maxUs)
+    {
+        p_hist->maxUs = us;
     }
+}
 
-    s_queue[s_tail].p_pkt      = p_packet;
-    s_queue[s_tail].nextSubIdx = 0U;
-    s_tail                     = (s_tail + 1U) & K_QUEUE_MASK;
-    s_qCount++;
-    return K_SPP_OK;
+static void histMerge(SPP_PubSub_Hist_t *p_dst, const SPP_PubSub_Hist_t *p_src)
+{
+    spp_uint8_t b;
+
+    for (b = 0U; b < K_SPP_PUBSUB_HIST_BUCKETS; b++)
+    {
+        p_dst->bucket[b] += p_src->bucket[b];
+    }
+    p_dst->samples += p_src->samples;
+    p_dst->sumUs   += p_src->sumUs;
+    if (p_src->maxUs > p_dst->maxUs)
+    {
+        p_dst->maxUs = p_src->maxUs;
+    }
 }
 
-void SPP_SERVICES_PUBSUB_callConsumers(void)
+static void apidHistAdd(SPP_PubSub_Hist_t *p_table, spp_uint16_t apid, spp_uint32_t us)
+{
+    histAdd(&p_table[apidSlot(apid, true)], us);
+}
+#endif
+
+static void overflowIncrement(spp_uint16_t apid)
+{
+    satIncrement(&s_overflowCount[apidSlot(apid, true)]);
+}
+
+static void policyIncrement(spp_uint16_t apid, spp_uint8_t policy)
+{
+    satIncrement(&s_policyCount[apidSlot(apid, true)][policy]);
+}
+
+static spp_uint8_t policyOf(spp_uint16_t apid)
+{
+    return s_policy[apidSlot(apid, false)];
+}
+
+static spp_uint8_t rankOf(spp_uint16_t apid)
+{
+    return s_rank[apidSlot(apid, false)];
+}
+
+static SPP_Packet_t *linkPacket(SPP_PacketLink_t *p_link)
+{
+    return SPP_STRUCTOF(p_link, SPP_Packet_t, link);
+}
+
+/* Count deliveries queued for, or taken from, the group members in mask. */
+static void queuedAdd(SubMask_t mask)
+{
+    mask &= s_groupedSubs;
+    while (mask != 0U)
+    {
+        s_subs[lowestBit(mask)].queued++;
+        mask &= mask - 1U;
+    }
+}
+
+static void queuedSub(SubMask_t mask)
+{
+    mask &= s_groupedSubs;
+    while (mask != 0U)
+    {
+        s_subs[lowestBit(mask)].queued--;
+        mask &= mask - 1U;
+    }
+}
+
+/* Link p_link into level lvl after p_prev (NULL = at the head). */
+static void levelInsert(spp_uint8_t lvl, SPP_PacketLink_t *p_prev, SPP_PacketLink_t *p_link)
+{
+    LevelQueue_t *p_q = &s_levels[lvl];
+
+    if (p_prev == NULL)
+    {
+        p_link->p_next[lvl] = p_q->p_head;
+        p_q->p_head         = p_link;
+    }
+    else
+    {
+        p_link->p_next[lvl] = p_prev->p_next[lvl];
+        p_prev->p_next[lvl] = p_link;
+    }
+    if (p_q->p_tail == p_prev)
+    {
+        p_q->p_tail = p_link;
+    }
+    p_link->levels |= (spp_uint8_t)(1U << lvl);
+    p_q->count++;
+}
+
+/* Unlink p_link (preceded by p_prev, NULL at the head) from level lvl and
+ * drop its pending subscribers there.  The caller owns the level's
+ * reference. */
+static void levelUnlink(spp_uint8_t lvl, SPP_PacketLink_t *p_prev, SPP_PacketLink_t *p_link)
 {
-    QueueEntry_t *p_entry;
-    spp_uint8_t   i;
-    spp_uint16_t  pktApid;
+    LevelQueue_t *p_q = &s_levels[lvl];
 
-    if (s_qCount == 0U) return;
+    if (p_prev == NULL)
+    {
+        p_q->p_head = p_link->p_next[lvl];
+    }
+    else
+    {
+        p_prev->p_next[lvl] = p_link->p_next[lvl];
+    }
+    if (p_q->p_tail == p_link)
+    {
+        p_q->p_tail = p_prev;
+    }
+    p_link->p_next[lvl] = NULL;
+    queuedSub(p_link->pending & s_levelSubs[lvl]);
+    p_link->pending    &= ~s_levelSubs[lvl];
+    p_link->levels     &= (spp_uint8_t)~(1U << lvl);
+    p_q->count--;
+}
 
-    p_entry = &s_queue[s_head];
-    pktApid = p_entry->p_pkt->primaryHeader.apid;
+/* Find a DROP_LOWEST victim: oldest packet of the lowest rank below
+ * @p rank, or NULL.  Its predecessor goes to *pp_prev. */
+static SPP_PacketLink_t *levelFindLowest(spp_uint8_t lvl, spp_uint8_t rank,
+                                         SPP_PacketLink_t **pp_prev)
+{
+    SPP_PacketLink_t *p_found = NULL;
+    SPP_PacketLink_t *p_prev  = NULL;
+    SPP_PacketLink_t *p_link;
+    spp_uint8_t       best    = rank;
 
-    /* Find the next non-CRITICAL subscriber (starting from nextSubIdx) that
-     * matches this packet's APID, call it, and save progress. */
-    for (i = p_entry->nextSubIdx; i < s_count; i++)
+    for (p_link = s_levels[lvl].p_head; p_link != NULL; p_link = p_link->p_next[lvl])
     {
-        if (s_subs[i].prio == K_SPP_PUBSUB_PRIO_SYNC) continue;
-        if (apidMatches(s_subs[i].apid, pktApid))
+        spp_uint8_t r = rankOf(linkPacket(p_link)->primaryHeader.apid);
+        if (r < best)
         {
-            s_subs[i].handler(p_entry->p_pkt, s_subs[i].p_ctx);
-            p_entry->nextSubIdx = i + 1U;
-            return;
+            best     = r;
+            p_found  = p_link;
+            *pp_prev = p_prev;
         }
+        p_prev = p_link;
     }
+    return p_found;
+}
+
+/* Find the newest packet of @p apid, or NULL.  Its predecessor goes to
+ * *pp_prev. */
+static SPP_PacketLink_t *levelFindNewest(spp_uint8_t lvl, spp_uint16_t apid,
+                                         SPP_PacketLink_t **pp_prev)
+{
+    SPP_PacketLink_t *p_found = NULL;
+    SPP_PacketLink_t *p_prev  = NULL;
+    SPP_PacketLink_t *p_link;
 
-    /* No more matching deferred subscribers — return packet to databank. */
-    (void)SPP_SERVICES_DATABANK_returnPacket(p_entry->p_pkt);
-    p_entry->p_pkt = NULL;
-    s_head         = (s_head + 1U) & K_QUEUE_MASK;
-    s_qCount--;
+    for (p_link = s_levels[lvl].p_head; p_link != NULL; p_link = p_link->p_next[lvl])
+    {
+        if (linkPacket(p_link)->primaryHeader.apid == apid)
+        {
+            p_found  = p_link;
+            *pp_prev = p_prev;
+        }
+        p_prev = p_link;
+    }
+    return p_found;
 }
 
-spp_uint16_t SPP_SERVICES_PUBSUB_overflowCount(spp_uint16_t apid)
+/* Apply the APID's overflow policy to a full level: returns the policy that
+ * resolves it and, for all but DROP_NEWEST, the victim and its predecessor. */
+static spp_uint8_t overflowResolve(spp_uint8_t lvl, spp_uint16_t apid,
+                                   SPP_PacketLink_t **pp_prev, SPP_PacketLink_t **pp_victim)
+{
+    spp_uint8_t policy = policyOf(apid);
+
+    *pp_prev = NULL;
+    switch (policy)
+    {
+        case K_SPP_PUBSUB_OVF_DROP_OLDEST:
+            *pp_victim = s_levels[lvl].p_head;
+            break;
+        case K_SPP_PUBSUB_OVF_DROP_LOWEST:
+            *pp_victim = levelFindLowest(lvl, rankOf(apid), pp_prev);
+            break;
+        case K_SPP_PUBSUB_OVF_COALESCE:
+            *pp_victim = levelFindNewest(lvl, apid, pp_prev);
+            break;
+        default:
+            *pp_victim = NULL;
+            break;
+    }
+    return (*pp_victim != NULL) ? policy : (spp_uint8_t)K_SPP_PUBSUB_OVF_DROP_NEWEST;
+}
+
+/* ----------------------------------------------------------------
+ * Deferred queues
+ * ---------------------------------------------------------------- */
+
+/* Pick one of the group members in members for the next packet of group
+ * g.  Candidates are tried round-robin from the member after the last one
+ * picked; LEAST_LOADED takes the first with the fewest queued deliveries. */
+static spp_uint8_t groupPick(spp_uint8_t g, SubMask_t members)
 {
-    spp_uint16_t count = 0U;
-    spp_uint8_t  bit;
+    /* Bits above s_groupLast[g] first, then the rest — wraps at 32. */
+    SubMask_t   after = members & ~(((SubMask_t)2U << s_groupLast[g]) - 1U);
+    SubMask_t   order[2];
+    spp_uint8_t best;
+    spp_uint8_t k;
 
-    for (bit = 0U; bit < 16U; bit++)
+    order[0] = after;
+    order[1] = members & ~after;
+    best     = lowestBit((after != 0U) ? after : members);
+
+    if (s_groupMode[g] == K_SPP_PUBSUB_GROUP_LEAST_LOADED)
     {
-        if ((apid & (spp_uint16_t)(1U << bit)) != 0U)
+        for (k = 0U; k < 2U; k++)
         {
-            count += s_overflowCount[bit];
+            while (order[k] != 0U)
+            {
+                spp_uint8_t i = lowestBit(order[k]);
+                order[k] &= order[k] - 1U;
+                if (s_subs[i].queued < s_subs[best].queued)
+                {
+                    best = i;
+                }
+            }
         }
     }
-    return count;
+    s_groupLast[g] = best;
+    return best;
 }
 
-spp_uint8_t SPP_SERVICES_PUBSUB_subscriberCount(void)
+/* Reduce each consumer group in a deferred mask to the one member that
+ * takes the packet.  Consumer context only. */
+static SubMask_t groupSelect(SubMask_t deferred)
 {
-    return s_count;
+    SubMask_t grouped = deferred & s_groupedSubs;
+
+    while (grouped != 0U)
+    {
+        spp_uint8_t g       = (spp_uint8_t)(s_subs[lowestBit(grouped)].group - 1U);
+        SubMask_t   members = grouped & s_groupSubs[g];
+
+        grouped  &= ~members;
+        deferred  = (deferred & ~members) | ((SubMask_t)1U << groupPick(g, members));
+    }
+    return deferred;
 }
 
-spp_uint8_t SPP_SERVICES_PUBSUB_queueDepth(void)
+/* Queue a packet that has deferred subscribers.  Consumer context only.
+ * pubUs is the publish timestamp (0 when neither stats nor deadlines need
+ * it). */
+static void enqueueDeferred(SPP_Packet_t *p_packet, SubMask_t deferred, spp_uint32_t pubUs)
 {
-    return s_qCount;
+    SPP_PacketLink_t *p_link     = &p_packet->link;
+    spp_uint16_t      apid       = p_packet->primaryHeader.apid;
+    spp_uint8_t       lvl;
+    spp_uint8_t       queued     = 0U;
+    spp_bool_t        overflowed = false;
+
+    p_link->pending = 0U;
+    p_link->levels  = 0U;
+    p_link->pubUs   = pubUs;
+
+    /* Queue at each priority level that has subscribers.  The first level
+     * takes over the producer's reference; each further level takes its
+     * own. */
+    for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+    {
+        LevelQueue_t     *p_q      = &s_levels[lvl];
+        SubMask_t         mask     = deferred & s_levelSubs[lvl];
+        spp_uint8_t       policy   = K_SPP_PUBSUB_OVF_DROP_NEWEST;
+        SPP_PacketLink_t *p_prev   = NULL;
+        SPP_PacketLink_t *p_victim = NULL;
+        spp_bool_t        full;
+
+        if (mask == 0U) continue;
+
+        full = (spp_bool_t)((p_q->limit != 0U) && (p_q->count >= p_q->limit));
+        if (full)
+        {
+            /* Level at its limit — the APID's policy decides what goes, at
+             * this level only. */
+            overflowed = true;
+            policy     = overflowResolve(lvl, apid, &p_prev, &p_victim);
+            policyIncrement(apid, policy);
+            if (policy == K_SPP_PUBSUB_OVF_DROP_NEWEST) continue;
+        }
+        if ((queued > 0U) && (SPP_SERVICES_DATABANK_retain(p_packet) != K_SPP_OK))
+        {
+            overflowed = true;
+            continue;
+        }
+
+        if (full)
+        {
+            levelUnlink(lvl, p_prev, p_victim);
+            (void)SPP_SERVICES_DATABANK_release(linkPacket(p_victim));
+            if (policy != K_SPP_PUBSUB_OVF_COALESCE)
+            {
+                p_prev = p_q->p_tail;
+            }
+        }
+        else
+        {
+            p_prev = p_q->p_tail;
+        }
+
+        /* Appended, or for COALESCE in the stale packet's place: latest
+         * value wins. */
+        levelInsert(lvl, p_prev, p_link);
+        p_link->pending |= mask;
+        queuedAdd(mask);
+        queued++;
+    }
+
+    if (overflowed)
+    {
+        SPP_LOGW(k_tag, "Queue full — apid=0x%04X policy=%u", (unsigned)apid,
+                 (unsigned)policyOf(apid));
+        overflowIncrement(apid);
+    }
+
+    if (queued == 0U)
+    {
+        (void)SPP_SERVICES_DATABANK_release(p_packet);
+    }
+    else
+    {
+        (void)SPP_SERVICES_DATABANK_markQueued(p_packet);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * Spill to storage
+ * ---------------------------------------------------------------- */
+
+#if !SPP_NO_STORAGE
+/* True when queueing a packet of len bytes for these subscribers would
+ * overflow a level or eat into the producers' reserve of free packets. */
+static spp_bool_t spillPressure(spp_uint16_t len, SubMask_t deferred)
+{
+    spp_uint8_t lvl;
+
+    if (SPP_SERVICES_DATABANK_freeCountSized(len) <= s_spillLowWater)
+    {
+        return true;
+    }
+    for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+    {
+        const LevelQueue_t *p_q = &s_levels[lvl];
+        if (((deferred & s_levelSubs[lvl]) != 0U) && (p_q->limit != 0U) &&
+            (p_q->count >= p_q->limit))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Where a record of size bytes fits in the ring: at the writer, or at the
+ * top of the file once the end is reached and the reader has moved past
+ * it.  False when the records still waiting leave no room. */
+static spp_bool_t spillFit(spp_uint32_t size, spp_uint32_t *p_off)
+{
+    *p_off = s_spillWr;
+    if (s_spillEnd != 0U)
+    {
+        return (spp_bool_t)((s_spillWr + size) <= s_spillRd);
+    }
+    if ((s_spillWr + size) <= K_SPP_PUBSUB_SPILL_MAX_BYTES)
+    {
+        return true;
+    }
+    *p_off = 0U;
+    return (spp_bool_t)(size <= s_spillRd);
+}
+
+static SPP_RetVal_t spillWrite(const SPP_Packet_t *p_packet, SubMask_t deferred,
+                               spp_uint32_t pubUs, spp_uint32_t off)
+{
+    SpillRecord_t rec;
+    spp_uint16_t  len = p_packet->primaryHeader.payloadLen;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.primary   = p_packet->primaryHeader;
+    rec.secondary = p_packet->secondaryHeader;
+    rec.crc       = p_packet->crc;
+    rec.pending   = deferred;
+    rec.pubUs     = pubUs;
+    if ((SPP_HAL_storageWrite(s_spillFile, off, &rec, sizeof(rec)) != K_SPP_OK) ||
+        ((len > 0U) && (SPP_HAL_storageWrite(s_spillFile, off + (spp_uint32_t)sizeof(rec),
+                                             p_packet->payload, len) != K_SPP_OK)))
+    {
+        return K_SPP_ERROR;
+    }
+    if (off != s_spillWr)
+    {
+        s_spillEnd = s_spillWr;
+    }
+    s_spillWr = off + (spp_uint32_t)sizeof(rec) + len;
+    s_spillCount++;
+    s_spillApid[apidSlot(rec.primary.apid, true)]++;
+    return K_SPP_OK;
+}
+
+/* Step the reader past the head record of size bytes; its header must
+ * have been read. */
+static void spillAdvance(spp_uint32_t size)
+{
+    s_spillApid[apidSlot(s_spillHead.primary.apid, true)]--;
+    s_spillRd       += size;
+    s_spillHeadValid = false;
+    s_spillCount--;
+    if (s_spillCount == 0U)
+    {
+        /* Empty again — start over at the top of the file. */
+        s_spillRd  = 0U;
+        s_spillWr  = 0U;
+        s_spillEnd = 0U;
+    }
+    else if ((s_spillEnd != 0U) && (s_spillRd == s_spillEnd))
+    {
+        s_spillRd  = 0U;
+        s_spillEnd = 0U;
+    }
+}
+
+static SPP_RetVal_t spillReadHead(void)
+{
+    if (!s_spillHeadValid)
+    {
+        if (SPP_HAL_storageRead(s_spillFile, s_spillRd, &s_spillHead,
+                                sizeof(s_spillHead)) != K_SPP_OK)
+        {
+            return K_SPP_ERROR;
+        }
+        s_spillHeadValid = true;
+    }
+    return K_SPP_OK;
+}
+
+/* The file can no longer be read back: count what it held as overflow. */
+static void spillDiscard(void)
+{
+    spp_uint8_t i;
+
+    SPP_LOGE(k_tag, "Spill read failed — %lu packets lost", (unsigned long)s_spillCount);
+    for (i = 0U; i <= K_APID_OTHER; i++)
+    {
+        for (; s_spillApid[i] != 0U; s_spillApid[i]--)
+        {
+            satIncrement(&s_overflowCount[i]);
+        }
+    }
+    s_spillCount     = 0U;
+    s_spillRd        = 0U;
+    s_spillWr        = 0U;
+    s_spillEnd       = 0U;
+    s_spillHeadValid = false;
+}
+
+static void spillClose(void)
+{
+    if (s_spillFile != NULL)
+    {
+        (void)SPP_HAL_storageClose(s_spillFile);
+    }
+    s_spillFile      = NULL;
+    s_spillRd        = 0U;
+    s_spillWr        = 0U;
+    s_spillEnd       = 0U;
+    s_spillCount     = 0U;
+    s_spillHeadValid = false;
+    s_spillBackHead  = NULL;
+    s_spillBackTail  = NULL;
+    memset(s_spillApid, 0, sizeof(s_spillApid));
+}
+
+/* Append a packet to the spill file and release it.  When the records
+ * still waiting leave no room, the APID's policy decides: DROP_OLDEST
+ * skips the oldest records until the packet fits, every other policy
+ * drops the packet (a victim inside the file cannot be found without
+ * reading it all back).  Each packet lost counts as an overflow of its
+ * own APID.  A packet the file cannot take is queued in RAM only when
+ * nothing waits in the file, so it never overtakes a spilled one.
+ * Consumer context only. */
+static void spillStore(SPP_Packet_t *p_packet, SubMask_t deferred, spp_uint32_t pubUs)
+{
+    spp_uint16_t apid = p_packet->primaryHeader.apid;
+    spp_uint32_t size = (spp_uint32_t)sizeof(SpillRecord_t) + p_packet->primaryHeader.payloadLen;
+    spp_uint32_t off;
+    spp_bool_t   fits = spillFit(size, &off);
+
+    if (!fits)
+    {
+        spp_uint8_t policy = ((policyOf(apid) == K_SPP_PUBSUB_OVF_DROP_OLDEST) &&
+                              (size <= K_SPP_PUBSUB_SPILL_MAX_BYTES))
+                                 ? (spp_uint8_t)K_SPP_PUBSUB_OVF_DROP_OLDEST
+                                 : (spp_uint8_t)K_SPP_PUBSUB_OVF_DROP_NEWEST;
+
+        SPP_LOGW(k_tag, "Spill file full — apid=0x%04X policy=%u", (unsigned)apid,
+                 (unsigned)policy);
+        policyIncrement(apid, policy);
+        if (policy == K_SPP_PUBSUB_OVF_DROP_NEWEST)
+        {
+            overflowIncrement(apid);
+        }
+        while ((policy == K_SPP_PUBSUB_OVF_DROP_OLDEST) && !fits)
+        {
+            if (spillReadHead() == K_SPP_OK)
+            {
+                overflowIncrement(s_spillHead.primary.apid);
+                spillAdvance((spp_uint32_t)sizeof(s_spillHead) + s_spillHead.primary.payloadLen);
+            }
+            else
+            {
+                spillDiscard();
+            }
+            fits = spillFit(size, &off);
+        }
+    }
+
+    if (fits && (spillWrite(p_packet, deferred, pubUs, off) != K_SPP_OK))
+    {
+        if (s_spillCount == 0U)
+        {
+            enqueueDeferred(p_packet, deferred, pubUs);
+            return;
+        }
+        SPP_LOGW(k_tag, "Spill write failed — apid=0x%04X", (unsigned)apid);
+        overflowIncrement(apid);
+    }
+    (void)SPP_SERVICES_DATABANK_release(p_packet);
+}
+
+/* Write the packets left for the spill file, oldest first.  Consumer
+ * context only. */
+static void spillFlush(void)
+{
+    while (s_spillBackHead != NULL)
+    {
+        SPP_PacketLink_t *p_link = s_spillBackHead;
+
+        s_spillBackHead   = p_link->p_next[0];
+        p_link->p_next[0] = NULL;
+        spillStore(linkPacket(p_link), p_link->pending, p_link->pubUs);
+    }
+    s_spillBackTail = NULL;
+}
+
+/* Queue spilled packets again, oldest first, while that causes no
+ * pressure — or whenever every level is empty, so the file always drains.
+ * Consumer context only. */
+static void spillRefill(void)
+{
+    while (s_spillCount != 0U)
+    {
+        SPP_Packet_t *p_packet;
+        SubMask_t     pending;
+        spp_uint32_t  pubUs;
+        spp_uint16_t  len;
+        spp_bool_t    idle = true;
+        spp_uint8_t   lvl;
+
+        if (spillReadHead() != K_SPP_OK)
+        {
+            spillDiscard();
+            return;
+        }
+
+        len = s_spillHead.primary.payloadLen;
+        for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+        {
+            idle = (spp_bool_t)(idle && (s_levels[lvl].p_head == NULL));
+        }
+        if (!idle && spillPressure(len, s_spillHead.pending))
+        {
+            return;
+        }
+        p_packet = SPP_SERVICES_DATABANK_getPacketFor(s_spillHead.primary.apid, len);
+        if (p_packet == NULL)
+        {
+            return;
+        }
+        if ((len > 0U) &&
+            (SPP_HAL_storageRead(s_spillFile, s_spillRd + (spp_uint32_t)sizeof(s_spillHead),
+                                 p_packet->payload, len) != K_SPP_OK))
+        {
+            (void)SPP_SERVICES_DATABANK_release(p_packet);
+            spillDiscard();
+            return;
+        }
+
+        p_packet->primaryHeader   = s_spillHead.primary;
+        p_packet->secondaryHeader = s_spillHead.secondary;
+        p_packet->crc             = s_spillHead.crc;
+        pending                   = s_spillHead.pending;
+        pubUs                     = s_spillHead.pubUs;
+
+        spillAdvance((spp_uint32_t)sizeof(s_spillHead) + len);
+        enqueueDeferred(p_packet, pending, pubUs);
+    }
+}
+#endif
+
+/* Queue a deferred packet, or leave it for the spill file when spilling is
+ * on and RAM is under pressure or earlier packets already wait there.  The
+ * storage write itself happens in spillFlush(). */
+static void enqueueOrSpill(SPP_Packet_t *p_packet, SubMask_t deferred, spp_uint32_t pubUs)
+{
+    if ((deferred & s_groupedSubs) != 0U)
+    {
+        deferred = groupSelect(deferred);
+    }
+#if !SPP_NO_STORAGE
+    if ((s_spillFile != NULL) &&
+        ((s_spillCount != 0U) || (s_spillBackHead != NULL) ||
+         spillPressure(p_packet->primaryHeader.payloadLen, deferred)))
+    {
+        SPP_PacketLink_t *p_link = &p_packet->link;
+
+        p_link->pending   = deferred;
+        p_link->pubUs     = pubUs;
+        p_link->p_next[0] = NULL;
+        if (s_spillBackTail == NULL)
+        {
+            s_spillBackHead = p_link;
+        }
+        else
+        {
+            s_spillBackTail->p_next[0] = p_link;
+        }
+        s_spillBackTail = p_link;
+        return;
+    }
+#endif
+    enqueueDeferred(p_packet, deferred, pubUs);
+}
+
+#if SPP_PUBSUB_MPSC
+/* Producer side: any context, any core.  Appends the chain p_first …
+ * p_last (already linked through p_intake) with one exchange.  Never
+ * fails — the intake holds whatever the pool can lease. */
+static void intakePush(SPP_PacketLink_t *p_first, SPP_PacketLink_t *p_last)
+{
+    SPP_PacketLink_t *p_prev;
+
+    atomic_store_explicit(&p_last->p_intake, NULL, memory_order_relaxed);
+    p_prev = atomic_exchange_explicit(&s_intakeHead, p_last, memory_order_acq_rel);
+    /* Until this store the consumer stops at p_prev and retries later. */
+    atomic_store_explicit(&p_prev->p_intake, p_first, memory_order_release);
+}
+
+/* Consumer side: next published packet, or NULL when the intake is empty
+ * or a producer is between its two steps in intakePush(). */
+static SPP_PacketLink_t *intakePop(void)
+{
+    SPP_PacketLink_t *p_tail = s_intakeTail;
+    SPP_PacketLink_t *p_next = atomic_load_explicit(&p_tail->p_intake, memory_order_acquire);
+
+    if (p_tail == &s_intakeStub)
+    {
+        if (p_next == NULL)
+        {
+            return NULL;
+        }
+        s_intakeTail = p_next;
+        p_tail       = p_next;
+        p_next       = atomic_load_explicit(&p_tail->p_intake, memory_order_acquire);
+    }
+    if (p_next != NULL)
+    {
+        s_intakeTail = p_next;
+        return p_tail;
+    }
+    if (p_tail != atomic_load_explicit(&s_intakeHead, memory_order_acquire))
+    {
+        return NULL;
+    }
+
+    /* p_tail is the last packet: park the stub behind it before taking it. */
+    intakePush(&s_intakeStub, &s_intakeStub);
+    p_next = atomic_load_explicit(&p_tail->p_intake, memory_order_acquire);
+    if (p_next == NULL)
+    {
+        return NULL;
+    }
+    s_intakeTail = p_next;
+    return p_tail;
+}
+#endif
+
+/* Move everything producers have published into the deferred queues or
+ * the spill file.  Called at the top of every consumer-side entry point. */
+static void intakeDrain(void)
+{
+#if SPP_PUBSUB_MPSC
+    SPP_PacketLink_t *p_link;
+
+    while ((p_link = intakePop()) != NULL)
+    {
+        SPP_Packet_t *p_pkt    = linkPacket(p_link);
+        SubMask_t     deferred = filterApply(p_link->pending);
+
+        if (deferred == 0U)
+        {
+            (void)SPP_SERVICES_DATABANK_release(p_pkt);
+        }
+        else
+        {
+            enqueueOrSpill(p_pkt, deferred, p_link->pubUs);
+        }
+    }
+#endif
+#if !SPP_NO_STORAGE
+    spillFlush();
+#endif
+}
+
+/* ----------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------- */
+
+void SPP_SERVICES_PUBSUB_init(void)
+{
+    spp_uint8_t i;
+
+    for (i = 0U; i < K_SPP_PUBSUB_MAX_SUBSCRIBERS; i++)
+    {
+        s_subs[i].prio         = 0U;
+        s_subs[i].handler      = NULL;
+        s_subs[i].batchHandler = NULL;
+        s_subs[i].p_ctx        = NULL;
+    }
+    s_count = 0U;
+    classRebuild();
+#if !SPP_NO_PUBSUB_STATS
+    SPP_SERVICES_PUBSUB_statsReset();
+#endif
+    for (i = 0U; i < K_PUBSUB_LEVELS; i++)
+    {
+        s_levels[i].p_head = NULL;
+        s_levels[i].p_tail = NULL;
+        s_levels[i].count  = 0U;
+        s_levels[i].limit  = K_SPP_PUBSUB_QUEUE_LIMIT;
+    }
+    for (i = 0U; i <= K_APID_OTHER; i++)
+    {
+        spp_uint8_t k;
+        for (k = 0U; k < K_SPP_PUBSUB_OVF_POLICIES; k++)
+        {
+            s_policyCount[i][k] = 0U;
+        }
+        s_overflowCount[i] = 0U;
+        s_policy[i]        = K_SPP_PUBSUB_OVF_DROP_NEWEST;
+        s_maxAgeMs[i]      = 0U;
+        s_expiredCount[i]  = 0U;
+        s_rank[i]          = 0U;
+        if (i < K_APID_OTHER)
+        {
+            s_apidKey[i] = K_SPP_APID_NONE;
+        }
+    }
+    for (i = 0U; i < K_ROUTE_PAGES; i++)
+    {
+        s_pageAll[i]   = 0U;
+        s_pageBlock[i] = 0U;
+    }
+    memset(s_blocks, 0, sizeof(s_blocks));
+    s_blocksUsed = 0U;
+    s_routeAll   = 0U;
+    s_apidTtl    = false;
+    for (i = 0U; i < K_SPP_PUBSUB_MAX_GROUPS; i++)
+    {
+        s_groupMode[i] = K_SPP_PUBSUB_GROUP_ROUND_ROBIN;
+        s_groupLast[i] = (spp_uint8_t)(K_SPP_PUBSUB_MAX_SUBSCRIBERS - 1U);
+    }
+
+#if SPP_PUBSUB_MPSC
+    atomic_store_explicit(&s_intakeStub.p_intake, NULL, memory_order_relaxed);
+    atomic_store_explicit(&s_intakeHead, &s_intakeStub, memory_order_release);
+    s_intakeTail = &s_intakeStub;
+#endif
+#if !SPP_NO_STORAGE
+    spillClose();
+#endif
+
+    s_initialized = true;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribe(spp_uint16_t apid, spp_uint8_t prio,
+                                            SPP_PubSub_Handler_t handler, void *p_ctx)
+{
+    SPP_PubSub_SubCfg_t cfg;
+
+    cfg.apid         = apid;
+    cfg.apidLast     = 0U;
+    cfg.p_apidSet    = NULL;
+    cfg.prio         = prio;
+    cfg.handler      = handler;
+    cfg.batchHandler = NULL;
+    cfg.batchMax     = 0U;
+    cfg.p_ctx        = p_ctx;
+    cfg.decimation   = 0U;
+    cfg.minPeriodMs  = 0U;
+    cfg.deadlineUs   = 0U;
+    cfg.maxAgeMs     = 0U;
+    cfg.group        = 0U;
+    return SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribeEx(const SPP_PubSub_SubCfg_t *p_cfg)
+{
+    spp_uint8_t ins;
+    spp_uint8_t i;
+    spp_uint8_t prio;
+
+    if (!s_initialized)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NOT_INITIALIZED);
+    }
+    intakeDrain();
+    if ((p_cfg == NULL) || ((p_cfg->handler == NULL) && (p_cfg->batchHandler == NULL)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+#if !SPP_NO_STORAGE
+    if (s_spillCount != 0U)
+    {
+        /* Spilled packets carry masks of the current subscriber table. */
+        SPP_LOGE(k_tag, "Subscribe while %lu packets are spilled", (unsigned long)s_spillCount);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+#endif
+    prio = p_cfg->prio;
+    if (prio > K_SPP_PUBSUB_PRIO_LOW)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    if ((p_cfg->batchHandler != NULL) &&
+        ((p_cfg->handler != NULL) || (p_cfg->batchMax > K_SPP_PUBSUB_BATCH_MAX)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    if ((prio == K_SPP_PUBSUB_PRIO_SYNC) &&
+        ((p_cfg->deadlineUs != 0U) || (p_cfg->maxAgeMs != 0U) || (p_cfg->group != 0U)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    if (p_cfg->group > K_SPP_PUBSUB_MAX_GROUPS)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+#if SPP_PUBSUB_MPSC
+    if ((prio == K_SPP_PUBSUB_PRIO_SYNC) &&
+        ((p_cfg->decimation > 1U) || (p_cfg->minPeriodMs != 0U)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+#endif
+    if ((p_cfg->p_apidSet == NULL) &&
+        (((p_cfg->apid > K_SPP_APID_MAX) && (p_cfg->apid != K_SPP_APID_ALL)) ||
+         (p_cfg->apidLast > K_SPP_APID_MAX)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    if (s_count >= K_SPP_PUBSUB_MAX_SUBSCRIBERS)
+    {
+        SPP_LOGE(k_tag, "Subscriber table full (%u)", (unsigned)K_SPP_PUBSUB_MAX_SUBSCRIBERS);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+    if (routeBlocksNeeded(p_cfg) > (K_SPP_PUBSUB_ROUTE_BLOCKS - s_blocksUsed))
+    {
+        SPP_LOGE(k_tag, "Route blocks exhausted (%u)", (unsigned)K_SPP_PUBSUB_ROUTE_BLOCKS);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+
+    /* Find insertion point — keep array sorted by prio ascending. */
+    ins = 0U;
+    while ((ins < s_count) && (s_subs[ins].prio <= prio))
+    {
+        ins++;
+    }
+
+    /* Shift existing entries right to make room. */
+    for (i = s_count; i > ins; i--)
+    {
+        s_subs[i] = s_subs[i - 1U];
+    }
+
+    s_subs[ins].prio         = prio;
+    s_subs[ins].handler      = p_cfg->handler;
+    s_subs[ins].batchHandler = p_cfg->batchHandler;
+    s_subs[ins].batchMax     = 1U;
+    s_subs[ins].p_ctx        = p_cfg->p_ctx;
+    s_subs[ins].decimation   = p_cfg->decimation;
+    s_subs[ins].skip         = 0U;
+    s_subs[ins].minPeriodMs  = p_cfg->minPeriodMs;
+    s_subs[ins].lastMs       = 0U;
+    s_subs[ins].delivered    = false;
+    s_subs[ins].deadlineUs   = p_cfg->deadlineUs;
+    s_subs[ins].misses       = 0U;
+    s_subs[ins].maxAgeMs     = p_cfg->maxAgeMs;
+    s_subs[ins].group        = p_cfg->group;
+    s_subs[ins].queued       = 0U;
+    if (p_cfg->batchHandler != NULL)
+    {
+        s_subs[ins].batchMax = (p_cfg->batchMax != 0U) ? p_cfg->batchMax
+                                                       : (spp_uint16_t)K_SPP_PUBSUB_BATCH_MAX;
+    }
+#if !SPP_NO_PUBSUB_STATS
+    memset(&s_subs[ins].stats, 0, sizeof(s_subs[ins].stats));
+#endif
+    s_count++;
+
+    /* Packets already queued keep their original subscriber set.  A packet
+     * queued at several levels is remapped once, from its first level. */
+    for (i = 0U; i < K_PUBSUB_LEVELS; i++)
+    {
+        SPP_PacketLink_t *p_link;
+        for (p_link = s_levels[i].p_head; p_link != NULL; p_link = p_link->p_next[i])
+        {
+            if (lowestBit(p_link->levels) == i)
+            {
+                p_link->pending = maskInsertAt(p_link->pending, ins);
+            }
+        }
+    }
+
+    /* Group cursors follow their member to its new index. */
+    for (i = 0U; i < K_SPP_PUBSUB_MAX_GROUPS; i++)
+    {
+        if ((s_groupLast[i] >= ins) && (s_groupLast[i] < (K_SPP_PUBSUB_MAX_SUBSCRIBERS - 1U)))
+        {
+            s_groupLast[i]++;
+        }
+    }
+
+    routeInsert(ins, p_cfg);
+    classRebuild();
+    return K_SPP_OK;
+}
+
+void SPP_SERVICES_PUBSUB_apidSetAdd(SPP_ApidSet_t *p_set, spp_uint16_t first, spp_uint16_t last)
+{
+    spp_uint16_t apid;
+
+    if (p_set == NULL)
+    {
+        return;
+    }
+    if (last > K_SPP_APID_MAX)
+    {
+        last = K_SPP_APID_MAX;
+    }
+    for (apid = first; apid <= last; apid++)
+    {
+        p_set->words[apid >> 5U] |= (spp_uint32_t)1U << (apid & 31U);
+    }
+}
+
+/* Hand n packets to subscriber i — all at once to a batch handler, else
+ * one by one. */
+static void subInvoke(spp_uint8_t i, const SPP_Packet_t *const *pp_packets, spp_uint16_t n)
+{
+    spp_uint16_t k;
+
+    if (s_subs[i].batchHandler != NULL)
+    {
+        s_subs[i].batchHandler(pp_packets, n, s_subs[i].p_ctx);
+        return;
+    }
+    for (k = 0U; k < n; k++)
+    {
+        s_subs[i].handler(pp_packets[k], s_subs[i].p_ctx);
+    }
+}
+
+/* Call subscriber i with n packets.  With stats, records its run time; for
+ * a deadline subscriber, counts a miss if it finished after dueUs.  Returns
+ * the time it finished, or 0 when neither needed it. */
+static spp_uint32_t callSub(spp_uint8_t i, const SPP_Packet_t *const *pp_packets, spp_uint16_t n,
+                            spp_uint32_t dueUs)
+{
+    SPP_PubSub_Handler_t      handler = s_subs[i].handler;
+    SPP_PubSub_BatchHandler_t batch   = s_subs[i].batchHandler;
+    void                     *p_ctx   = s_subs[i].p_ctx;
+    spp_bool_t                timed   = (spp_bool_t)(s_subs[i].deadlineUs != 0U);
+    spp_uint32_t              end     = 0U;
+#if !SPP_NO_PUBSUB_STATS
+    spp_uint32_t              start   = SPP_HAL_getTimeUs();
+
+    timed = true;
+#endif
+
+    subInvoke(i, pp_packets, n);
+    if (timed)
+    {
+        end = SPP_HAL_getTimeUs();
+    }
+
+    /* A handler that subscribes shifts the table; drop the sample then. */
+    if ((s_subs[i].handler == handler) && (s_subs[i].batchHandler == batch) &&
+        (s_subs[i].p_ctx == p_ctx))
+    {
+#if !SPP_NO_PUBSUB_STATS
+        histAdd(&s_subs[i].stats.runUs, end - start);
+#endif
+        if ((s_subs[i].deadlineUs != 0U) && timeBefore(dueUs, end))
+        {
+            satIncrement(&s_subs[i].misses);
+        }
+    }
+    return end;
+}
+
+/* Call SYNC subscriber i from publish().  Under MPSC this is the
+ * producer's context and the stats are consumer-side only. */
+static void callSync(spp_uint8_t i, const SPP_Packet_t *const *pp_packets, spp_uint16_t n)
+{
+#if SPP_PUBSUB_MPSC
+    subInvoke(i, pp_packets, n);
+#else
+    (void)callSub(i, pp_packets, n, 0U);
+#endif
+}
+
+/* Publish timestamp for a packet with these deferred subscribers, or 0
+ * when neither stats nor deadlines need it. */
+static spp_uint32_t publishTime(SubMask_t deferred)
+{
+#if !SPP_NO_PUBSUB_STATS
+    (void)deferred;
+    return SPP_HAL_getTimeUs();
+#else
+    /* Deadlines run from publish. */
+    return ((deferred & s_edfSubs) != 0U) ? SPP_HAL_getTimeUs() : 0U;
+#endif
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_publish(SPP_Packet_t *p_packet)
+{
+    SubMask_t    match;
+    SubMask_t    sync;
+    SubMask_t    deferred;
+    spp_uint32_t pubUs = 0U;
+
+    if (p_packet == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    match = routeLookup(p_packet->primaryHeader.apid);
+#if !SPP_PUBSUB_MPSC
+    /* Filtered subscribers that skip this packet never see a queue slot.
+     * Under MPSC the deferred filters run in intakeDrain() instead. */
+    match = filterApply(match);
+#endif
+    sync     = match & s_syncSubs;
+    deferred = match & ~s_syncSubs;
+
+    /* 1. Dispatch SYNC subscribers synchronously, in table order. */
+    while (sync != 0U)
+    {
+        spp_uint8_t i = lowestBit(sync);
+        sync &= sync - 1U;
+        callSync(i, (const SPP_Packet_t *const *)&p_packet, 1U);
+    }
+
+    /* 2. No deferred subscriber matches — the packet is done. */
+    if (deferred == 0U)
+    {
+        (void)SPP_SERVICES_DATABANK_release(p_packet);
+        return K_SPP_OK;
+    }
+
+    /* 3. Queue for deferred dispatch — directly, or through the intake
+     *    when producers may run outside the superloop. */
+    pubUs = publishTime(deferred);
+#if SPP_PUBSUB_MPSC
+    p_packet->link.pending = deferred;
+    p_packet->link.pubUs   = pubUs;
+    intakePush(&p_packet->link, &p_packet->link);
+#else
+    enqueueOrSpill(p_packet, deferred, pubUs);
+#endif
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_publishMany(SPP_Packet_t *const *pp_packets, spp_uint16_t count)
+{
+    spp_uint32_t base;
+    spp_uint16_t k;
+
+    if (pp_packets == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    for (k = 0U; k < count; k++)
+    {
+        if (pp_packets[k] == NULL)
+        {
+            SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+        }
+    }
+
+    for (base = 0U; base < count; base += K_SPP_PUBSUB_BATCH_MAX)
+    {
+        SPP_Packet_t *const *pp_chunk = &pp_packets[base];
+        spp_uint32_t         left     = (spp_uint32_t)count - base;
+        spp_uint16_t         n        = (left < K_SPP_PUBSUB_BATCH_MAX)
+                                            ? (spp_uint16_t)left
+                                            : (spp_uint16_t)K_SPP_PUBSUB_BATCH_MAX;
+        SubMask_t            match[K_SPP_PUBSUB_BATCH_MAX];
+        const SPP_Packet_t  *p_batch[K_SPP_PUBSUB_BATCH_MAX];
+        SubMask_t            route   = 0U;
+        SubMask_t            sync    = 0U;
+        SubMask_t            anyDef  = 0U;
+        spp_uint16_t         apid    = K_SPP_APID_NONE;
+        spp_uint32_t         pubUs;
+        SPP_PacketLink_t    *p_first = NULL;
+        SPP_PacketLink_t    *p_last  = NULL;
+
+        /* 1. Match — one route lookup per run of packets with the same APID;
+         *    the filters still see every packet. */
+        for (k = 0U; k < n; k++)
+        {
+            spp_uint16_t pktApid = pp_chunk[k]->primaryHeader.apid;
+
+            if ((k == 0U) || (pktApid != apid))
+            {
+                apid  = pktApid;
+                route = routeLookup(apid);
+            }
+#if SPP_PUBSUB_MPSC
+            match[k] = route;
+#else
+            match[k] = filterApply(route);
+#endif
+            sync   |= match[k] & s_syncSubs;
+            anyDef |= match[k] & ~s_syncSubs;
+        }
+
+        /* 2. SYNC subscribers in table order, each with its packets in
+         *    publish order — a batch handler up to batchMax per call. */
+        while (sync != 0U)
+        {
+            spp_uint8_t  i  = lowestBit(sync);
+            SubMask_t    m  = (SubMask_t)1U << i;
+            spp_uint16_t nb = 0U;
+
+            sync &= sync - 1U;
+            for (k = 0U; k < n; k++)
+            {
+                if ((match[k] & m) == 0U)
+                {
+                    continue;
+                }
+                p_batch[nb] = pp_chunk[k];
+                nb++;
+                if (nb == s_subs[i].batchMax)
+                {
+                    callSync(i, p_batch, nb);
+                    nb = 0U;
+                }
+            }
+            if (nb != 0U)
+            {
+                callSync(i, p_batch, nb);
+            }
+        }
+
+        /* 3. Queue the deferred part, with one timestamp for the chunk.
+         *    Under MPSC the packets are chained first and handed to the
+         *    intake in one push. */
+        pubUs = publishTime(anyDef);
+        for (k = 0U; k < n; k++)
+        {
+            SPP_Packet_t *p_packet = pp_chunk[k];
+            SubMask_t     deferred = match[k] & ~s_syncSubs;
+
+            if (deferred == 0U)
+            {
+                (void)SPP_SERVICES_DATABANK_release(p_packet);
+                continue;
+            }
+#if SPP_PUBSUB_MPSC
+            p_packet->link.pending = deferred;
+            p_packet->link.pubUs   = pubUs;
+            if (p_last != NULL)
+            {
+                atomic_store_explicit(&p_last->p_intake, &p_packet->link,
+                                      memory_order_relaxed);
+            }
+            else
+            {
+                p_first = &p_packet->link;
+            }
+            p_last = &p_packet->link;
+#else
+            enqueueOrSpill(p_packet, deferred, pubUs);
+#endif
+        }
+#if SPP_PUBSUB_MPSC
+        if (p_first != NULL)
+        {
+            intakePush(p_first, p_last);
+        }
+#else
+        (void)p_first;
+        (void)p_last;
+#endif
+    }
+    return K_SPP_OK;
+}
+
+/* Find the pending deadline delivery due first.  Packets sit in publish
+ * order, so a subscriber's oldest pending packet holds its earliest
+ * deadline and each level is scanned only until every deadline subscriber
+ * on it has been seen.  Ties go to the higher level, then the older
+ * packet, then table order. */
+static spp_bool_t edfPick(spp_uint8_t *p_lvl, SPP_PacketLink_t **pp_prev,
+                          SPP_PacketLink_t **pp_link, spp_uint8_t *p_sub)
+{
+    spp_bool_t   found = false;
+    spp_uint32_t best  = 0U;
+    spp_uint8_t  lvl;
+
+    for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+    {
+        SubMask_t         want   = s_edfSubs & s_levelSubs[lvl];
+        SPP_PacketLink_t *p_prev = NULL;
+        SPP_PacketLink_t *p_link;
+
+        for (p_link = s_levels[lvl].p_head; (p_link != NULL) && (want != 0U);
+             p_link = p_link->p_next[lvl])
+        {
+            SubMask_t hit = p_link->pending & want;
+
+            want &= ~hit;
+            while (hit != 0U)
+            {
+                spp_uint8_t  i   = lowestBit(hit);
+                spp_uint32_t due = p_link->pubUs + s_subs[i].deadlineUs;
+
+                hit &= hit - 1U;
+                if (!found || timeBefore(due, best))
+                {
+                    found    = true;
+                    best     = due;
+                    *p_lvl   = lvl;
+                    *pp_prev = p_prev;
+                    *pp_link = p_link;
+                    *p_sub   = i;
+                }
+            }
+            p_prev = p_link;
+        }
+    }
+    return found;
+}
+
+/* Drop a level's reference to a packet it is done with; the packet returns
+ * to the databank once every level (and any retaining subscriber) is. */
+static void levelRelease(SPP_Packet_t *p_packet, spp_uint32_t nowUs)
+{
+#if !SPP_NO_PUBSUB_STATS
+    /* Sampled before the release, when the last level lets go: a handler's
+     * retain does not hide the packet, and the slot is never read after it
+     * may have gone back to the pool. */
+    if (p_packet->link.levels == 0U)
+    {
+        apidHistAdd(s_apidLife, p_packet->primaryHeader.apid, nowUs - p_packet->link.pubUs);
+    }
+#else
+    (void)nowUs;
+#endif
+    (void)SPP_SERVICES_DATABANK_release(p_packet);
+}
+
+/* True when the packet is older than subscriber i or its APID allows —
+ * the tighter of the two limits applies. */
+static spp_bool_t packetExpired(spp_uint8_t i, const SPP_Packet_t *p_packet, spp_uint32_t nowMs)
+{
+    spp_uint32_t maxAge  = s_subs[i].maxAgeMs;
+    spp_uint32_t apidAge = s_maxAgeMs[apidSlot(p_packet->primaryHeader.apid, false)];
+
+    if ((apidAge != 0U) && ((maxAge == 0U) || (apidAge < maxAge)))
+    {
+        maxAge = apidAge;
+    }
+    return (spp_bool_t)((maxAge != 0U) &&
+                        ((nowMs - p_packet->secondaryHeader.timestampMs) > maxAge));
+}
+
+/* Call the next pending subscriber: the deadline delivery due first if
+ * there is one, otherwise the oldest packet of the highest non-empty level.
+ * A batch subscriber also gets the packets behind it on that level that
+ * still wait for it, up to its batchMax.  Packets past their TTL are
+ * dropped for the subscriber without a call; if that leaves it nothing,
+ * the next pending subscriber is tried.  Returns false when every level
+ * is empty. */
+static spp_bool_t dispatchNext(void)
+{
+    SPP_PacketLink_t *p_prev;
+    SPP_PacketLink_t *p_link;
+    SPP_Packet_t     *p_batch[K_SPP_PUBSUB_BATCH_MAX];
+    spp_bool_t        done[K_SPP_PUBSUB_BATCH_MAX];
+    spp_uint16_t      n;
+    spp_uint16_t      k;
+    spp_uint32_t      pubUs;
+    spp_uint8_t       lvl;
+    spp_uint8_t       i;
+    SubMask_t         m;
+    spp_uint32_t      end;
+    spp_uint32_t      now   = 0U;
+    spp_uint32_t      nowMs = 0U;
+    spp_bool_t        ttl;
+
+    intakeDrain();
+#if !SPP_NO_STORAGE
+    spillRefill();
+#endif
+    do
+    {
+        p_prev = NULL;
+        p_link = NULL;
+        n      = 0U;
+        lvl    = 0U;
+        i      = 0U;
+        if ((s_edfSubs == 0U) || !edfPick(&lvl, &p_prev, &p_link, &i))
+        {
+            for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+            {
+                if (s_levels[lvl].p_head != NULL) break;
+            }
+            if (lvl == K_PUBSUB_LEVELS) return false;
+            p_link = s_levels[lvl].p_head;
+            i      = lowestBit(p_link->pending & s_levelSubs[lvl]);
+        }
+
+        /* The first packet is the subscriber's oldest; its deadline counts. */
+        m     = (SubMask_t)1U << i;
+        pubUs = p_link->pubUs;
+        ttl   = (spp_bool_t)(s_apidTtl || ((s_ttlSubs & m) != 0U));
+        if (ttl)
+        {
+            nowMs = SPP_HAL_getTimeMs();
+        }
+#if !SPP_NO_PUBSUB_STATS
+        now = SPP_HAL_getTimeUs();
+#endif
+
+        /* Pop the subscriber from each packet — and unlink the packet from
+         * this level, if it was the last one — before calling it, so a
+         * handler that publishes or subscribes sees a consistent queue. */
+        while ((p_link != NULL) && (n < s_subs[i].batchMax))
+        {
+            SPP_PacketLink_t *p_next = p_link->p_next[lvl];
+            SPP_Packet_t     *p_pkt  = linkPacket(p_link);
+            spp_bool_t        last;
+
+            if ((p_link->pending & m) == 0U)
+            {
+                p_prev = p_link;
+                p_link = p_next;
+                continue;
+            }
+
+            p_link->pending &= ~m;
+            queuedSub(m);
+            last = (spp_bool_t)((p_link->pending & s_levelSubs[lvl]) == 0U);
+            if (last)
+            {
+                levelUnlink(lvl, p_prev, p_link);
+            }
+            else
+            {
+                p_prev = p_link;
+            }
+            p_link = p_next;
+
+            if (ttl && packetExpired(i, p_pkt, nowMs))
+            {
+                satIncrement(&s_expiredCount[apidSlot(p_pkt->primaryHeader.apid, true)]);
+                if (last)
+                {
+                    levelRelease(p_pkt, now);
+                }
+                continue;
+            }
+
+            p_batch[n] = p_pkt;
+            done[n]    = last;
+#if !SPP_NO_PUBSUB_STATS
+            histAdd(&s_subs[i].stats.waitUs, now - p_pkt->link.pubUs);
+            apidHistAdd(s_apidWait, p_pkt->primaryHeader.apid, now - p_pkt->link.pubUs);
+#endif
+            n++;
+        }
+    } while (n == 0U);
+
+    end = callSub(i, (const SPP_Packet_t *const *)p_batch, n, pubUs + s_subs[i].deadlineUs);
+
+    for (k = 0U; k < n; k++)
+    {
+        if (done[k])
+        {
+            levelRelease(p_batch[k], end);
+        }
+    }
+    return true;
+}
+
+void SPP_SERVICES_PUBSUB_callConsumers(void)
+{
+    (void)dispatchNext();
+}
+
+spp_uint32_t SPP_SERVICES_PUBSUB_callConsumersBudget(spp_uint32_t maxDispatches,
+                                                     spp_uint32_t maxMicros)
+{
+    spp_uint32_t dispatched = 0U;
+    spp_uint32_t start      = (maxMicros != 0U) ? SPP_HAL_getTimeUs() : 0U;
+
+    while ((maxDispatches == 0U) || (dispatched < maxDispatches))
+    {
+        if (!dispatchNext()) break;
+        dispatched++;
+
+        /* Checked after the call so every invocation makes progress even
+         * when a single handler overruns the budget. */
+        if ((maxMicros != 0U) && ((SPP_HAL_getTimeUs() - start) >= maxMicros)) break;
+    }
+    return dispatched;
+}
+
+/* Entries an overflow query covers: one APID, or all of them for ALL. */
+static void apidRange(spp_uint16_t apid, spp_uint8_t *p_first, spp_uint8_t *p_last)
+{
+    if (apid == K_SPP_APID_ALL)
+    {
+        *p_first = 0U;
+        *p_last  = K_APID_OTHER;
+    }
+    else
+    {
+        spp_uint8_t slot = apidSlot(apid, false);
+        /* An APID without an entry has no counts of its own. */
+        *p_first = (slot == K_APID_OTHER) ? 1U : slot;
+        *p_last  = (slot == K_APID_OTHER) ? 0U : slot;
+    }
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_overflowCount(spp_uint16_t apid)
+{
+    spp_uint32_t count = 0U;
+    spp_uint8_t  first;
+    spp_uint8_t  last;
+    spp_uint8_t  i;
+
+    intakeDrain();
+    apidRange(apid, &first, &last);
+    for (i = first; i <= last; i++)
+    {
+        count += s_overflowCount[i];
+    }
+    return (count < 0xFFFFU) ? (spp_uint16_t)count : 0xFFFFU;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setOverflowPolicy(spp_uint16_t apid, spp_uint8_t policy,
+                                                   spp_uint8_t rank)
+{
+    spp_uint8_t i;
+
+    if ((apid == K_SPP_APID_NONE) || ((apid > K_SPP_APID_MAX) && (apid != K_SPP_APID_ALL)) ||
+        (policy >= K_SPP_PUBSUB_OVF_POLICIES))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    if (apid == K_SPP_APID_ALL)
+    {
+        for (i = 0U; i <= K_APID_OTHER; i++)
+        {
+            s_policy[i] = policy;
+            s_rank[i]   = rank;
+        }
+        return K_SPP_OK;
+    }
+
+    i = apidSlot(apid, true);
+    if (i == K_APID_OTHER)
+    {
+        SPP_LOGE(k_tag, "APID table full (%u)", (unsigned)K_SPP_PUBSUB_MAX_APIDS);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+    s_policy[i] = policy;
+    s_rank[i]   = rank;
+    return K_SPP_OK;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_overflowCountBy(spp_uint16_t apid, spp_uint8_t policy)
+{
+    spp_uint32_t count = 0U;
+    spp_uint8_t  first;
+    spp_uint8_t  last;
+    spp_uint8_t  i;
+
+    if (policy >= K_SPP_PUBSUB_OVF_POLICIES)
+    {
+        return 0U;
+    }
+    intakeDrain();
+    apidRange(apid, &first, &last);
+    for (i = first; i <= last; i++)
+    {
+        count += s_policyCount[i][policy];
+    }
+    return (count < 0xFFFFU) ? (spp_uint16_t)count : 0xFFFFU;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setMaxAge(spp_uint16_t apid, spp_uint32_t maxAgeMs)
+{
+    spp_uint8_t i;
+
+    if ((apid == K_SPP_APID_NONE) || ((apid > K_SPP_APID_MAX) && (apid != K_SPP_APID_ALL)))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    if (apid == K_SPP_APID_ALL)
+    {
+        for (i = 0U; i <= K_APID_OTHER; i++)
+        {
+            s_maxAgeMs[i] = maxAgeMs;
+        }
+    }
+    else
+    {
+        i = apidSlot(apid, true);
+        if (i == K_APID_OTHER)
+        {
+            SPP_LOGE(k_tag, "APID table full (%u)", (unsigned)K_SPP_PUBSUB_MAX_APIDS);
+            SPP_ERR_RETURN(K_SPP_ERROR);
+        }
+        s_maxAgeMs[i] = maxAgeMs;
+    }
+
+    /* Once set, dispatch reads the clock for every packet; clearing the
+     * limits again does not turn that off until init(). */
+    if (maxAgeMs != 0U)
+    {
+        s_apidTtl = true;
+    }
+    return K_SPP_OK;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_expiredCount(spp_uint16_t apid)
+{
+    spp_uint32_t count = 0U;
+    spp_uint8_t  first;
+    spp_uint8_t  last;
+    spp_uint8_t  i;
+
+    apidRange(apid, &first, &last);
+    for (i = first; i <= last; i++)
+    {
+        count += s_expiredCount[i];
+    }
+    return (count < 0xFFFFU) ? (spp_uint16_t)count : 0xFFFFU;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setGroupMode(spp_uint8_t group, spp_uint8_t mode)
+{
+    if ((group == 0U) || (group > K_SPP_PUBSUB_MAX_GROUPS) || (mode >= K_SPP_PUBSUB_GROUP_MODES))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    s_groupMode[group - 1U] = mode;
+    return K_SPP_OK;
+}
+
+spp_uint8_t SPP_SERVICES_PUBSUB_subscriberCount(void)
+{
+    return s_count;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_queueDepth(void)
+{
+    spp_uint16_t depth = 0U;
+    spp_uint8_t lvl;
+
+    intakeDrain();
+    for (lvl = 0U; lvl < K_PUBSUB_LEVELS; lvl++)
+    {
+        depth += s_levels[lvl].count;
+    }
+    return depth;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_queueDepthAt(spp_uint8_t prio)
+{
+    if ((prio == K_SPP_PUBSUB_PRIO_SYNC) || (prio > K_SPP_PUBSUB_PRIO_LOW))
+    {
+        return 0U;
+    }
+    intakeDrain();
+    return s_levels[prio - 1U].count;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setQueueLimit(spp_uint8_t prio, spp_uint16_t limit)
+{
+    if ((prio == K_SPP_PUBSUB_PRIO_SYNC) || (prio > K_SPP_PUBSUB_PRIO_LOW))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    s_levels[prio - 1U].limit = limit;
+    return K_SPP_OK;
+}
+
+#if !SPP_NO_STORAGE
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setSpill(const char *p_path, spp_uint16_t lowWater)
+{
+    intakeDrain();
+    if (s_spillCount != 0U)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+    spillClose();
+    if (p_path == NULL)
+    {
+        return K_SPP_OK;
+    }
+
+    s_spillFile = SPP_HAL_storageOpen(p_path);
+    if (s_spillFile == NULL)
+    {
+        SPP_LOGE(k_tag, "Cannot create spill file %s", p_path);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+    s_spillLowWater = lowWater;
+    return K_SPP_OK;
+}
+
+spp_uint32_t SPP_SERVICES_PUBSUB_spillCount(void)
+{
+    intakeDrain();
+    return s_spillCount;
+}
+#endif
+
+/* Index of the subscriber registered with this callback (exactly one of
+ * handler and batch set) and context, or s_count. */
+static spp_uint8_t subFind(SPP_PubSub_Handler_t handler, SPP_PubSub_BatchHandler_t batch,
+                           const void *p_ctx)
+{
+    spp_uint8_t i;
+
+    for (i = 0U; i < s_count; i++)
+    {
+        if ((s_subs[i].handler == handler) && (s_subs[i].batchHandler == batch) &&
+            (s_subs[i].p_ctx == p_ctx))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_deadlineMisses(SPP_PubSub_Handler_t handler, const void *p_ctx)
+{
+    spp_uint32_t misses = 0U;
+    spp_uint8_t  i;
+
+    if (handler != NULL)
+    {
+        i = subFind(handler, NULL, p_ctx);
+        return (i < s_count) ? s_subs[i].misses : 0U;
+    }
+    for (i = 0U; i < s_count; i++)
+    {
+        misses += s_subs[i].misses;
+    }
+    return (misses < 0xFFFFU) ? (spp_uint16_t)misses : 0xFFFFU;
+}
+
+spp_uint16_t SPP_SERVICES_PUBSUB_batchDeadlineMisses(SPP_PubSub_BatchHandler_t batchHandler,
+                                                     const void *p_ctx)
+{
+    spp_uint8_t i;
+
+    if (batchHandler == NULL)
+    {
+        return 0U;
+    }
+    i = subFind(NULL, batchHandler, p_ctx);
+    return (i < s_count) ? s_subs[i].misses : 0U;
+}
+
+#if !SPP_NO_PUBSUB_STATS
+SPP_RetVal_t SPP_SERVICES_PUBSUB_subscriberStats(SPP_PubSub_Handler_t handler,
+                                                 const void *p_ctx,
+                                                 SPP_PubSub_SubStats_t *p_out)
+{
+    spp_uint8_t i;
+
+    if ((handler == NULL) || (p_out == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    i = subFind(handler, NULL, p_ctx);
+    if (i == s_count)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    *p_out = s_subs[i].stats;
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_batchSubscriberStats(SPP_PubSub_BatchHandler_t batchHandler,
+                                                      const void *p_ctx,
+                                                      SPP_PubSub_SubStats_t *p_out)
+{
+    spp_uint8_t i;
+
+    if ((batchHandler == NULL) || (p_out == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    i = subFind(NULL, batchHandler, p_ctx);
+    if (i == s_count)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+    *p_out = s_subs[i].stats;
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_PUBSUB_apidStats(spp_uint16_t apid, SPP_PubSub_ApidStats_t *p_out)
+{
+    spp_uint8_t first;
+    spp_uint8_t last;
+    spp_uint8_t i;
+
+    if (p_out == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    intakeDrain();
+    memset(p_out, 0, sizeof(*p_out));
+    apidRange(apid, &first, &last);
+    for (i = first; i <= last; i++)
+    {
+        histMerge(&p_out->waitUs, &s_apidWait[i]);
+        histMerge(&p_out->lifetimeUs, &s_apidLife[i]);
+    }
+    return K_SPP_OK;
+}
+
+spp_uint32_t SPP_SERVICES_PUBSUB_histPercentile(const SPP_PubSub_Hist_t *p_hist, spp_uint8_t pct)
+{
+    spp_uint32_t target;
+    spp_uint32_t seen = 0U;
+    spp_uint8_t  b;
+
+    if ((p_hist == NULL) || (p_hist->samples == 0U))
+    {
+        return 0U;
+    }
+    if (pct > 100U)
+    {
+        pct = 100U;
+    }
+    /* Rank of the sample at pct, rounded up, at least the first. */
+    target = (spp_uint32_t)((((spp_uint64_t)p_hist->samples * pct) + 99U) / 100U);
+    if (target == 0U)
+    {
+        target = 1U;
+    }
+    for (b = 0U; b < (K_SPP_PUBSUB_HIST_BUCKETS - 1U); b++)
+    {
+        seen += p_hist->bucket[b];
+        if (seen >= target)
+        {
+            spp_uint32_t upper = (b == 0U) ? 0U : (((spp_uint32_t)1U << b) - 1U);
+            return (upper < p_hist->maxUs) ? upper : p_hist->maxUs;
+        }
+    }
+    return p_hist->maxUs;
+}
+
+void SPP_SERVICES_PUBSUB_statsReset(void)
+{
+    spp_uint8_t i;
+
+    for (i = 0U; i < K_SPP_PUBSUB_MAX_SUBSCRIBERS; i++)
+    {
+        memset(&s_subs[i].stats, 0, sizeof(s_subs[i].stats));
+    }
+    memset(s_apidWait, 0, sizeof(s_apidWait));
+    memset(s_apidLife, 0, sizeof(s_apidLife));
 }
+#endif
@@ -6,11 +6,15 @@
  *   1. A producer calls publish(packet).
  *   2. SYNC subscribers (prio = K_SPP_PUBSUB_PRIO_SYNC) run immediately inside
  *      publish() before it returns — use this only for very fast operations.
- *   3. All other subscribers are queued and dispatched one-per-call by
- *      SPP_SERVICES_PUBSUB_callConsumers() from the superloop.
+ *   3. All other subscribers are queued, one queue per priority level
+ *      threaded through the packets themselves (no ring to size), and
+ *      dispatched one-per-call by SPP_SERVICES_PUBSUB_callConsumers() from
+ *      the superloop — always from the highest non-empty level, so a slow
+ *      LOW subscriber never delays HIGH work published after it.
  *
- * A subscriber receives a packet when (subscriber.apid & packet.apid) != 0,
- * or when subscriber.apid == K_SPP_APID_ALL (receives everything).
+ * APIDs are 11-bit numbers (1 … K_SPP_APID_MAX).  A subscriber names one
+ * APID, a range, a set (@ref SPP_ApidSet_t) or K_SPP_APID_ALL; routing is a
+ * constant-time table lookup however many APIDs and subscribers exist.
  */
 
 #ifndef SPP_PUBSUB_H
@@ -43,6 +47,42 @@ extern "C" {
  *  like SD card writes that must not delay sensor reads. */
 #define K_SPP_PUBSUB_PRIO_LOW    (3U)
 
+/* ----------------------------------------------------------------
+ * Overflow policies (applied per APID when a deferred level is at its
+ * limit, see SPP_SERVICES_PUBSUB_setQueueLimit())
+ * ---------------------------------------------------------------- */
+
+/** @brief Discard the packet being published (default). */
+#define K_SPP_PUBSUB_OVF_DROP_NEWEST (0U)
+
+/** @brief Discard the oldest queued entry to make room. */
+#define K_SPP_PUBSUB_OVF_DROP_OLDEST (1U)
+
+/** @brief Discard the oldest queued entry whose APID has a lower rank than
+ *  the packet being published; drop the new packet if there is none. */
+#define K_SPP_PUBSUB_OVF_DROP_LOWEST (2U)
+
+/** @brief Replace the newest queued packet of the same APID in place, so
+ *  subscribers see the latest value; drop the new packet if there is none. */
+#define K_SPP_PUBSUB_OVF_COALESCE    (3U)
+
+/** @brief Number of overflow policies. */
+#define K_SPP_PUBSUB_OVF_POLICIES    (4U)
+
+/* ----------------------------------------------------------------
+ * Consumer group modes
+ * ---------------------------------------------------------------- */
+
+/** @brief Hand each packet to the next member of the group in turn. */
+#define K_SPP_PUBSUB_GROUP_ROUND_ROBIN  (0U)
+
+/** @brief Hand each packet to the member with the fewest deliveries still
+ *  queued; ties go round-robin. */
+#define K_SPP_PUBSUB_GROUP_LEAST_LOADED (1U)
+
+/** @brief Number of consumer group modes. */
+#define K_SPP_PUBSUB_GROUP_MODES        (2U)
+
 /* ----------------------------------------------------------------
  * Constants
  * ---------------------------------------------------------------- */
@@ -50,6 +90,9 @@ extern "C" {
 /** @brief Wildcard APID — subscriber receives packets for every APID. */
 #define K_SPP_APID_ALL  (0xFFFFU)
 
+/** @brief 32-bit words in an @ref SPP_ApidSet_t. */
+#define K_SPP_APIDSET_WORDS (K_SPP_APID_COUNT / 32U)
+
 /* ----------------------------------------------------------------
  * Types
  * ---------------------------------------------------------------- */
@@ -60,13 +103,109 @@ extern "C" {
  * For CRITICAL subscribers, called synchronously inside
  * @ref SPP_SERVICES_PUBSUB_publish().  For all other priorities, called from
  * @ref SPP_SERVICES_PUBSUB_callConsumers().  The packet pointer is valid only for the
- * duration of the call — do not store it.
+ * duration of the call unless the handler takes a reference with
+ * @ref SPP_SERVICES_DATABANK_retain(); it must then drop it later with
+ * @ref SPP_SERVICES_DATABANK_release().  Retained packets are shared and
+ * must not be modified.
  *
  * @param[in] p_packet  Published packet (read-only).
  * @param[in] p_ctx     Caller-supplied context pointer.
  */
 typedef void (*SPP_PubSub_Handler_t)(const SPP_Packet_t *p_packet, void *p_ctx);
 
+/**
+ * @brief Batch subscriber callback signature.
+ *
+ * Receives up to the subscriber's @c batchMax matching packets, oldest
+ * first, in one call.  A SYNC subscriber gets the packets of one
+ * @ref SPP_SERVICES_PUBSUB_publishMany() chunk that matched it (just the
+ * one from @ref SPP_SERVICES_PUBSUB_publish()); a deferred subscriber gets
+ * the packets waiting for it on its level.  The array and the packets
+ * follow the same lifetime rules as for @ref SPP_PubSub_Handler_t.
+ *
+ * @param[in] pp_packets  Matching packets (read-only), @p count ≥ 1.
+ * @param[in] count       Number of packets.
+ * @param[in] p_ctx       Caller-supplied context pointer.
+ */
+typedef void (*SPP_PubSub_BatchHandler_t)(const SPP_Packet_t *const *pp_packets,
+                                          spp_uint16_t count, void *p_ctx);
+
+/**
+ * @brief Bitset over the whole 11-bit APID space (bit n = APID n).
+ *
+ * Fill with @ref SPP_SERVICES_PUBSUB_apidSetAdd() after zero-initialising.
+ */
+typedef struct
+{
+    spp_uint32_t words[K_SPP_APIDSET_WORDS];
+} SPP_ApidSet_t;
+
+/**
+ * @brief Full subscription description for @ref SPP_SERVICES_PUBSUB_subscribeEx().
+ *
+ * The two filters let a slow consumer (downlink, display) take a fraction
+ * of a fast stream.  They are evaluated before the packet is queued, so
+ * filtered packets cost neither a queue slot nor a dispatch call.  When
+ * both are set, decimation is applied first and the rate limit to the
+ * packets it lets through.  Zero-initialise unused fields.
+ *
+ * The APIDs received are, in order of precedence: every APID in
+ * @c p_apidSet when it is non-NULL; the range @c apid … @c apidLast when
+ * @c apidLast is above @c apid; otherwise the single @c apid (or
+ * K_SPP_APID_ALL / K_SPP_APID_NONE).
+ *
+ * Set either @c handler or @c batchHandler.  A deferred batch handler
+ * takes one dispatch for up to @c batchMax packets, so a slow consumer
+ * (SD card) pays its per-call cost once per batch; the batch also holds
+ * back other work on its level for that long.
+ */
+typedef struct
+{
+    spp_uint16_t              apid;         /**< APID, or first APID of a range.            */
+    spp_uint16_t              apidLast;     /**< Last APID of a range (0 = single APID).    */
+    const SPP_ApidSet_t      *p_apidSet;    /**< APID set, read during the call only.       */
+    spp_uint8_t               prio;         /**< K_SPP_PUBSUB_PRIO_SYNC … _LOW.             */
+    SPP_PubSub_Handler_t      handler;      /**< Callback, or NULL with @c batchHandler.    */
+    SPP_PubSub_BatchHandler_t batchHandler; /**< Batch callback, or NULL.                   */
+    spp_uint16_t              batchMax;     /**< Packets per batch call (0 = BATCH_MAX).    */
+    void                     *p_ctx;        /**< Forwarded unchanged to the callback.       */
+    spp_uint16_t              decimation;   /**< Deliver 1 of every N matches (0/1 = all).  */
+    spp_uint32_t              minPeriodMs;  /**< At most one delivery per period (0 = off). */
+    spp_uint32_t              deadlineUs;   /**< Relative deadline from publish (0 = none). */
+    spp_uint32_t              maxAgeMs;     /**< Skip packets older than this (0 = none).   */
+    spp_uint8_t               group;        /**< Consumer group, 1 … MAX_GROUPS (0 = none). */
+} SPP_PubSub_SubCfg_t;
+
+#if !SPP_NO_PUBSUB_STATS
+/**
+ * @brief Fixed-size log2 histogram of durations in microseconds.
+ *
+ * Bucket 0 counts 0 µs samples, bucket b counts [2^(b-1), 2^b) µs and the
+ * last bucket everything longer.
+ */
+typedef struct
+{
+    spp_uint32_t bucket[K_SPP_PUBSUB_HIST_BUCKETS]; /**< Samples per bucket.     */
+    spp_uint32_t samples;                           /**< Total samples.          */
+    spp_uint32_t maxUs;                             /**< Longest sample (µs).    */
+    spp_uint64_t sumUs;                             /**< Sum, for the mean (µs). */
+} SPP_PubSub_Hist_t;
+
+/** @brief Timing of one subscriber's deferred deliveries. */
+typedef struct
+{
+    SPP_PubSub_Hist_t waitUs; /**< publish() → handler start, per packet. */
+    SPP_PubSub_Hist_t runUs;  /**< Handler execution time, per call.     */
+} SPP_PubSub_SubStats_t;
+
+/** @brief Timing of one APID's deferred packets. */
+typedef struct
+{
+    SPP_PubSub_Hist_t waitUs;     /**< publish() → handler start, every subscriber.     */
+    SPP_PubSub_Hist_t lifetimeUs; /**< publish() → last deferred delivery done.         */
+} SPP_PubSub_ApidStats_t;
+#endif
+
 /* ----------------------------------------------------------------
  * API
  * ---------------------------------------------------------------- */
@@ -80,34 +219,109 @@ typedef void (*SPP_PubSub_Handler_t)(const SPP_Packet_t *p_packet, void *p_ctx);
 void SPP_SERVICES_PUBSUB_init(void);
 
 /**
- * @brief Register a subscriber for a given APID bitmask.
+ * @brief Register a subscriber for one APID.
  *
  * Subscribers are stored sorted by @p prio (ascending), so CRITICAL
  * subscribers are always dispatched first.
  *
- * @param[in] apid     Bitmask of APIDs to subscribe to.  A packet matches
- *                     when (apid & packet.apid) != 0.  Use @ref K_SPP_APID_ALL
- *                     to receive every packet, or @ref K_SPP_APID_NONE for none.
+ * @param[in] apid     APID to subscribe to.  Use @ref K_SPP_APID_ALL to
+ *                     receive every packet, or @ref K_SPP_APID_NONE for none;
+ *                     see @ref SPP_SERVICES_PUBSUB_subscribeEx() for ranges
+ *                     and sets.
  * @param[in] prio     Dispatch priority (@ref K_SPP_PUBSUB_PRIO_SYNC …
  *                     @ref K_SPP_PUBSUB_PRIO_LOW).
  * @param[in] handler  Callback invoked on each matching publish.
  * @param[in] p_ctx    Context pointer forwarded unchanged to the callback.
  *
- * @return K_SPP_OK on success, or an error code otherwise.
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p handler is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p prio is above
+ *         @ref K_SPP_PUBSUB_PRIO_LOW, or @p apid is above K_SPP_APID_MAX
+ *         and not K_SPP_APID_ALL.
+ * @return K_SPP_ERROR if the subscriber table is full.
  */
 SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribe(spp_uint16_t apid, spp_uint8_t prio,
                                             SPP_PubSub_Handler_t handler, void *p_ctx);
 
+/**
+ * @brief Register a subscriber for an APID range or set, with optional
+ *        decimation, rate limiting, deadline, max age and group.
+ *
+ * Same as @ref SPP_SERVICES_PUBSUB_subscribe(), plus the APID selection
+ * and filters in @p p_cfg.  A subscription that covers only part of a
+ * 32-APID page takes one of @ref K_SPP_PUBSUB_ROUTE_BLOCKS routing blocks
+ * for that page (shared with later subscriptions to the same page).
+ * With @c decimation = N the subscriber receives the first matching
+ * packet and then every Nth one.  With @c minPeriodMs = T it receives a
+ * packet only if at least T ms have passed since the last one it was
+ * given.  The configuration is copied.
+ *
+ * A deferred subscriber with @c deadlineUs = D must finish each delivery
+ * within D µs of its publish().  @ref SPP_SERVICES_PUBSUB_callConsumers()
+ * serves such deliveries earliest deadline first, ahead of every delivery
+ * without a deadline; @c prio still selects the queue they wait in, and
+ * so its capacity and overflow policy.  Late finishes are counted by
+ * @ref SPP_SERVICES_PUBSUB_deadlineMisses().
+ *
+ * A deferred subscriber with @c maxAgeMs = A is not called for a packet
+ * whose @c secondaryHeader.timestampMs is more than A ms old when it is
+ * dispatched; see @ref SPP_SERVICES_PUBSUB_setMaxAge().
+ *
+ * Deferred subscribers with the same non-zero @c group share its packets:
+ * each packet the group matches goes to exactly one member that matches
+ * it, chosen by the group's mode (@ref SPP_SERVICES_PUBSUB_setGroupMode()).
+ * The choice is made when the packet is queued, after the members' own
+ * filters.
+ *
+ * With SPP_PUBSUB_MPSC=1 the filters of deferred subscribers run on the
+ * consumer side when the intake is drained; filtered SYNC subscribers are
+ * rejected there because their state would be shared between producers.
+ *
+ * @param[in] p_cfg  Subscription description.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_cfg is NULL or has no callback.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if the priority is above
+ *         @ref K_SPP_PUBSUB_PRIO_LOW, an APID is out of range, a SYNC
+ *         subscriber has a deadline, a max age or a group, or @c group is
+ *         above @ref K_SPP_PUBSUB_MAX_GROUPS, or it has filters under
+ *         SPP_PUBSUB_MPSC, or both callbacks are set, or @c batchMax
+ *         is above @ref K_SPP_PUBSUB_BATCH_MAX.
+ * @return K_SPP_ERROR if the subscriber table or the routing blocks are
+ *         exhausted, or packets wait in the spill file.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribeEx(const SPP_PubSub_SubCfg_t *p_cfg);
+
+/**
+ * @brief Add the APIDs @p first … @p last to a set.
+ *
+ * Values above K_SPP_APID_MAX are clipped.
+ *
+ * @param[in,out] p_set  Set to extend.
+ * @param[in]     first  First APID.
+ * @param[in]     last   Last APID (equal to @p first for one APID).
+ */
+void SPP_SERVICES_PUBSUB_apidSetAdd(SPP_ApidSet_t *p_set, spp_uint16_t first, spp_uint16_t last);
+
 /**
  * @brief Publish a filled packet to all matching subscribers.
  *
  * CRITICAL subscribers are called synchronously before this function returns.
  * All other matching subscribers are enqueued; call @ref SPP_SERVICES_PUBSUB_callConsumers()
- * repeatedly to drain them.  The packet is returned to the databank only when
- * all deferred subscribers have been dispatched.
+ * repeatedly to drain them.  The producer's reference passes to pub/sub,
+ * which releases it once all deferred subscribers have been dispatched; the
+ * packet returns to the databank when no subscriber still retains it.
+ *
+ * The packet is queued once per priority level with a matching subscriber,
+ * through its own @c link, so it must not be published again while still
+ * queued.  When a level is at its limit, the APID's overflow policy
+ * (@ref SPP_SERVICES_PUBSUB_setOverflowPolicy()) decides what is discarded
+ * at that level, and the per-APID overflow counters are incremented.
  *
- * On queue overflow the packet is discarded immediately and the per-APID
- * overflow counter is incremented.
+ * With SPP_PUBSUB_MPSC=1 this function may be called from any thread,
+ * core or ISR.  The deferred part then goes through a lock-free intake list
+ * threaded through the packet and is queued by the consumer on its next
+ * call.
  *
  * @param[in] p_packet  Filled packet from @ref SPP_SERVICES_DATABANK_getPacket().
  *
@@ -115,30 +329,173 @@ SPP_RetVal_t SPP_SERVICES_PUBSUB_subscribe(spp_uint16_t apid, spp_uint8_t prio,
  */
 SPP_RetVal_t SPP_SERVICES_PUBSUB_publish(SPP_Packet_t *p_packet);
 
+/**
+ * @brief Publish several filled packets at once.
+ *
+ * Same result as publishing each packet in turn, for producers that read
+ * a burst at a time (a sensor FIFO).  The batch is processed in chunks of
+ * @ref K_SPP_PUBSUB_BATCH_MAX: subscribers are matched once per run of
+ * packets with the same APID, then each SYNC subscriber is called with
+ * its packets in order — a batch handler once per chunk — and the
+ * deferred part is queued with one timestamp (under SPP_PUBSUB_MPSC, with
+ * one intake push).  SYNC subscribers therefore see the chunk subscriber
+ * by subscriber rather than packet by packet.
+ *
+ * The producer's reference to every packet passes to pub/sub, as for
+ * @ref SPP_SERVICES_PUBSUB_publish().  Nothing is published if any entry
+ * is NULL.
+ *
+ * @param[in] pp_packets  Packets to publish, in publish order.
+ * @param[in] count       Number of packets (0 is a no-op).
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p pp_packets or an entry is NULL.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_publishMany(SPP_Packet_t *const *pp_packets, spp_uint16_t count);
+
 /**
  * @brief Dispatch the next pending deferred subscriber.
  *
- * Processes exactly one subscriber from the deferred queue per call.
- * Call this once per superloop iteration — it returns immediately when
- * the queue is empty.
+ * Processes exactly one subscriber per call: the queued delivery with the
+ * earliest absolute deadline if any deadline subscriber has one pending,
+ * otherwise the oldest entry of the highest-priority non-empty queue
+ * (HIGH, then NORMAL, then LOW).  A batch subscriber is handed that
+ * packet plus the later ones on the same level still waiting for it, up
+ * to its @c batchMax, in the same call.  Call this once per superloop
+ * iteration — it returns immediately when every queue is empty.
  *
  * One-per-call is intentional: slow consumers (SD card writes) are spread
- * across loop iterations so they never block sensor reads.
+ * across loop iterations so they never block sensor reads.  Use
+ * @ref SPP_SERVICES_PUBSUB_callConsumersBudget() to drain bursts faster.
  */
 void SPP_SERVICES_PUBSUB_callConsumers(void);
 
 /**
- * @brief Return the accumulated overflow count for a given APID bitmask.
+ * @brief Dispatch deferred subscribers until a count or time budget is spent.
+ *
+ * Keeps calling subscribers, highest priority level first, while packets
+ * are pending: at most @p maxDispatches handler calls and until
+ * @p maxMicros µs have passed since entry (measured with
+ * @ref SPP_HAL_getTimeUs()).
+ *
+ * The time budget is checked after each handler, so one slow handler may
+ * overrun it; the bound is "budget + one handler".  A value of 0 disables
+ * that limit — passing 0 for both drains the queue completely.
+ *
+ * @param[in] maxDispatches  Maximum handler calls (0 = no limit).
+ * @param[in] maxMicros      Time budget in µs (0 = no limit).
+ *
+ * @return Number of subscriber handlers called.
+ */
+spp_uint32_t SPP_SERVICES_PUBSUB_callConsumersBudget(spp_uint32_t maxDispatches,
+                                                     spp_uint32_t maxMicros);
+
+/**
+ * @brief Choose what happens when a packet of @p apid meets a level at its
+ *        limit.
+ *
+ * @p rank orders APIDs for @ref K_SPP_PUBSUB_OVF_DROP_LOWEST: a higher
+ * rank is more important, and only entries of strictly lower rank are
+ * evicted.  All APIDs start at @ref K_SPP_PUBSUB_OVF_DROP_NEWEST with
+ * rank 0; @ref SPP_SERVICES_PUBSUB_init() restores that.
+ *
+ * Per-APID settings and counters live in a table of
+ * @ref K_SPP_PUBSUB_MAX_APIDS entries; K_SPP_APID_ALL changes every entry
+ * and the default for APIDs that have none.
+ *
+ * @param[in] apid    APID, or @ref K_SPP_APID_ALL.
+ * @param[in] policy  One of K_SPP_PUBSUB_OVF_*.
+ * @param[in] rank    Importance of @p apid for DROP_LOWEST victims.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p apid is K_SPP_APID_NONE or
+ *         out of range, or @p policy is unknown.
+ * @return K_SPP_ERROR if the per-APID table is full.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setOverflowPolicy(spp_uint16_t apid, spp_uint8_t policy,
+                                                   spp_uint8_t rank);
+
+/**
+ * @brief Return the accumulated overflow count for an APID.
  *
- * Counts how many packets matching @p apid were dropped because the deferred
- * queue was full at the time of publish.
+ * Counts how many packets of @p apid were dropped, at one or more
+ * priority levels, because that level was at its limit at publish time.
+ * Drops of APIDs that found no free per-APID entry only appear in the
+ * K_SPP_APID_ALL total.
  *
- * @param[in] apid  APID bitmask (same format as in subscribe).
+ * @param[in] apid  APID, or @ref K_SPP_APID_ALL for the total.
  *
- * @return Cumulative number of dropped packets for the matching APIDs.
+ * @return Cumulative number of dropped packets (saturates at 0xFFFF).
  */
 spp_uint16_t SPP_SERVICES_PUBSUB_overflowCount(spp_uint16_t apid);
 
+/**
+ * @brief Return how many overflows of @p apid a given policy resolved.
+ *
+ * Counted against the APID of the packet being published.  When
+ * DROP_LOWEST or COALESCE finds no candidate, the new packet is dropped and
+ * the event counts as DROP_NEWEST.
+ *
+ * @param[in] apid    APID, or @ref K_SPP_APID_ALL for the total.
+ * @param[in] policy  One of K_SPP_PUBSUB_OVF_*.
+ *
+ * @return Cumulative count, 0 for an unknown policy.
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_overflowCountBy(spp_uint16_t apid, spp_uint8_t policy);
+
+/**
+ * @brief Set the time-to-live of queued packets of an APID.
+ *
+ * A deferred subscriber is not called for a packet whose
+ * @c secondaryHeader.timestampMs is more than @p maxAgeMs old when it is
+ * dispatched: the delivery is dropped, the packet released once no other
+ * subscriber still wants it, and the drop counted by
+ * @ref SPP_SERVICES_PUBSUB_expiredCount().  A subscriber's own
+ * @c maxAgeMs applies too; the tighter of the two limits wins.  SYNC
+ * subscribers are never skipped, and packets held in the spill file keep
+ * their timestamp, so they can expire on the way back.
+ *
+ * @param[in] apid      APID, or @ref K_SPP_APID_ALL for every entry and
+ *                      the default.
+ * @param[in] maxAgeMs  Maximum age in ms (0 = no limit).
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p apid is K_SPP_APID_NONE or
+ *         out of range.
+ * @return K_SPP_ERROR if the per-APID table is full.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setMaxAge(spp_uint16_t apid, spp_uint32_t maxAgeMs);
+
+/**
+ * @brief Return how many deliveries of an APID were dropped as expired.
+ *
+ * Counts one per subscriber skipped, so a packet that expired for two
+ * subscribers counts twice.
+ *
+ * @param[in] apid  APID, or @ref K_SPP_APID_ALL for the total.
+ *
+ * @return Cumulative count (saturates at 0xFFFF).
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_expiredCount(spp_uint16_t apid);
+
+/**
+ * @brief Choose how a consumer group spreads its packets.
+ *
+ * Groups start round-robin.  LEAST_LOADED picks the member with the
+ * fewest deliveries waiting in the deferred queues, so a member whose
+ * handler is slow, or sits at a busier priority, gets fewer packets.
+ * Packets a handler hands on (to a worker thread, say) no longer count as
+ * its load once the handler returns.
+ *
+ * @param[in] group  Group id, 1 … @ref K_SPP_PUBSUB_MAX_GROUPS.
+ * @param[in] mode   One of K_SPP_PUBSUB_GROUP_*.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p group or @p mode is out of
+ *         range.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setGroupMode(spp_uint8_t group, spp_uint8_t mode);
+
 /**
  * @brief Return the number of currently registered subscribers.
  *
@@ -147,14 +504,202 @@ spp_uint16_t SPP_SERVICES_PUBSUB_overflowCount(spp_uint16_t apid);
 spp_uint8_t SPP_SERVICES_PUBSUB_subscriberCount(void);
 
 /**
- * @brief Return the number of packets currently sitting in the deferred queue.
+ * @brief Return the number of entries currently sitting in the deferred queues.
+ *
+ * Sum over all priority levels; a packet with subscribers at two levels
+ * counts twice.  Useful for debug: if this grows without bound,
+ * callConsumers() is not keeping up with publish() — either increase call
+ * rate or reduce publish rate.
+ *
+ * @return Deferred queue depth (0 … 3 × K_SPP_DATABANK_SIZE).
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_queueDepth(void);
+
+/**
+ * @brief Return the number of entries waiting at one priority level.
+ *
+ * @param[in] prio  @ref K_SPP_PUBSUB_PRIO_HIGH … @ref K_SPP_PUBSUB_PRIO_LOW.
+ *
+ * @return Queue depth for @p prio (0 … K_SPP_DATABANK_SIZE); 0 for SYNC
+ *         or an out-of-range value.
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_queueDepthAt(spp_uint8_t prio);
+
+/**
+ * @brief Cap the depth of one deferred level.
+ *
+ * The queues are threaded through the packets themselves, so by default
+ * (@ref K_SPP_PUBSUB_QUEUE_LIMIT = 0) a level holds as many packets as the
+ * databank can lend.  A non-zero @p limit makes a publish that finds the
+ * level at @p limit entries apply the APID's overflow policy, e.g. to
+ * bound the latency of a level or keep packets free for producers.
+ * Lowering the limit below the current depth drops nothing; publishes
+ * overflow until the level has drained below it.
+ * @ref SPP_SERVICES_PUBSUB_init() restores the default.
+ *
+ * @param[in] prio   @ref K_SPP_PUBSUB_PRIO_HIGH … @ref K_SPP_PUBSUB_PRIO_LOW.
+ * @param[in] limit  Maximum entries, 0 for none.
+ *
+ * @return K_SPP_OK, or K_SPP_ERROR_INVALID_PARAMETER for SYNC or an
+ *         out-of-range @p prio.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setQueueLimit(spp_uint8_t prio, spp_uint16_t limit);
+
+#if !SPP_NO_STORAGE
+/**
+ * @brief Spill deferred packets to a storage FIFO instead of dropping them.
+ *
+ * With a spill file open, a deferred packet that would meet a level at its
+ * limit, or that leaves @p lowWater or fewer free packets of its size in
+ * the databank, is appended to the file and its pool packet released.
+ * While the file holds packets every later deferred packet follows them
+ * there, so subscribers still see publish order.  callConsumers() reads
+ * them back, oldest first, whenever a packet can be queued without
+ * pressure again (or all levels are empty).  Replayed packets keep their
+ * subscriber set and publish time, so waits and deadlines include the
+ * time spent on storage.
+ *
+ * publish() never touches storage: packets bound for the file keep their
+ * pool packet until the next consumer-side call (callConsumers(), a
+ * dispatch or a query) writes them.  Until then they count against the
+ * pool, so a producer that publishes faster than the consumer runs can
+ * still find the pool empty.  The write costs one or two storage writes
+ * per packet in consumer context; budget for the card's worst-case write
+ * latency there.
+ *
+ * The file is a ring of @ref K_SPP_PUBSUB_SPILL_MAX_BYTES bytes.  When the
+ * packets waiting in it leave no room for another, the APID's policy
+ * applies to the file: DROP_OLDEST skips the oldest spilled packets until
+ * the new one fits, every other policy drops the new packet.  Each packet
+ * lost counts as an overflow of its own APID, and the policy applied
+ * counts against the new packet's APID.  If a storage write fails, the
+ * packet is queued in RAM when nothing waits in the file, else dropped
+ * and counted the same way.  Subscribing is refused while packets are
+ * spilled, since they carry masks of the current subscriber table.
+ * SYNC subscribers are unaffected.  The filesystem must be mounted; the
+ * file is created, or truncated, here.  @ref SPP_SERVICES_PUBSUB_init()
+ * closes it.
+ *
+ * @param[in] p_path    Spill file path, or NULL to stop spilling.
+ * @param[in] lowWater  Free packets to keep for producers.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR if packets are still spilled (drain first), or the
+ *         file cannot be created.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_setSpill(const char *p_path, spp_uint16_t lowWater);
+
+/**
+ * @brief Return the number of packets waiting in the spill file.
+ *
+ * Not included in @ref SPP_SERVICES_PUBSUB_queueDepth().
+ *
+ * @return Spilled packets not yet queued again.
+ */
+spp_uint32_t SPP_SERVICES_PUBSUB_spillCount(void);
+#endif
+
+/**
+ * @brief Return how many deliveries of a deadline subscriber finished late.
+ *
+ * A delivery misses when its handler returns more than @c deadlineUs after
+ * the packet was published.  Deliveries lost to a queue overflow are
+ * counted by @ref SPP_SERVICES_PUBSUB_overflowCount() instead.
+ *
+ * @param[in] handler  Handler passed to subscribeEx(), or NULL for the
+ *                     total over all subscribers.
+ * @param[in] p_ctx    Context passed to subscribeEx().
+ *
+ * @return Cumulative misses (saturates at 0xFFFF); 0 if no such subscriber
+ *         is registered.
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_deadlineMisses(SPP_PubSub_Handler_t handler, const void *p_ctx);
+
+/**
+ * @brief Same as @ref SPP_SERVICES_PUBSUB_deadlineMisses() for a
+ *        subscriber registered with a @c batchHandler.
+ *
+ * @param[in] batchHandler  Batch handler passed to subscribeEx().
+ * @param[in] p_ctx         Context passed to subscribeEx().
+ *
+ * @return Cumulative misses; 0 if no such subscriber is registered.
+ */
+spp_uint16_t SPP_SERVICES_PUBSUB_batchDeadlineMisses(SPP_PubSub_BatchHandler_t batchHandler,
+                                                     const void *p_ctx);
+
+#if !SPP_NO_PUBSUB_STATS
+/**
+ * @brief Snapshot the timing histograms of a subscriber.
+ *
+ * The subscriber is identified by the handler and context it registered
+ * with; batch subscribers are looked up with
+ * @ref SPP_SERVICES_PUBSUB_batchSubscriberStats().  Wait and run times
+ * cover deferred deliveries; SYNC subscribers only record run time (and
+ * none under SPP_PUBSUB_MPSC, where they run in the producer's context).
+ *
+ * @param[in]  handler  Handler passed to subscribe().
+ * @param[in]  p_ctx    Context passed to subscribe().
+ * @param[out] p_out    Copy of the subscriber's histograms.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p handler or @p p_out is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if no subscriber is registered
+ *         with @p handler and @p p_ctx.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_subscriberStats(SPP_PubSub_Handler_t handler,
+                                                 const void *p_ctx,
+                                                 SPP_PubSub_SubStats_t *p_out);
+
+/**
+ * @brief Same as @ref SPP_SERVICES_PUBSUB_subscriberStats() for a
+ *        subscriber registered with a @c batchHandler.
+ *
+ * Run time is recorded once per call, wait time once per packet.
+ *
+ * @param[in]  batchHandler  Batch handler passed to subscribeEx().
+ * @param[in]  p_ctx         Context passed to subscribeEx().
+ * @param[out] p_out         Copy of the subscriber's histograms.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p batchHandler or @p p_out is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if no subscriber is registered
+ *         with @p batchHandler and @p p_ctx.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_batchSubscriberStats(SPP_PubSub_BatchHandler_t batchHandler,
+                                                      const void *p_ctx,
+                                                      SPP_PubSub_SubStats_t *p_out);
+
+/**
+ * @brief Snapshot the timing histograms of an APID.
  *
- * Useful for debug: if this grows without bound, callConsumers() is not keeping
- * up with publish() — either increase call rate or reduce publish rate.
+ * K_SPP_APID_ALL merges every APID, as for
+ * @ref SPP_SERVICES_PUBSUB_overflowCount().  The lifetime sample is taken
+ * when the last priority level is done with the packet, whether or not a
+ * handler still retains it.
  *
- * @return Deferred queue depth (0 … K_SPP_PUBSUB_QUEUE_SIZE).
+ * @param[in]  apid   APID, or @ref K_SPP_APID_ALL.
+ * @param[out] p_out  Histograms (zero if @p apid has no entry).
+ *
+ * @return K_SPP_OK, or K_SPP_ERROR_NULL_POINTER if @p p_out is NULL.
+ */
+SPP_RetVal_t SPP_SERVICES_PUBSUB_apidStats(spp_uint16_t apid, SPP_PubSub_ApidStats_t *p_out);
+
+/**
+ * @brief Upper bound of the bucket holding the @p pct-th percentile.
+ *
+ * @param[in] p_hist  Histogram.
+ * @param[in] pct     Percentile, 0 … 100.
+ *
+ * @return Duration in µs (the exact maximum for the last bucket), or 0 for
+ *         an empty or NULL histogram.
  */
-spp_uint8_t SPP_SERVICES_PUBSUB_queueDepth(void);
+spp_uint32_t SPP_SERVICES_PUBSUB_histPercentile(const SPP_PubSub_Hist_t *p_hist, spp_uint8_t pct);
+
+/**
+ * @brief Clear every subscriber and APID histogram.
+ */
+void SPP_SERVICES_PUBSUB_statsReset(void);
+#endif
 
 #ifdef __cplusplus
 }
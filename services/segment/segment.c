@@ -0,0 +1,215 @@
+/**
+ * @file segment.c
+ * @brief Segmentation and reassembly of records larger than one packet.
+ */
+
+#include "spp/services/segment/segment.h"
+#include "spp/services/databank/databank.h"
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/core/error.h"
+
+#include <string.h>
+
+/* ----------------------------------------------------------------
+ * Private helpers
+ * ---------------------------------------------------------------- */
+
+static void reasmDrop(SPP_SegmentReasm_t *p_reasm)
+{
+    if (p_reasm->active)
+    {
+        p_reasm->dropped++;
+    }
+    p_reasm->active = false;
+    p_reasm->len    = 0U;
+}
+
+/* ----------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------- */
+
+SPP_RetVal_t SPP_SERVICES_SEGMENT_publish(spp_uint16_t apid, spp_uint16_t *p_seq,
+                                          const void *p_data, spp_uint32_t len)
+{
+    SPP_SegmentPart_t part;
+
+    if (p_data == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    part.p_data = p_data;
+    part.len    = len;
+    return SPP_SERVICES_SEGMENT_publishParts(apid, p_seq, &part, 1U);
+}
+
+SPP_RetVal_t SPP_SERVICES_SEGMENT_publishParts(spp_uint16_t apid, spp_uint16_t *p_seq,
+                                               const SPP_SegmentPart_t *p_parts,
+                                               spp_uint8_t count)
+{
+    spp_uint32_t len     = 0U;
+    spp_uint32_t offset  = 0U;
+    spp_uint8_t  part    = 0U; /* Piece being copied ...          */
+    spp_uint32_t partOff = 0U; /* ... and its bytes already sent. */
+    spp_uint8_t  i;
+
+    if ((p_seq == NULL) || (p_parts == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    for (i = 0U; i < count; i++)
+    {
+        if ((p_parts[i].p_data == NULL) && (p_parts[i].len > 0U))
+        {
+            SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+        }
+        len += p_parts[i].len;
+    }
+
+    do
+    {
+        spp_uint32_t  remaining = len - offset;
+        spp_uint16_t  chunk     = (remaining > K_SPP_SEGMENT_CHUNK)
+                                      ? (spp_uint16_t)K_SPP_SEGMENT_CHUNK
+                                      : (spp_uint16_t)remaining;
+        spp_bool_t    isFirst   = (spp_bool_t)(offset == 0U);
+        spp_bool_t    isLast    = (spp_bool_t)((offset + chunk) == len);
+        SPP_Packet_t *p_pkt     = SPP_SERVICES_DATABANK_getPacketFor(apid, chunk);
+        spp_uint8_t  *p_out;
+        spp_uint16_t  fill      = 0U;
+
+        if (p_pkt == NULL)
+        {
+            return K_SPP_NOT_ENOUGH_PACKETS;
+        }
+
+        p_out = (spp_uint8_t *)SPP_SERVICES_DATABANK_packetBegin(p_pkt, apid, *p_seq);
+        while (fill < chunk)
+        {
+            const spp_uint8_t *p_src = (const spp_uint8_t *)p_parts[part].p_data;
+            spp_uint32_t       take  = p_parts[part].len - partOff;
+
+            if (take > (spp_uint32_t)(chunk - fill))
+            {
+                take = (spp_uint32_t)(chunk - fill);
+            }
+            if (take > 0U)
+            {
+                memcpy(&p_out[fill], &p_src[partOff], take);
+            }
+            fill    = (spp_uint16_t)(fill + take);
+            partOff += take;
+            if (partOff == p_parts[part].len)
+            {
+                part++;
+                partOff = 0U;
+            }
+        }
+
+        if (isFirst && isLast)
+        {
+            p_pkt->primaryHeader.seqFlags = K_SPP_PKT_SEQ_UNSEGMENTED;
+        }
+        else if (isFirst)
+        {
+            p_pkt->primaryHeader.seqFlags = K_SPP_PKT_SEQ_FIRST;
+        }
+        else if (isLast)
+        {
+            p_pkt->primaryHeader.seqFlags = K_SPP_PKT_SEQ_LAST;
+        }
+        else
+        {
+            p_pkt->primaryHeader.seqFlags = K_SPP_PKT_SEQ_CONTINUATION;
+        }
+
+        (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, chunk);
+        (*p_seq)++;
+        (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+
+        offset += chunk;
+    } while (offset < len);
+
+    return K_SPP_OK;
+}
+
+void SPP_SERVICES_SEGMENT_reasmInit(SPP_SegmentReasm_t *p_reasm)
+{
+    if (p_reasm == NULL)
+    {
+        return;
+    }
+    p_reasm->len     = 0U;
+    p_reasm->apid    = 0U;
+    p_reasm->nextSeq = 0U;
+    p_reasm->active  = false;
+    p_reasm->dropped = 0U;
+}
+
+SPP_RetVal_t SPP_SERVICES_SEGMENT_reassemble(SPP_SegmentReasm_t *p_reasm,
+                                             const SPP_Packet_t *p_packet,
+                                             const spp_uint8_t **pp_record,
+                                             spp_uint32_t *p_len)
+{
+    spp_uint8_t  flags;
+    spp_uint16_t apid;
+    spp_uint16_t seq;
+    spp_uint16_t chunk;
+
+    if ((p_reasm == NULL) || (p_packet == NULL) || (pp_record == NULL) || (p_len == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    *pp_record = NULL;
+    *p_len     = 0U;
+
+    flags = p_packet->primaryHeader.seqFlags;
+    apid  = p_packet->primaryHeader.apid;
+    seq   = p_packet->primaryHeader.seq;
+    chunk = p_packet->primaryHeader.payloadLen;
+
+    /* Fast path: a whole record in one packet is handed out in place. */
+    if (flags == K_SPP_PKT_SEQ_UNSEGMENTED)
+    {
+        if (p_reasm->active && (apid == p_reasm->apid))
+        {
+            reasmDrop(p_reasm);
+        }
+        *pp_record = p_packet->payload;
+        *p_len     = chunk;
+        return K_SPP_OK;
+    }
+
+    if (flags == K_SPP_PKT_SEQ_FIRST)
+    {
+        reasmDrop(p_reasm);
+        p_reasm->active = true;
+        p_reasm->apid   = apid;
+    }
+    else if (!p_reasm->active || (apid != p_reasm->apid) || (seq != p_reasm->nextSeq))
+    {
+        /* Missing FIRST or a gap — the record can no longer be completed. */
+        reasmDrop(p_reasm);
+        SPP_ERR_RETURN(K_SPP_ERROR);
+    }
+
+    if ((p_reasm->len + chunk) > K_SPP_SEGMENT_MAX_RECORD)
+    {
+        reasmDrop(p_reasm);
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    memcpy(&p_reasm->buf[p_reasm->len], p_packet->payload, chunk);
+    p_reasm->len    += chunk;
+    p_reasm->nextSeq = (spp_uint16_t)(seq + 1U);
+
+    if (flags == K_SPP_PKT_SEQ_LAST)
+    {
+        *pp_record      = p_reasm->buf;
+        *p_len          = p_reasm->len;
+        p_reasm->active = false;
+        p_reasm->len    = 0U;
+    }
+
+    return K_SPP_OK;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file segment.h
+ * @brief Segmentation and reassembly of records larger than one packet.
+ *
+ * A record longer than @ref K_SPP_SEGMENT_CHUNK is published as a run of
+ * packets with consecutive @c seq values and CCSDS sequence flags
+ * (FIRST, CONTINUATION…, LAST).  Short records go out as a single
+ * UNSEGMENTED packet, so the sender does not need to care.
+ *
+ * On the receiving side a subscriber feeds every packet of one APID stream
+ * into an @ref SPP_SegmentReasm_t.  The buffer is caller-allocated and
+ * bounded by @ref K_SPP_SEGMENT_MAX_RECORD; a gap in @c seq, a missing
+ * FIRST or an oversized record discards the partial record and counts it.
+ *
+ * Naming conventions used in this file:
+ * - Constants/macros: K_SPP_SEGMENT_*
+ * - Types: SPP_SegmentReasm_t, SPP_SegmentPart_t
+ * - Public functions: SPP_SERVICES_SEGMENT_*()
+ * - Pointer parameters: p_*
+ */
+
+#ifndef SPP_SEGMENT_H
+#define SPP_SEGMENT_H
+
+#include "spp/core/packet.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/types.h"
+#include "spp/util/macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * Types
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Reassembly state for one APID stream.
+ *
+ * Declare one static instance per stream and initialise it with
+ * @ref SPP_SERVICES_SEGMENT_reasmInit().
+ */
+typedef struct
+{
+    spp_uint8_t  buf[K_SPP_SEGMENT_MAX_RECORD]; /**< Record being rebuilt.                  */
+    spp_uint32_t len;                           /**< Bytes collected so far.                */
+    spp_uint16_t apid;                          /**< APID of the record in progress.        */
+    spp_uint16_t nextSeq;                       /**< Expected seq of the next segment.      */
+    spp_bool_t   active;                        /**< A FIRST segment has been accepted.     */
+    spp_uint32_t dropped;                       /**< Records discarded (gap, overflow, …).  */
+} SPP_SegmentReasm_t;
+
+/** @brief One piece of a record given to @ref SPP_SERVICES_SEGMENT_publishParts(). */
+typedef struct
+{
+    const void  *p_data; /**< Bytes of this piece (may be NULL if @c len is 0). */
+    spp_uint32_t len;    /**< Length in bytes.                                  */
+} SPP_SegmentPart_t;
+
+/* ----------------------------------------------------------------
+ * API
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Publish a record, splitting it into segments when needed.
+ *
+ * Each segment is acquired with @ref SPP_SERVICES_DATABANK_getPacketFor()
+ * (so APID quotas apply), built in place and passed to
+ * @ref SPP_SERVICES_PUBSUB_publish().  @p p_seq is advanced once per
+ * packet sent.
+ *
+ * @param[in]     apid    APID of the record.
+ * @param[in,out] p_seq   Caller's sequence counter for @p apid.
+ * @param[in]     p_data  Record bytes.
+ * @param[in]     len     Record length in bytes.
+ *
+ * @return K_SPP_OK if every segment was published.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_seq or @p p_data is NULL.
+ * @return K_SPP_NOT_ENOUGH_PACKETS if the pool ran dry part-way; the
+ *         segments already sent are discarded by the receiver.
+ */
+SPP_RetVal_t SPP_SERVICES_SEGMENT_publish(spp_uint16_t apid, spp_uint16_t *p_seq,
+                                          const void *p_data, spp_uint32_t len);
+
+/**
+ * @brief Publish a record given as several pieces, back to back.
+ *
+ * Same as @ref SPP_SERVICES_SEGMENT_publish() for the concatenation of
+ * the parts, but the pieces are copied straight into the leased packets,
+ * so the caller needs no buffer for the whole record.
+ *
+ * @param[in]     apid     APID of the record.
+ * @param[in,out] p_seq    Caller's sequence counter for @p apid.
+ * @param[in]     p_parts  Pieces of the record, in order.
+ * @param[in]     count    Number of pieces.
+ *
+ * @return As for @ref SPP_SERVICES_SEGMENT_publish(); also
+ *         K_SPP_ERROR_NULL_POINTER if @p p_parts is NULL or a piece with
+ *         bytes has no data.
+ */
+SPP_RetVal_t SPP_SERVICES_SEGMENT_publishParts(spp_uint16_t apid, spp_uint16_t *p_seq,
+                                               const SPP_SegmentPart_t *p_parts,
+                                               spp_uint8_t count);
+
+/**
+ * @brief Reset a reassembly buffer (drops any partial record, keeps nothing).
+ *
+ * @param[out] p_reasm  Reassembly state to initialise.
+ */
+void SPP_SERVICES_SEGMENT_reasmInit(SPP_SegmentReasm_t *p_reasm);
+
+/**
+ * @brief Feed one received packet into a reassembly buffer.
+ *
+ * When a record completes, @p *pp_record points at it and @p *p_len holds
+ * its length; the pointer stays valid until the next call.  An UNSEGMENTED
+ * packet is returned directly from its payload without copying.  While a
+ * record is still incomplete @p *pp_record is NULL.
+ *
+ * A packet of another APID that is UNSEGMENTED passes through without
+ * disturbing the record in progress; use one buffer per APID if segmented
+ * streams can interleave.
+ *
+ * @param[in,out] p_reasm    Reassembly state.
+ * @param[in]     p_packet   Received packet.
+ * @param[out]    pp_record  Completed record, or NULL.
+ * @param[out]    p_len      Completed record length (0 while incomplete).
+ *
+ * @return K_SPP_OK on success (record complete or in progress).
+ * @return K_SPP_ERROR_NULL_POINTER on NULL arguments.
+ * @return K_SPP_ERROR if the segment does not continue the record in
+ *         progress (the partial record is discarded).
+ * @return K_SPP_ERROR_INVALID_PARAMETER if the record would exceed
+ *         @ref K_SPP_SEGMENT_MAX_RECORD (the partial record is discarded).
+ */
+SPP_RetVal_t SPP_SERVICES_SEGMENT_reassemble(SPP_SegmentReasm_t *p_reasm,
+                                             const SPP_Packet_t *p_packet,
+                                             const spp_uint8_t **pp_record,
+                                             spp_uint32_t *p_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPP_SEGMENT_H */
@@ -7,6 +7,7 @@
 #include "spp/services/pubsub/pubsub.h"
 #include "spp/core/error.h"
 #include "spp/services/log/log.h"
+#include "spp/hal/time.h"
 
 /* ----------------------------------------------------------------
  * Private state
@@ -18,17 +19,123 @@ typedef struct
 {
     const SPP_Module_t *p_module;
     void               *p_ctx;
+    SPP_GpioIsrCtx_t   *p_isrCtx; /* Bound by bindReady(), or NULL. */
+    SPP_Timer_t        *p_timer;  /* Bound by bindTimer(), or NULL. */
 } ServiceEntry_t;
 
 static ServiceEntry_t s_registry[K_SPP_MAX_SERVICES];
 static spp_uint32_t   s_count = 0U;
 
+/* Bit i = s_registry[i].  ISRs set bits in s_readyMask; modules with a
+ * produce that are not bound to an ISR are in s_pollMask and run on every
+ * pass. */
+static volatile spp_uint32_t s_readyMask = 0U;
+static spp_uint32_t          s_pollMask  = 0U;
+
+/* ----------------------------------------------------------------
+ * Private helpers
+ * ---------------------------------------------------------------- */
+
+/* Take and clear the ready mask.  An ISR may set bits at any time, so the
+ * swap must be atomic; ports without GNU atomics must mask interrupts
+ * around callProducers(). */
+static spp_uint32_t readyTake(void)
+{
+#if defined(__GNUC__)
+    return __atomic_exchange_n(&s_readyMask, 0U, __ATOMIC_ACQUIRE);
+#else
+    spp_uint32_t ready = s_readyMask;
+    s_readyMask        = 0U;
+    return ready;
+#endif
+}
+
+static void readySet(spp_uint32_t bits)
+{
+#if defined(__GNUC__)
+    (void)__atomic_fetch_or(&s_readyMask, bits, __ATOMIC_RELEASE);
+#else
+    s_readyMask |= bits;
+#endif
+}
+
+static void readyClear(spp_uint32_t bits)
+{
+#if defined(__GNUC__)
+    (void)__atomic_fetch_and(&s_readyMask, ~bits, __ATOMIC_RELEASE);
+#else
+    s_readyMask &= ~bits;
+#endif
+}
+
+static spp_uint32_t lowestBit(spp_uint32_t mask)
+{
+#if defined(__GNUC__)
+    return (spp_uint32_t)__builtin_ctz(mask);
+#else
+    spp_uint32_t bit = 0U;
+    while ((mask & 1U) == 0U)
+    {
+        mask >>= 1U;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+static spp_uint32_t entryIndex(const void *p_ctx)
+{
+    spp_uint32_t i;
+
+    for (i = 0U; i < s_count; i++)
+    {
+        if (s_registry[i].p_ctx == p_ctx)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Drop the last entry after its init or start failed.  Its interrupt and
+ * timer are unbound first, so they cannot mark the next module registered
+ * in the same slot ready. */
+static void entryRollback(void)
+{
+    ServiceEntry_t *p_entry = &s_registry[s_count - 1U];
+    spp_uint32_t    bit     = (spp_uint32_t)1U << (s_count - 1U);
+
+    if (p_entry->p_timer != NULL)
+    {
+        (void)SPP_SERVICES_TIMER_cancel(p_entry->p_timer);
+        p_entry->p_timer = NULL;
+    }
+    if (p_entry->p_isrCtx != NULL)
+    {
+        p_entry->p_isrCtx->p_readyMask = NULL;
+        p_entry->p_isrCtx              = NULL;
+    }
+    readyClear(bit);
+    s_pollMask &= ~bit;
+    s_count--;
+}
+
+/* Timer callback of a module bound with bindTimer(). */
+static void timerReady(void *p_ctx)
+{
+    const ServiceEntry_t *p_entry = (const ServiceEntry_t *)p_ctx;
+
+    readySet((spp_uint32_t)1U << (spp_uint32_t)(p_entry - s_registry));
+}
+
 /* ----------------------------------------------------------------
  * Public API
  * ---------------------------------------------------------------- */
 
 SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx)
 {
+    spp_uint32_t bit;
+
     if ((p_module == NULL) || (p_ctx == NULL))
     {
         SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
@@ -39,8 +146,15 @@ SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx)
         SPP_ERR_RETURN(K_SPP_ERROR_REGISTRY_FULL);
     }
 
+    bit                          = (spp_uint32_t)1U << s_count;
     s_registry[s_count].p_module = p_module;
     s_registry[s_count].p_ctx    = p_ctx;
+    s_registry[s_count].p_isrCtx = NULL;
+    s_registry[s_count].p_timer  = NULL;
+    if (p_module->produce != NULL)
+    {
+        s_pollMask |= bit;
+    }
     s_count++;
 
     if (p_module->init != NULL)
@@ -49,7 +163,7 @@ SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx)
         if (ret != K_SPP_OK)
         {
             SPP_LOGE(k_tag, "Module '%s' init failed (%d)", p_module->p_name, (int)ret);
-            s_count--;
+            entryRollback();
             SPP_ERR_RETURN(ret);
         }
     }
@@ -60,12 +174,22 @@ SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx)
         if (ret != K_SPP_OK)
         {
             SPP_LOGE(k_tag, "Module '%s' start failed (%d)", p_module->p_name, (int)ret);
-            s_count--;
+            entryRollback();
             SPP_ERR_RETURN(ret);
         }
     }
 
-    if (p_module->onPacket != NULL)
+    if (p_module->onPacketBatch != NULL)
+    {
+        SPP_PubSub_SubCfg_t cfg = { 0 };
+
+        cfg.apid         = p_module->consumesApid;
+        cfg.prio         = p_module->onPacketPrio;
+        cfg.batchHandler = p_module->onPacketBatch;
+        cfg.p_ctx        = p_ctx;
+        (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    }
+    else if (p_module->onPacket != NULL)
     {
         (void)SPP_SERVICES_PUBSUB_subscribe(p_module->consumesApid, p_module->onPacketPrio,
                                              p_module->onPacket, p_ctx);
@@ -75,11 +199,69 @@ SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx)
     return K_SPP_OK;
 }
 
+SPP_RetVal_t SPP_SERVICES_bindReady(const void *p_ctx, SPP_GpioIsrCtx_t *p_isrCtx)
+{
+    spp_uint32_t i;
+    spp_uint32_t bit;
+
+    if (p_isrCtx == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    i = entryIndex(p_ctx);
+    if (i == s_count)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    bit                    = (spp_uint32_t)1U << i;
+    p_isrCtx->readyBit     = bit;
+    p_isrCtx->p_readyMask  = &s_readyMask;
+    s_registry[i].p_isrCtx = p_isrCtx;
+    s_pollMask            &= ~bit;
+    readySet(bit);
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_bindTimer(const void *p_ctx, SPP_Timer_t *p_timer,
+                                    spp_uint32_t periodMs)
+{
+    spp_uint32_t i;
+    SPP_RetVal_t ret;
+
+    if (p_timer == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    i = entryIndex(p_ctx);
+    if ((i == s_count) || (periodMs == 0U))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    (void)SPP_SERVICES_TIMER_setup(p_timer, timerReady, &s_registry[i]);
+    ret = SPP_SERVICES_TIMER_start(p_timer, periodMs, periodMs);
+    if (ret != K_SPP_OK)
+    {
+        return ret;
+    }
+    s_registry[i].p_timer = p_timer;
+    s_pollMask           &= ~((spp_uint32_t)1U << i);
+    return K_SPP_OK;
+}
+
 SPP_RetVal_t SPP_SERVICES_callProducers(void)
 {
-    for (spp_uint32_t i = 0U; i < s_count; i++)
+    spp_uint32_t ready;
+
+    (void)SPP_SERVICES_TIMER_run();
+    ready = readyTake() | s_pollMask;
+
+    while (ready != 0U)
     {
-        const ServiceEntry_t *p_entry = &s_registry[i];
+        const ServiceEntry_t *p_entry = &s_registry[lowestBit(ready)];
+
+        ready &= ready - 1U;
         if (p_entry->p_module->produce != NULL)
         {
             p_entry->p_module->produce(p_entry->p_ctx);
@@ -88,11 +270,36 @@ SPP_RetVal_t SPP_SERVICES_callProducers(void)
     return K_SPP_OK;
 }
 
+spp_bool_t SPP_SERVICES_idle(spp_uint32_t maxMs)
+{
+    spp_uint32_t nextMs = SPP_SERVICES_TIMER_msToNext();
+
+    if ((s_readyMask != 0U) || (s_pollMask != 0U) ||
+        (SPP_SERVICES_PUBSUB_queueDepth() != 0U))
+    {
+        return false;
+    }
+#if !SPP_NO_STORAGE
+    if (SPP_SERVICES_PUBSUB_spillCount() != 0U)
+    {
+        return false;
+    }
+#endif
+    (void)SPP_HAL_waitEvent((nextMs < maxMs) ? nextMs : maxMs);
+    return true;
+}
+
 void SPP_SERVICES_callConsumers(void)
 {
     SPP_SERVICES_PUBSUB_callConsumers();
 }
 
+spp_uint32_t SPP_SERVICES_callConsumersBudget(spp_uint32_t maxDispatches,
+                                              spp_uint32_t maxMicros)
+{
+    return SPP_SERVICES_PUBSUB_callConsumersBudget(maxDispatches, maxMicros);
+}
+
 spp_uint32_t SPP_SERVICES_count(void)
 {
     return s_count;
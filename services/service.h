@@ -8,11 +8,14 @@
  * @ref SPP_SERVICES_register().
  *
  * Registration automatically wires up pub/sub subscriptions: if a module
- * sets @c onPacket != NULL, @ref SPP_SERVICES_register() calls
- * @ref SPP_SERVICES_PUBSUB_subscribe() with @c consumesApid and @c onPacketPrio.
+ * sets @c onPacket or @c onPacketBatch, @ref SPP_SERVICES_register()
+ * subscribes it with @c consumesApid and @c onPacketPrio.
  *
- * @ref SPP_SERVICES_callProducers() iterates every registered module and calls its
- * @c produce, replacing the per-sensor DRDY checks in the superloop.
+ * @ref SPP_SERVICES_callProducers() calls the @c produce of every registered
+ * module, replacing the per-sensor DRDY checks in the superloop.  A module
+ * whose data-ready interrupt is bound with @ref SPP_SERVICES_bindReady() is
+ * only called after its ISR fired, so an idle superloop costs O(ready)
+ * and can sleep in @ref SPP_SERVICES_idle().
  *
  * Naming conventions used in this file:
  * - Constants/macros: K_SPP_*
@@ -28,6 +31,12 @@
 #include "spp/core/returnTypes.h"
 #include "spp/util/macros.h"
 #include "spp/services/pubsub/pubsub.h"
+#include "spp/services/timer/timer.h"
+#include "spp/hal/gpio.h"
+
+#if K_SPP_MAX_SERVICES > 32U
+#error "K_SPP_MAX_SERVICES must fit in the 32-bit producer ready mask"
+#endif
 
 /* ----------------------------------------------------------------
  * Module descriptor
@@ -59,7 +68,7 @@
 typedef struct
 {
     const char   *p_name;  /**< Human-readable module name (for logging). */
-    spp_uint16_t  apid;    /**< APID bitmask produced by this module (single bit, or K_SPP_APID_NONE). */
+    spp_uint16_t  apid;    /**< APID produced by this module, or K_SPP_APID_NONE. */
     size_t        ctxSize; /**< sizeof(module-private context struct). */
 
     /**
@@ -101,10 +110,12 @@ typedef struct
     void (*produce)(void *p_ctx);
 
     /**
-     * @brief APID bitmask this module subscribes to.
+     * @brief APID this module subscribes to.
      *
      * Use @ref K_SPP_APID_ALL for all packets, @ref K_SPP_APID_NONE if this
      * module does not consume packets.  Ignored when @c onPacket is NULL.
+     * Modules that need an APID range or set call
+     * @ref SPP_SERVICES_PUBSUB_subscribeEx() from their init instead.
      */
     spp_uint16_t consumesApid;
 
@@ -122,6 +133,15 @@ typedef struct
     /** @brief Dispatch priority for @c onPacket (@ref K_SPP_PUBSUB_PRIO_SYNC … @ref K_SPP_PUBSUB_PRIO_LOW). */
     spp_uint8_t onPacketPrio;
 
+    /**
+     * @brief Batch subscription handler, registered instead of @c onPacket.
+     *
+     * For consumers with a per-call cost (storage, radio): each call gets
+     * up to @ref K_SPP_PUBSUB_BATCH_MAX waiting packets.  Leave
+     * @c onPacket NULL when this is set; @c onPacketPrio applies.
+     */
+    SPP_PubSub_BatchHandler_t onPacketBatch;
+
 } SPP_Module_t;
 
 /* ----------------------------------------------------------------
@@ -131,24 +151,89 @@ typedef struct
 /**
  * @brief Register a module: runs init(), runs start(), and wires up pub/sub.
  *
+ * If init() or start() fails the module is not registered: a binding made
+ * by its init() is undone (the ISR context no longer points at the ready
+ * mask, the bound timer is cancelled) and its ready bit is cleared.
+ *
  * @param[in] p_module  Pointer to the static module descriptor.
  * @param[in] p_ctx     Pointer to the caller-allocated context buffer.
  *
- * @return K_SPP_OK on success, K_SPP_ERROR_REGISTRY_FULL if the registry is full.
+ * @return K_SPP_OK on success, K_SPP_ERROR_REGISTRY_FULL if the registry is
+ *         full, or the error init() or start() returned.
  */
 SPP_RetVal_t SPP_SERVICES_register(const SPP_Module_t *p_module, void *p_ctx);
 
 /**
- * @brief Call @c produce on every registered module that has one.
+ * @brief Make a registered module's @c produce interrupt-driven.
+ *
+ * Points @p p_isrCtx at the registry's ready mask, so the GPIO ISR marks
+ * the module ready when it fires; @ref SPP_SERVICES_callProducers() then
+ * calls its @c produce once per batch of interrupts instead of on every
+ * pass.  Call from the module's @c init, before or after
+ * SPP_HAL_gpioRegisterIsr().  The module starts out ready, so an interrupt
+ * that fired before the binding is not lost.
+ *
+ * @param[in]     p_ctx     Context the module was registered with.
+ * @param[in,out] p_isrCtx  The module's GPIO ISR context.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_isrCtx is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if no module is registered with
+ *         @p p_ctx.
+ */
+SPP_RetVal_t SPP_SERVICES_bindReady(const void *p_ctx, SPP_GpioIsrCtx_t *p_isrCtx);
+
+/**
+ * @brief Make a registered module's @c produce periodic.
+ *
+ * For producers without a data-ready line (housekeeping, downlink
+ * pacing): starts @p p_timer so that the module is marked ready every
+ * @p periodMs, and @ref SPP_SERVICES_callProducers() stops calling its
+ * @c produce on every pass.  The first call comes one period after the
+ * binding.  Call from the module's @c init; the timer must stay valid
+ * while the module is registered.
+ *
+ * @param[in]  p_ctx     Context the module was registered with.
+ * @param[out] p_timer   Timer owned by the module; set up by this call.
+ * @param[in]  periodMs  Interval between produce calls (1 …
+ *                       @ref K_SPP_TIMER_MAX_MS).
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_timer is NULL.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if no module is registered with
+ *         @p p_ctx or @p periodMs is out of range.
+ */
+SPP_RetVal_t SPP_SERVICES_bindTimer(const void *p_ctx, SPP_Timer_t *p_timer,
+                                    spp_uint32_t periodMs);
+
+/**
+ * @brief Call @c produce on every module that may have data.
  *
- * Replaces per-sensor DRDY checks in the superloop.  Each module's produce
- * is responsible for checking its own DRDY flag and returning immediately when
- * no data is ready.
+ * Runs due timers first (@ref SPP_SERVICES_TIMER_run()), then visits, in
+ * registration order, the bound modules whose ISR or timer fired since the
+ * last call and every module with a @c produce that is not bound.
+ * Each module's produce still checks its own DRDY flag and returns
+ * immediately when no data is ready.
  *
  * @return K_SPP_OK always.
  */
 SPP_RetVal_t SPP_SERVICES_callProducers(void);
 
+/**
+ * @brief Sleep while there is nothing to do.
+ *
+ * With no bound module ready, no unbound producer registered and nothing
+ * queued for deferred dispatch, waits up to @p maxMs in
+ * SPP_HAL_waitEvent() for the next interrupt, or until the next timer is
+ * due if that is sooner.  Call at the end of each superloop pass.
+ *
+ * @param[in] maxMs  Longest sleep in milliseconds.
+ *
+ * @return true if there was nothing to do (whether or not the port could
+ *         sleep), false if the loop should go round again at once.
+ */
+spp_bool_t SPP_SERVICES_idle(spp_uint32_t maxMs);
+
 /**
  * @brief Dispatch the next pending deferred subscriber.
  *
@@ -157,6 +242,21 @@ SPP_RetVal_t SPP_SERVICES_callProducers(void);
  */
 void SPP_SERVICES_callConsumers(void);
 
+/**
+ * @brief Dispatch deferred subscribers until a count or time budget is spent.
+ *
+ * Thin wrapper around @ref SPP_SERVICES_PUBSUB_callConsumersBudget().  Use in
+ * place of @ref SPP_SERVICES_callConsumers() when bursts must drain within
+ * one superloop iteration.
+ *
+ * @param[in] maxDispatches  Maximum handler calls (0 = no limit).
+ * @param[in] maxMicros      Time budget in µs (0 = no limit).
+ *
+ * @return Number of subscriber handlers called.
+ */
+spp_uint32_t SPP_SERVICES_callConsumersBudget(spp_uint32_t maxDispatches,
+                                              spp_uint32_t maxMicros);
+
 /**
  * @brief Return the number of currently registered modules.
  *
@@ -0,0 +1,367 @@
+/**
+ * @file timer.c
+ * @brief Hierarchical timer wheel: O(1) start, cancel and expiry.
+ */
+
+#include "spp/services/timer/timer.h"
+#include "spp/core/error.h"
+#include "spp/hal/time.h"
+
+#include <string.h>
+
+#if (K_SPP_TIMER_WHEEL_BITS == 0U) || (K_SPP_TIMER_LEVELS == 0U) || \
+    ((K_SPP_TIMER_WHEEL_BITS * K_SPP_TIMER_LEVELS) > 30U)
+#error "K_SPP_TIMER_WHEEL_BITS * K_SPP_TIMER_LEVELS must be 1..30"
+#endif
+
+/* ----------------------------------------------------------------
+ * Private state
+ * ---------------------------------------------------------------- */
+
+#define K_WHEEL_SLOTS ((spp_uint32_t)1U << K_SPP_TIMER_WHEEL_BITS)
+#define K_WHEEL_MASK  (K_WHEEL_SLOTS - 1U)
+
+/* Longest due interval whose length in µs fits the 32-bit µs clock. */
+#define K_JITTER_MAX_MS (0xFFFFFFFFU / 1000U)
+
+/* Level l, slot s holds the timers due in the 2^(BITS*l)-tick span with
+ * index s at that level.  Slots are NULL-terminated lists linked through
+ * p_next / pp_prev, so an all-zero wheel is empty. */
+static SPP_Timer_t *s_wheel[K_SPP_TIMER_LEVELS][K_WHEEL_SLOTS];
+
+static spp_uint32_t s_tick    = 0U;    /* Next tick to process.                */
+static spp_uint32_t s_nowMs   = 0U;    /* Clock of the last run / advance.     */
+static spp_uint32_t s_active  = 0U;    /* Timers linked into the wheel.        */
+static spp_bool_t   s_started = false; /* s_tick / s_nowMs follow a clock.     */
+
+/* ----------------------------------------------------------------
+ * Private helpers
+ * ---------------------------------------------------------------- */
+
+static void wheelSync(spp_uint32_t nowMs)
+{
+    s_nowMs   = nowMs;
+    s_tick    = nowMs + 1U;
+    s_started = true;
+}
+
+/* Link a timer into the slot for its due tick, relative to s_tick. */
+static void wheelLink(SPP_Timer_t *p_timer)
+{
+    spp_uint32_t  due   = p_timer->dueMs;
+    spp_uint32_t  delta = due - s_tick;
+    spp_uint32_t  level = 0U;
+    SPP_Timer_t **pp_head;
+
+    if ((spp_int32_t)delta < 0)
+    {
+        /* Already due: the next tick processed. */
+        due   = s_tick;
+        delta = 0U;
+    }
+    else if (delta > K_SPP_TIMER_MAX_MS)
+    {
+        /* Beyond the top level after a long catch-up: park it where the
+         * farthest timer goes; the cascade re-files it by its real tick. */
+        due   = s_tick + K_SPP_TIMER_MAX_MS;
+        delta = K_SPP_TIMER_MAX_MS;
+    }
+
+    while (((level + 1U) < K_SPP_TIMER_LEVELS) &&
+           ((delta >> (K_SPP_TIMER_WHEEL_BITS * (level + 1U))) != 0U))
+    {
+        level++;
+    }
+
+    pp_head          = &s_wheel[level][(due >> (K_SPP_TIMER_WHEEL_BITS * level)) & K_WHEEL_MASK];
+    p_timer->p_next  = *pp_head;
+    p_timer->pp_prev = pp_head;
+    if (*pp_head != NULL)
+    {
+        (*pp_head)->pp_prev = &p_timer->p_next;
+    }
+    *pp_head = p_timer;
+}
+
+static void wheelUnlink(SPP_Timer_t *p_timer)
+{
+    *p_timer->pp_prev = p_timer->p_next;
+    if (p_timer->p_next != NULL)
+    {
+        p_timer->p_next->pp_prev = p_timer->pp_prev;
+    }
+    p_timer->p_next  = NULL;
+    p_timer->pp_prev = NULL;
+}
+
+/* Move a slot's list to *pp_list.  Timers on it stay linked, so a callback
+ * can still cancel one that has not been reached yet. */
+static void slotTake(SPP_Timer_t **pp_slot, SPP_Timer_t **pp_list)
+{
+    *pp_list = *pp_slot;
+    *pp_slot = NULL;
+    if (*pp_list != NULL)
+    {
+        (*pp_list)->pp_prev = pp_list;
+    }
+}
+
+/* Re-file the current slot of @p level one level down; returns its index
+ * so the caller knows whether the level above wrapped too. */
+static spp_uint32_t wheelCascade(spp_uint32_t level)
+{
+    spp_uint32_t idx = (s_tick >> (K_SPP_TIMER_WHEEL_BITS * level)) & K_WHEEL_MASK;
+    SPP_Timer_t *p_list;
+
+    slotTake(&s_wheel[level][idx], &p_list);
+    while (p_list != NULL)
+    {
+        SPP_Timer_t *p_timer = p_list;
+        wheelUnlink(p_timer);
+        wheelLink(p_timer);
+    }
+    return idx;
+}
+
+static void timerStats(SPP_Timer_t *p_timer, spp_uint32_t due)
+{
+    SPP_TimerStats_t *p_stats = &p_timer->stats;
+    spp_uint32_t      nowUs   = SPP_HAL_getTimeUs();
+    spp_uint32_t      late    = s_nowMs - due;
+
+    p_stats->fires++;
+    if (late > p_stats->lateMaxMs)
+    {
+        p_stats->lateMaxMs = late;
+    }
+
+    if (p_timer->hasLast && ((due - p_timer->lastDueMs) <= K_JITTER_MAX_MS))
+    {
+        spp_int32_t  jitter = (spp_int32_t)((nowUs - p_timer->lastFireUs) -
+                                            ((due - p_timer->lastDueMs) * 1000U));
+        spp_uint32_t absUs  = (jitter < 0) ? (0U - (spp_uint32_t)jitter) : (spp_uint32_t)jitter;
+
+        if ((p_stats->jitterSamples == 0U) || (jitter < p_stats->jitterMinUs))
+        {
+            p_stats->jitterMinUs = jitter;
+        }
+        if ((p_stats->jitterSamples == 0U) || (jitter > p_stats->jitterMaxUs))
+        {
+            p_stats->jitterMaxUs = jitter;
+        }
+        p_stats->jitterSamples++;
+        p_timer->jitterAbsSumUs += absUs;
+    }
+
+    p_timer->hasLast    = true;
+    p_timer->lastFireUs = nowUs;
+    p_timer->lastDueMs  = due;
+}
+
+/* Reload or retire an unlinked, due timer, then call it. */
+static void timerFire(SPP_Timer_t *p_timer)
+{
+    spp_uint32_t due = p_timer->dueMs;
+
+    timerStats(p_timer, due);
+
+    if (p_timer->periodMs != 0U)
+    {
+        spp_uint32_t missed = (s_nowMs - due) / p_timer->periodMs;
+
+        p_timer->stats.skipped += missed;
+        p_timer->dueMs          = due + ((missed + 1U) * p_timer->periodMs);
+        wheelLink(p_timer);
+    }
+    else
+    {
+        s_active--;
+    }
+
+    p_timer->callback(p_timer->p_ctx);
+}
+
+/* ----------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------- */
+
+void SPP_SERVICES_TIMER_init(void)
+{
+    memset(s_wheel, 0, sizeof(s_wheel));
+    s_active = 0U;
+    wheelSync(SPP_HAL_getTimeMs());
+}
+
+SPP_RetVal_t SPP_SERVICES_TIMER_setup(SPP_Timer_t *p_timer, SPP_TimerCallback_t callback,
+                                      void *p_ctx)
+{
+    if ((p_timer == NULL) || (callback == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->callback = callback;
+    p_timer->p_ctx    = p_ctx;
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_TIMER_start(SPP_Timer_t *p_timer, spp_uint32_t delayMs,
+                                      spp_uint32_t periodMs)
+{
+    if (p_timer == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+    if (p_timer->callback == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NOT_INITIALIZED);
+    }
+    if ((delayMs > K_SPP_TIMER_MAX_MS) || (periodMs > K_SPP_TIMER_MAX_MS))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_INVALID_PARAMETER);
+    }
+
+    if (!s_started)
+    {
+        wheelSync(SPP_HAL_getTimeMs());
+    }
+
+    if (p_timer->pp_prev != NULL)
+    {
+        wheelUnlink(p_timer);
+    }
+    else
+    {
+        s_active++;
+    }
+
+    p_timer->dueMs    = s_nowMs + ((delayMs == 0U) ? 1U : delayMs);
+    p_timer->periodMs = periodMs;
+    p_timer->hasLast  = false;
+    wheelLink(p_timer);
+    return K_SPP_OK;
+}
+
+SPP_RetVal_t SPP_SERVICES_TIMER_cancel(SPP_Timer_t *p_timer)
+{
+    if (p_timer == NULL)
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    if (p_timer->pp_prev != NULL)
+    {
+        wheelUnlink(p_timer);
+        s_active--;
+    }
+    return K_SPP_OK;
+}
+
+spp_bool_t SPP_SERVICES_TIMER_isActive(const SPP_Timer_t *p_timer)
+{
+    return (p_timer != NULL) && (p_timer->pp_prev != NULL);
+}
+
+spp_uint32_t SPP_SERVICES_TIMER_run(void)
+{
+    return SPP_SERVICES_TIMER_advance(SPP_HAL_getTimeMs());
+}
+
+spp_uint32_t SPP_SERVICES_TIMER_advance(spp_uint32_t nowMs)
+{
+    spp_uint32_t fired = 0U;
+
+    if (s_started && ((spp_int32_t)(nowMs - s_nowMs) < 0))
+    {
+        return 0U;
+    }
+    if (s_active == 0U)
+    {
+        wheelSync(nowMs);
+        return 0U;
+    }
+
+    s_nowMs = nowMs;
+    while ((spp_int32_t)(nowMs - s_tick) >= 0)
+    {
+        spp_uint32_t idx = s_tick & K_WHEEL_MASK;
+        SPP_Timer_t *p_list;
+
+        if (idx == 0U)
+        {
+            spp_uint32_t level = 1U;
+            while ((level < K_SPP_TIMER_LEVELS) && (wheelCascade(level) == 0U))
+            {
+                level++;
+            }
+        }
+
+        /* Step past the tick before the callbacks run, so a timer they
+         * start for "now" lands on the next tick, not this emptied slot. */
+        slotTake(&s_wheel[0][idx], &p_list);
+        s_tick++;
+        while (p_list != NULL)
+        {
+            SPP_Timer_t *p_timer = p_list;
+            wheelUnlink(p_timer);
+            timerFire(p_timer);
+            fired++;
+        }
+
+        if (s_active == 0U)
+        {
+            wheelSync(nowMs);
+            break;
+        }
+    }
+    return fired;
+}
+
+spp_uint32_t SPP_SERVICES_TIMER_msToNext(void)
+{
+    spp_uint32_t tick = s_tick;
+
+    if (s_active == 0U)
+    {
+        return K_SPP_TIMER_NONE;
+    }
+
+    /* Scan one turn of level 0; stop early at a cascade that may bring an
+     * earlier timer down. */
+    for (; (tick - s_tick) < K_WHEEL_SLOTS; tick++)
+    {
+        spp_uint32_t idx = tick & K_WHEEL_MASK;
+
+        if (s_wheel[0][idx] != NULL)
+        {
+            break;
+        }
+#if K_SPP_TIMER_LEVELS > 1U
+        if (idx == 0U)
+        {
+            spp_uint32_t idx1 = (tick >> K_SPP_TIMER_WHEEL_BITS) & K_WHEEL_MASK;
+
+            if ((idx1 == 0U) || (s_wheel[1][idx1] != NULL))
+            {
+                break;
+            }
+        }
+#endif
+    }
+    return tick - s_nowMs;
+}
+
+SPP_RetVal_t SPP_SERVICES_TIMER_getStats(const SPP_Timer_t *p_timer, SPP_TimerStats_t *p_out)
+{
+    if ((p_timer == NULL) || (p_out == NULL))
+    {
+        SPP_ERR_RETURN(K_SPP_ERROR_NULL_POINTER);
+    }
+
+    *p_out = p_timer->stats;
+    p_out->jitterMeanUs = (p_out->jitterSamples == 0U)
+                              ? 0U
+                              : (spp_uint32_t)(p_timer->jitterAbsSumUs / p_out->jitterSamples);
+    return K_SPP_OK;
+}
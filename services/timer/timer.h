@@ -0,0 +1,210 @@
+/**
+ * @file timer.h
+ * @brief Hierarchical timer wheel for periodic jobs and timeouts.
+ *
+ * Timers are caller-owned @ref SPP_Timer_t objects linked into a wheel of
+ * @ref K_SPP_TIMER_LEVELS levels with 2^@ref K_SPP_TIMER_WHEEL_BITS slots
+ * each, at 1 ms per tick.  Starting, cancelling and expiring a timer are
+ * O(1): a timer sits in the slot of its level until the level below wraps,
+ * then drops one level, at most @ref K_SPP_TIMER_LEVELS - 1 times.
+ *
+ * The wheel is driven from the superloop by @ref SPP_SERVICES_TIMER_run(),
+ * which @ref SPP_SERVICES_callProducers() calls on every pass; callbacks
+ * run there, in superloop context.  None of the functions are ISR-safe.
+ *
+ * Naming conventions used in this file:
+ * - Constants/macros: K_SPP_TIMER_*
+ * - Types: SPP_Timer_t, SPP_TimerStats_t, SPP_TimerCallback_t
+ * - Public functions: SPP_SERVICES_TIMER_*()
+ * - Pointer parameters: p_*
+ */
+
+#ifndef SPP_TIMER_H
+#define SPP_TIMER_H
+
+#include "spp/core/returnTypes.h"
+#include "spp/core/types.h"
+#include "spp/util/macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * Constants
+ * ---------------------------------------------------------------- */
+
+/** @brief Longest delay or period in ms the wheel holds without cascading early. */
+#define K_SPP_TIMER_MAX_MS \
+    (((spp_uint32_t)1U << (K_SPP_TIMER_WHEEL_BITS * K_SPP_TIMER_LEVELS)) - 1U)
+
+/** @brief Returned by @ref SPP_SERVICES_TIMER_msToNext() when no timer is running. */
+#define K_SPP_TIMER_NONE (0xFFFFFFFFU)
+
+/* ----------------------------------------------------------------
+ * Types
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Timer expiry callback.
+ *
+ * Runs inside @ref SPP_SERVICES_TIMER_run().  May start or cancel any
+ * timer, including its own.
+ *
+ * @param[in] p_ctx  Context given to @ref SPP_SERVICES_TIMER_setup().
+ */
+typedef void (*SPP_TimerCallback_t)(void *p_ctx);
+
+/** @brief Timing statistics of one timer, since its setup. */
+typedef struct
+{
+    spp_uint32_t fires;         /**< Callbacks made.                                          */
+    spp_uint32_t skipped;       /**< Periods dropped because a whole period had passed.       */
+    spp_uint32_t lateMaxMs;     /**< Largest delay from the due tick to the callback.         */
+    spp_uint32_t jitterSamples; /**< Intervals measured (fires after the first of a start).   */
+    spp_int32_t  jitterMinUs;   /**< Shortest interval minus its due interval, in µs.         */
+    spp_int32_t  jitterMaxUs;   /**< Longest interval minus its due interval, in µs.          */
+    spp_uint32_t jitterMeanUs;  /**< Mean absolute deviation of the intervals, in µs.         */
+} SPP_TimerStats_t;
+
+/**
+ * @brief A timer.  Allocate statically or in a module context and prepare
+ *        it with @ref SPP_SERVICES_TIMER_setup(); the fields are private.
+ */
+typedef struct SPP_Timer_s
+{
+    struct SPP_Timer_s  *p_next;         /**< Next timer in the same wheel slot.         */
+    struct SPP_Timer_s **pp_prev;        /**< Link pointing at this timer; NULL if idle. */
+    spp_uint32_t         dueMs;          /**< Tick of the next expiry.                   */
+    spp_uint32_t         periodMs;       /**< Reload interval; 0 for a one-shot.         */
+    SPP_TimerCallback_t  callback;
+    void                *p_ctx;
+    spp_bool_t           hasLast;        /**< lastFireUs / lastDueMs are valid.          */
+    spp_uint32_t         lastFireUs;
+    spp_uint32_t         lastDueMs;
+    spp_uint64_t         jitterAbsSumUs;
+    SPP_TimerStats_t     stats;
+} SPP_Timer_t;
+
+/* ----------------------------------------------------------------
+ * API
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Empty the wheel and set its clock to SPP_HAL_getTimeMs().
+ *
+ * Timers still running are forgotten, not called, and must be prepared
+ * again with @ref SPP_SERVICES_TIMER_setup() before reuse.  Without this
+ * call the clock starts at the first @ref SPP_SERVICES_TIMER_advance(), or
+ * at the HAL time of the first @ref SPP_SERVICES_TIMER_start().
+ */
+void SPP_SERVICES_TIMER_init(void);
+
+/**
+ * @brief Prepare a timer: set its callback and clear its statistics.
+ *
+ * @param[out] p_timer   Timer to prepare; must not be running (its memory
+ *                       may be uninitialised).
+ * @param[in]  callback  Called on each expiry.
+ * @param[in]  p_ctx     Passed to @p callback.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_timer or @p callback is NULL.
+ */
+SPP_RetVal_t SPP_SERVICES_TIMER_setup(SPP_Timer_t *p_timer, SPP_TimerCallback_t callback,
+                                      void *p_ctx);
+
+/**
+ * @brief Start or restart a timer.
+ *
+ * The first expiry is @p delayMs after the wheel's current time, the tick
+ * of the last @ref SPP_SERVICES_TIMER_run(); a delay of 0 expires on the
+ * next tick.  A periodic timer then expires every @p periodMs counted from
+ * its due ticks, not from the callbacks, so late callbacks do not add up
+ * to drift; if a whole period passes before the callback runs, the missed
+ * expiries are counted in @c skipped and not made up.
+ *
+ * @param[in,out] p_timer   Prepared timer.
+ * @param[in]     delayMs   Time to the first expiry.
+ * @param[in]     periodMs  Reload interval; 0 for a one-shot.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_timer is NULL.
+ * @return K_SPP_ERROR_NOT_INITIALIZED if @p p_timer has no callback.
+ * @return K_SPP_ERROR_INVALID_PARAMETER if @p delayMs or @p periodMs is
+ *         above @ref K_SPP_TIMER_MAX_MS.
+ */
+SPP_RetVal_t SPP_SERVICES_TIMER_start(SPP_Timer_t *p_timer, spp_uint32_t delayMs,
+                                      spp_uint32_t periodMs);
+
+/**
+ * @brief Stop a timer.  Stopping a timer that is not running is a no-op.
+ *
+ * @param[in,out] p_timer  Timer to stop.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if @p p_timer is NULL.
+ */
+SPP_RetVal_t SPP_SERVICES_TIMER_cancel(SPP_Timer_t *p_timer);
+
+/**
+ * @brief Check whether a timer is running.
+ *
+ * A one-shot stops running just before its callback is called.
+ *
+ * @param[in] p_timer  Timer.
+ *
+ * @return true if @p p_timer will expire again.
+ */
+spp_bool_t SPP_SERVICES_TIMER_isActive(const SPP_Timer_t *p_timer);
+
+/**
+ * @brief Expire every timer due up to SPP_HAL_getTimeMs().
+ *
+ * Same as @ref SPP_SERVICES_TIMER_advance() with the HAL clock.
+ *
+ * @return Number of callbacks made.
+ */
+spp_uint32_t SPP_SERVICES_TIMER_run(void);
+
+/**
+ * @brief Move the wheel's clock forward to @p nowMs, expiring due timers.
+ *
+ * For ports that count their own ticks.  A @p nowMs behind the wheel's
+ * clock is ignored.  Cost is O(1) per elapsed tick plus O(1) per expiry;
+ * with no timer running the clock jumps straight to @p nowMs.
+ *
+ * @param[in] nowMs  Current time in ms, on the same clock as previous calls.
+ *
+ * @return Number of callbacks made.
+ */
+spp_uint32_t SPP_SERVICES_TIMER_advance(spp_uint32_t nowMs);
+
+/**
+ * @brief Time the superloop may sleep before a timer needs it.
+ *
+ * Never later than the next expiry.  When that expiry still sits on a
+ * higher level, the result is the earlier tick at which the wheel
+ * cascades it, or at most 2^@ref K_SPP_TIMER_WHEEL_BITS ms.
+ *
+ * @return Milliseconds from the wheel's current time (at least 1), or
+ *         @ref K_SPP_TIMER_NONE if no timer is running.
+ */
+spp_uint32_t SPP_SERVICES_TIMER_msToNext(void);
+
+/**
+ * @brief Copy a timer's statistics.
+ *
+ * @param[in]  p_timer  Timer.
+ * @param[out] p_out    Receives the statistics.
+ *
+ * @return K_SPP_OK on success.
+ * @return K_SPP_ERROR_NULL_POINTER if either pointer is NULL.
+ */
+SPP_RetVal_t SPP_SERVICES_TIMER_getStats(const SPP_Timer_t *p_timer, SPP_TimerStats_t *p_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPP_TIMER_H */
@@ -0,0 +1,105 @@
+/**
+ * @file bench_databank.c
+ * @brief Host throughput benchmark for the databank free list.
+ *
+ * Built twice by CMake (SPP_BUILD_BENCH=ON): once against the plain stack
+ * and once with SPP_DATABANK_LOCKFREE=1.  Both binaries report the
+ * single-threaded cost of a getPacket()/returnPacket() pair; the lock-free
+ * binary also reports aggregate throughput for 1..N contending threads.
+ *
+ * Usage: spp_bench_databank_<variant> [iterations]
+ */
+
+#include "spp/services/databank/databank.h"
+#include "spp/core/core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if SPP_DATABANK_LOCKFREE
+#include <pthread.h>
+#endif
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_BENCH_DEFAULT_ITERATIONS (5000000UL)
+#define K_BENCH_MAX_THREADS        (8U)
+
+static double nowSec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static void cycle(unsigned long iterations)
+{
+    for (unsigned long i = 0UL; i < iterations; i++)
+    {
+        SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+        if (p_pkt != NULL)
+        {
+            (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+        }
+    }
+}
+
+#if SPP_DATABANK_LOCKFREE
+static void *cycleThread(void *p_arg)
+{
+    cycle(*(const unsigned long *)p_arg);
+    return NULL;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations = (argc > 1) ? strtoul(argv[1], NULL, 10)
+                                          : K_BENCH_DEFAULT_ITERATIONS;
+
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init();
+
+    const char *p_variant = SPP_DATABANK_LOCKFREE ? "lockfree" : "stack";
+
+    double t0 = nowSec();
+    cycle(iterations);
+    double dt = nowSec() - t0;
+
+    printf("variant=%s threads=1 pairs=%lu ns/pair=%.1f Mpairs/s=%.2f\n",
+           p_variant, iterations, (dt * 1e9) / (double)iterations,
+           ((double)iterations / dt) * 1e-6);
+
+#if SPP_DATABANK_LOCKFREE
+    for (unsigned n = 2U; n <= K_BENCH_MAX_THREADS; n *= 2U)
+    {
+        pthread_t threads[K_BENCH_MAX_THREADS];
+        unsigned long perThread = iterations / n;
+
+        t0 = nowSec();
+        for (unsigned t = 0U; t < n; t++)
+        {
+            (void)pthread_create(&threads[t], NULL, cycleThread, &perThread);
+        }
+        for (unsigned t = 0U; t < n; t++)
+        {
+            (void)pthread_join(threads[t], NULL);
+        }
+        dt = nowSec() - t0;
+
+        printf("variant=%s threads=%u pairs=%lu ns/pair=%.1f Mpairs/s=%.2f\n",
+               p_variant, n, perThread * n, (dt * 1e9) / (double)(perThread * n),
+               ((double)(perThread * n) / dt) * 1e-6);
+    }
+
+    if (SPP_SERVICES_DATABANK_freeCount() != K_SPP_DATABANK_SIZE)
+    {
+        printf("ERROR: pool lost packets (%lu free)\n",
+               (unsigned long)SPP_SERVICES_DATABANK_freeCount());
+        return 1;
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * @file bench_pubsub.c
+ * @brief Host throughput and latency benchmark for deferred pub/sub delivery.
+ *
+ * Built twice by CMake (SPP_BUILD_BENCH=ON): once for superloop-only
+ * publishing and once with SPP_PUBSUB_MPSC=1.  Both binaries report
+ * a single thread that publishes and drains in turn; the MPSC binary also
+ * runs 1..N producer threads against one consumer (the main thread).
+ *
+ * Each packet carries its publish timestamp, so the consumer reports the
+ * end-to-end publish-to-handler latency as well as throughput.  Producers
+ * yield while the pool is empty, so on a host with fewer cores than threads
+ * the multi-producer rows mostly measure the consumer.
+ *
+ * The MPSC binary also spreads a CPU-heavy stream over a consumer group of
+ * 1..N members, each handing its packets to a worker thread, and reports
+ * how throughput grows with the number of workers.
+ *
+ * Usage: spp_bench_pubsub_<variant> [packets]
+ *
+ * The default count finishes in seconds on a single core; pass a larger
+ * count on a multi-core host.
+ */
+
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/services/databank/databank.h"
+#include "spp/core/core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if SPP_PUBSUB_MPSC
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_BENCH_DEFAULT_PACKETS (20000UL)
+#define K_BENCH_MAX_THREADS     (4U)
+#define K_BENCH_APID            (0x0020U)
+#define K_BENCH_WORK_ROUNDS     (2000U)
+#define K_BENCH_WORKER_RING     (64U)
+#define K_BENCH_GROUP_DIVISOR   (50UL)
+
+typedef struct
+{
+    unsigned long received;
+    double        latSum;
+    double        latMax;
+} BenchStats_t;
+
+static BenchStats_t s_stats;
+
+static double nowSec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static void benchHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    double stamp;
+    double lat;
+    (void)p_ctx;
+
+    memcpy(&stamp, p_packet->payload, sizeof(stamp));
+    lat = nowSec() - stamp;
+    s_stats.received++;
+    s_stats.latSum += lat;
+    if (lat > s_stats.latMax)
+    {
+        s_stats.latMax = lat;
+    }
+}
+
+/* Returns false when the pool is momentarily empty. */
+static spp_bool_t publishStamped(spp_uint16_t seq)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized((spp_uint16_t)sizeof(double));
+    double        stamp;
+
+    if (p_pkt == NULL)
+    {
+        return false;
+    }
+    spp_uint8_t *p_out = SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_BENCH_APID, seq);
+    stamp = nowSec();
+    memcpy(p_out, &stamp, sizeof(stamp));
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, (spp_uint16_t)sizeof(stamp));
+    (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+    return true;
+}
+
+static void report(const char *p_variant, unsigned threads, unsigned long packets, double dt)
+{
+    unsigned long dropped = packets - s_stats.received; /* Overflow counters saturate. */
+    double        mean    = (s_stats.received > 0UL)
+                                ? (s_stats.latSum / (double)s_stats.received) : 0.0;
+
+    printf("variant=%s threads=%u packets=%lu delivered=%lu dropped=%lu "
+           "Mpkt/s=%.2f lat_mean_ns=%.0f lat_max_us=%.1f\n",
+           p_variant, threads, packets, s_stats.received, dropped,
+           ((double)s_stats.received / dt) * 1e-6, mean * 1e9, s_stats.latMax * 1e6);
+}
+
+static void benchReset(void)
+{
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_BENCH_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        benchHandler, NULL);
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+#if SPP_PUBSUB_MPSC
+static atomic_uint s_running;
+
+static void *producerThread(void *p_arg)
+{
+    unsigned long perThread = *(const unsigned long *)p_arg;
+    spp_uint16_t  seq       = 0U;
+
+    for (unsigned long i = 0UL; i < perThread; i++)
+    {
+        while (!publishStamped(seq))
+        {
+            sched_yield();
+        }
+        seq++;
+    }
+    (void)atomic_fetch_sub(&s_running, 1U);
+    return NULL;
+}
+
+/* Consumer group member: the handler retains the packet and hands it to
+ * its worker thread through a single-producer ring. */
+typedef struct
+{
+    const SPP_Packet_t *ring[K_BENCH_WORKER_RING];
+    atomic_uint         head; /* Written by the consumer (main thread). */
+    atomic_uint         tail; /* Written by the worker.                 */
+    pthread_t           thread;
+    spp_uint32_t        sink;
+} BenchWorker_t;
+
+static BenchWorker_t s_workers[K_BENCH_MAX_THREADS];
+static atomic_uint   s_workersStop;
+
+/* Stand-in for compression or encoding: a hash over the payload, repeated. */
+static spp_uint32_t benchWork(const SPP_Packet_t *p_packet)
+{
+    spp_uint32_t h = 2166136261U;
+
+    for (unsigned r = 0U; r < K_BENCH_WORK_ROUNDS; r++)
+    {
+        for (spp_uint16_t b = 0U; b < p_packet->primaryHeader.payloadLen; b++)
+        {
+            h = (h ^ p_packet->payload[b]) * 16777619U;
+        }
+    }
+    return h;
+}
+
+static void groupHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    BenchWorker_t *p_w  = (BenchWorker_t *)p_ctx;
+    unsigned       head = atomic_load_explicit(&p_w->head, memory_order_relaxed);
+
+    while ((head - atomic_load_explicit(&p_w->tail, memory_order_acquire)) == K_BENCH_WORKER_RING)
+    {
+        sched_yield();
+    }
+    (void)SPP_SERVICES_DATABANK_retain((SPP_Packet_t *)p_packet);
+    p_w->ring[head % K_BENCH_WORKER_RING] = p_packet;
+    atomic_store_explicit(&p_w->head, head + 1U, memory_order_release);
+}
+
+static void *workerThread(void *p_arg)
+{
+    BenchWorker_t *p_w  = (BenchWorker_t *)p_arg;
+    unsigned       tail = 0U;
+
+    for (;;)
+    {
+        if (tail == atomic_load_explicit(&p_w->head, memory_order_acquire))
+        {
+            if (atomic_load(&s_workersStop) != 0U)
+            {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        const SPP_Packet_t *p_packet = p_w->ring[tail % K_BENCH_WORKER_RING];
+        p_w->sink ^= benchWork(p_packet);
+        (void)SPP_SERVICES_DATABANK_release((SPP_Packet_t *)p_packet);
+        tail++;
+        atomic_store_explicit(&p_w->tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+static void groupRun(const char *p_variant, unsigned workers, unsigned long packets)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+    unsigned long       sent = 0UL;
+
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+    atomic_store(&s_workersStop, 0U);
+
+    cfg.apid    = K_BENCH_APID;
+    cfg.prio    = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler = groupHandler;
+    cfg.group   = 1U;
+    for (unsigned w = 0U; w < workers; w++)
+    {
+        memset(&s_workers[w], 0, sizeof(s_workers[w]));
+        cfg.p_ctx = &s_workers[w];
+        (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+        (void)pthread_create(&s_workers[w].thread, NULL, workerThread, &s_workers[w]);
+    }
+
+    double t0 = nowSec();
+    while (sent < packets)
+    {
+        if (publishStamped((spp_uint16_t)sent))
+        {
+            sent++;
+        }
+        else
+        {
+            sched_yield(); /* Pool held by the workers. */
+        }
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    }
+    atomic_store(&s_workersStop, 1U);
+    for (unsigned w = 0U; w < workers; w++)
+    {
+        (void)pthread_join(s_workers[w].thread, NULL);
+    }
+    double dt = nowSec() - t0;
+
+    printf("variant=%s-group workers=%u packets=%lu kpkt/s=%.1f\n",
+           p_variant, workers, packets, ((double)packets / dt) * 1e-3);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    unsigned long packets = (argc > 1) ? strtoul(argv[1], NULL, 10)
+                                       : K_BENCH_DEFAULT_PACKETS;
+
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+
+    const char *p_variant = SPP_PUBSUB_MPSC ? "mpsc" : "ring";
+
+    /* Single thread: publish one, drain one. */
+    benchReset();
+    double t0 = nowSec();
+    for (unsigned long i = 0UL; i < packets; i++)
+    {
+        (void)publishStamped((spp_uint16_t)i);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    }
+    double dt = nowSec() - t0;
+    report(p_variant, 1U, packets, dt);
+
+#if SPP_PUBSUB_MPSC
+    for (unsigned n = 1U; n <= K_BENCH_MAX_THREADS; n *= 2U)
+    {
+        pthread_t     threads[K_BENCH_MAX_THREADS];
+        unsigned long perThread = packets / n;
+
+        benchReset();
+        atomic_store(&s_running, n);
+
+        t0 = nowSec();
+        for (unsigned t = 0U; t < n; t++)
+        {
+            (void)pthread_create(&threads[t], NULL, producerThread, &perThread);
+        }
+        while ((atomic_load(&s_running) != 0U) || (SPP_SERVICES_PUBSUB_queueDepth() != 0U))
+        {
+            (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+        }
+        dt = nowSec() - t0;
+        for (unsigned t = 0U; t < n; t++)
+        {
+            (void)pthread_join(threads[t], NULL);
+        }
+
+        report(p_variant, n + 1U, perThread * n, dt);
+    }
+
+    /* Consumer group: one heavy stream over 1..N worker threads. */
+    for (unsigned n = 1U; n <= K_BENCH_MAX_THREADS; n *= 2U)
+    {
+        groupRun(p_variant, n, packets / K_BENCH_GROUP_DIVISOR);
+    }
+#endif
+
+    if (SPP_SERVICES_DATABANK_freeCount() != K_SPP_DATABANK_SIZE)
+    {
+        printf("ERROR: pool lost packets (%lu free)\n",
+               (unsigned long)SPP_SERVICES_DATABANK_freeCount());
+        return 1;
+    }
+
+    return 0;
+}
@@ -9,9 +9,13 @@
 TestSuite *core_suite(void);
 TestSuite *databank_suite(void);
 TestSuite *db_flow_suite(void);
+TestSuite *segment_suite(void);
+TestSuite *blackboard_suite(void);
+TestSuite *pubsub_suite(void);
 TestSuite *log_suite(void);
 TestSuite *crc_suite(void);
 TestSuite *service_suite(void);
+TestSuite *timer_suite(void);
 
 int main(int argc, char **argv)
 {
@@ -20,9 +24,13 @@ int main(int argc, char **argv)
     add_suite(suite, core_suite());
     add_suite(suite, databank_suite());
     add_suite(suite, db_flow_suite());
+    add_suite(suite, segment_suite());
+    add_suite(suite, blackboard_suite());
+    add_suite(suite, pubsub_suite());
     add_suite(suite, log_suite());
     add_suite(suite, crc_suite());
     add_suite(suite, service_suite());
+    add_suite(suite, timer_suite());
 
     if (argc > 1)
     {
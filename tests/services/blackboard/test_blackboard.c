@@ -0,0 +1,154 @@
+/**
+ * @file test_blackboard.c
+ * @brief BDD unit tests for the latest-value blackboard.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_BLACKBOARD_init() — entry allocation, set size limits
+ *  - SPP_SERVICES_BLACKBOARD_read() — latest value, update count, truncation,
+ *    untracked / not yet published APIDs, no pool or queue usage
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/blackboard/blackboard.h"
+#include "spp/services/databank/databank.h"
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+
+#include <string.h>
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_TEST_BOARD_APID_A (0x0030U)
+#define K_TEST_BOARD_APID_B (0x0031U)
+#define K_TEST_BOARD_APID_X (0x0040U)
+
+static SPP_ApidSet_t s_set;
+
+static SPP_Packet_t *makeValue(spp_uint16_t apid, spp_uint16_t seq, spp_uint16_t len,
+                               spp_uint8_t fill)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(len);
+    void *p_out = SPP_SERVICES_DATABANK_packetBegin(p_pkt, apid, seq);
+    memset(p_out, fill, len);
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, len);
+    return p_pkt;
+}
+
+static void boardSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+
+    memset(&s_set, 0, sizeof(s_set));
+    SPP_SERVICES_PUBSUB_apidSetAdd(&s_set, K_TEST_BOARD_APID_A, K_TEST_BOARD_APID_B);
+    (void)SPP_SERVICES_BLACKBOARD_init(&s_set);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_BLACKBOARD_read
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_BLACKBOARD_read);
+BeforeEach(SPP_SERVICES_BLACKBOARD_read) { boardSetup(); }
+AfterEach(SPP_SERVICES_BLACKBOARD_read)  {}
+
+Ensure(SPP_SERVICES_BLACKBOARD_read, returns_latest_value_without_holding_packets)
+{
+    spp_uint8_t          out[K_SPP_BLACKBOARD_PAYLOAD];
+    spp_uint8_t          expect[7];
+    SPP_BlackboardInfo_t info;
+
+    (void)SPP_SERVICES_PUBSUB_publish(makeValue(K_TEST_BOARD_APID_A, 1U, 12U, 0x11U));
+    (void)SPP_SERVICES_PUBSUB_publish(makeValue(K_TEST_BOARD_APID_B, 9U, 4U, 0x99U));
+    (void)SPP_SERVICES_PUBSUB_publish(makeValue(K_TEST_BOARD_APID_A, 2U, 7U, 0x22U));
+
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_A, out, sizeof(out), &info),
+                is_equal_to(K_SPP_OK));
+    memset(expect, 0x22, sizeof(expect));
+    assert_that(info.len, is_equal_to(7U));
+    assert_that(info.seq, is_equal_to(2U));
+    assert_that(info.updates, is_equal_to(2U));
+    assert_that(memcmp(out, expect, sizeof(expect)), is_equal_to(0));
+
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_B, out, 2U, &info),
+                is_equal_to(K_SPP_OK));
+    assert_that(info.len, is_equal_to(4U));
+    assert_that(info.updates, is_equal_to(1U));
+
+    /* Nothing queued, nothing retained. */
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_BLACKBOARD_read, writes_once_per_apid_for_a_batch)
+{
+    SPP_Packet_t        *p_batch[4];
+    spp_uint8_t          out[K_SPP_BLACKBOARD_PAYLOAD];
+    SPP_BlackboardInfo_t info;
+
+    p_batch[0] = makeValue(K_TEST_BOARD_APID_A, 10U, 4U, 0x01U);
+    p_batch[1] = makeValue(K_TEST_BOARD_APID_A, 11U, 4U, 0x02U);
+    p_batch[2] = makeValue(K_TEST_BOARD_APID_X, 12U, 4U, 0x03U);
+    p_batch[3] = makeValue(K_TEST_BOARD_APID_A, 13U, 4U, 0x04U);
+
+    assert_that(SPP_SERVICES_PUBSUB_publishMany(p_batch, 4U), is_equal_to(K_SPP_OK));
+
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_A, out, sizeof(out), &info),
+                is_equal_to(K_SPP_OK));
+    assert_that(info.seq, is_equal_to(13U));
+    assert_that(info.updates, is_equal_to(1U));
+    assert_that(out[0], is_equal_to(0x04U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_BLACKBOARD_read, rejects_untracked_and_unwritten_apids)
+{
+    spp_uint8_t out[4];
+
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_X, out, sizeof(out), NULL),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_A, out, sizeof(out), NULL),
+                is_equal_to(K_SPP_ERROR));
+    assert_that(SPP_SERVICES_BLACKBOARD_read(K_TEST_BOARD_APID_A, NULL, sizeof(out), NULL),
+                is_equal_to(K_SPP_ERROR_NULL_POINTER));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_BLACKBOARD_init
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_BLACKBOARD_init);
+BeforeEach(SPP_SERVICES_BLACKBOARD_init) { boardSetup(); }
+AfterEach(SPP_SERVICES_BLACKBOARD_init)  {}
+
+Ensure(SPP_SERVICES_BLACKBOARD_init, rejects_empty_or_oversized_sets)
+{
+    SPP_ApidSet_t set;
+
+    memset(&set, 0, sizeof(set));
+    assert_that(SPP_SERVICES_BLACKBOARD_init(&set), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+
+    SPP_SERVICES_PUBSUB_apidSetAdd(&set, 0x0100U,
+                                   (spp_uint16_t)(0x0100U + K_SPP_BLACKBOARD_ENTRIES));
+    assert_that(SPP_SERVICES_BLACKBOARD_init(&set), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_BLACKBOARD_init(NULL), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+}
+
+/* ----------------------------------------------------------------
+ * Suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *blackboard_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("blackboard");
+
+    add_test_with_context(suite, SPP_SERVICES_BLACKBOARD_read, returns_latest_value_without_holding_packets);
+    add_test_with_context(suite, SPP_SERVICES_BLACKBOARD_read, writes_once_per_apid_for_a_batch);
+    add_test_with_context(suite, SPP_SERVICES_BLACKBOARD_read, rejects_untracked_and_unwritten_apids);
+
+    add_test_with_context(suite, SPP_SERVICES_BLACKBOARD_init, rejects_empty_or_oversized_sets);
+
+    return suite;
+}
@@ -0,0 +1,551 @@
+/**
+ * @file test_databank.c
+ * @brief BDD unit tests for the static packet pool.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_DATABANK_getPacket()    — drains the pool, NULL when empty
+ *  - SPP_SERVICES_DATABANK_getPacketSized() — smallest fitting class, upward fallback
+ *  - SPP_SERVICES_DATABANK_returnPacket() — NULL / foreign / double-return guards
+ *  - SPP_SERVICES_DATABANK_retain/release() — packet survives until last release
+ *  - SPP_SERVICES_DATABANK_getPacketFor() — per-APID quota, reservation, counters
+ *  - SPP_SERVICES_DATABANK_packetData()   — header fill, per-class length check
+ *  - SPP_SERVICES_DATABANK_packetBegin/Commit() — in-place build, CRC over used bytes
+ *  - SPP_SERVICES_DATABANK_leakReport()   — owner / state / age of held slots
+ *  - Concurrency (SPP_DATABANK_LOCKFREE=1 only) — no lost or duplicated
+ *    packets under many concurrent producers / consumers
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/databank/databank.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+#include "spp/util/crc.h"
+
+#include <stdlib.h>
+
+#if SPP_DATABANK_LOCKFREE
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+static void databankSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init(); /* Idempotent across tests. */
+}
+
+/* Drain the whole pool into p_out; returns how many packets were taken. */
+static spp_uint32_t drainPool(SPP_Packet_t **p_out)
+{
+    spp_uint32_t n = 0U;
+    SPP_Packet_t *p_pkt;
+
+    while ((p_pkt = SPP_SERVICES_DATABANK_getPacketSized(0U)) != NULL)
+    {
+        p_out[n++] = p_pkt;
+    }
+    return n;
+}
+
+static void refillPool(SPP_Packet_t **p_pkts, spp_uint32_t n)
+{
+    for (spp_uint32_t i = 0U; i < n; i++)
+    {
+        (void)SPP_SERVICES_DATABANK_returnPacket(p_pkts[i]);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_getPacket
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_getPacket);
+BeforeEach(SPP_SERVICES_DATABANK_getPacket) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_getPacket)  {}
+
+Ensure(SPP_SERVICES_DATABANK_getPacket, hands_out_every_slot_once_then_null)
+{
+    static SPP_Packet_t *s_pkts[K_SPP_DATABANK_SIZE];
+    spp_uint32_t n = drainPool(s_pkts);
+
+    assert_that(n, is_equal_to(K_SPP_DATABANK_SIZE));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_getPacketSized(0U), is_null);
+
+    for (spp_uint32_t i = 0U; i < n; i++)
+    {
+        for (spp_uint32_t j = i + 1U; j < n; j++)
+        {
+            assert_that(s_pkts[i], is_not_equal_to(s_pkts[j]));
+        }
+    }
+
+    refillPool(s_pkts, n);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_getPacketSized
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_getPacketSized);
+BeforeEach(SPP_SERVICES_DATABANK_getPacketSized) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_getPacketSized)  {}
+
+Ensure(SPP_SERVICES_DATABANK_getPacketSized, picks_smallest_fitting_class)
+{
+    SPP_Packet_t *p_small  = SPP_SERVICES_DATABANK_getPacketSized(12U);
+    SPP_Packet_t *p_medium = SPP_SERVICES_DATABANK_getPacketSized(K_SPP_DATABANK_SMALL_PAYLOAD + 1U);
+    SPP_Packet_t *p_large  = SPP_SERVICES_DATABANK_getPacketSized(K_SPP_DATABANK_LARGE_PAYLOAD);
+
+    assert_that(SPP_SERVICES_DATABANK_payloadCapacity(p_small),
+                is_equal_to(K_SPP_DATABANK_SMALL_PAYLOAD));
+    assert_that(SPP_SERVICES_DATABANK_payloadCapacity(p_medium),
+                is_equal_to(K_SPP_DATABANK_MEDIUM_PAYLOAD));
+    assert_that(SPP_SERVICES_DATABANK_payloadCapacity(p_large),
+                is_equal_to(K_SPP_DATABANK_LARGE_PAYLOAD));
+    assert_that(SPP_SERVICES_DATABANK_getPacketSized(K_SPP_DATABANK_LARGE_PAYLOAD + 1U), is_null);
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_small);
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_medium);
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_large);
+}
+
+Ensure(SPP_SERVICES_DATABANK_getPacketSized, falls_back_upward_when_class_is_empty)
+{
+    static SPP_Packet_t *s_small[K_SPP_DATABANK_SMALL_COUNT];
+
+    for (spp_uint32_t i = 0U; i < K_SPP_DATABANK_SMALL_COUNT; i++)
+    {
+        s_small[i] = SPP_SERVICES_DATABANK_getPacketSized(1U);
+        assert_that(SPP_SERVICES_DATABANK_payloadCapacity(s_small[i]),
+                    is_equal_to(K_SPP_DATABANK_SMALL_PAYLOAD));
+    }
+
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(1U);
+    assert_that(SPP_SERVICES_DATABANK_payloadCapacity(p_pkt),
+                is_equal_to(K_SPP_DATABANK_MEDIUM_PAYLOAD));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+    refillPool(s_small, K_SPP_DATABANK_SMALL_COUNT);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_getPacketFor
+ *
+ * The quota table outlives each test, so every test restores its APID to
+ * "no reserve, unlimited" before returning.
+ * ---------------------------------------------------------------- */
+
+#define K_TEST_QUOTA_APID (0x0008U)
+
+Describe(SPP_SERVICES_DATABANK_getPacketFor);
+BeforeEach(SPP_SERVICES_DATABANK_getPacketFor) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_getPacketFor)
+{
+    (void)SPP_SERVICES_DATABANK_setQuota(K_TEST_QUOTA_APID, 0U, K_SPP_DATABANK_QUOTA_UNLIMITED);
+}
+
+Ensure(SPP_SERVICES_DATABANK_getPacketFor, refuses_apid_at_quota_and_counts_it)
+{
+    assert_that(SPP_SERVICES_DATABANK_setQuota(K_TEST_QUOTA_APID, 0U, 2U), is_equal_to(K_SPP_OK));
+    spp_uint32_t before = SPP_SERVICES_DATABANK_exhaustedCount(K_TEST_QUOTA_APID);
+
+    SPP_Packet_t *p_a = SPP_SERVICES_DATABANK_getPacketFor(K_TEST_QUOTA_APID, 4U);
+    SPP_Packet_t *p_b = SPP_SERVICES_DATABANK_getPacketFor(K_TEST_QUOTA_APID, 4U);
+    assert_that(p_b, is_non_null);
+    assert_that(SPP_SERVICES_DATABANK_getPacketFor(K_TEST_QUOTA_APID, 4U), is_null);
+    assert_that(SPP_SERVICES_DATABANK_exhaustedCount(K_TEST_QUOTA_APID), is_equal_to(before + 1U));
+
+    /* Releasing one gives the APID room again. */
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_a);
+    p_a = SPP_SERVICES_DATABANK_getPacketFor(K_TEST_QUOTA_APID, 4U);
+    assert_that(p_a, is_non_null);
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_a);
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_b);
+}
+
+Ensure(SPP_SERVICES_DATABANK_getPacketFor, keeps_reservation_from_other_apids)
+{
+    static SPP_Packet_t *s_pkts[K_SPP_DATABANK_SIZE];
+    SPP_Packet_t *p_reserved[3];
+
+    assert_that(SPP_SERVICES_DATABANK_setQuota(K_TEST_QUOTA_APID, 3U, K_SPP_DATABANK_QUOTA_UNLIMITED),
+                is_equal_to(K_SPP_OK));
+
+    /* A storm from unconfigured APIDs cannot take the last 3 packets... */
+    spp_uint32_t n = drainPool(s_pkts);
+    assert_that(n, is_equal_to(K_SPP_DATABANK_SIZE - 3U));
+
+    /* ...which stay available to the reserving APID. */
+    for (spp_uint32_t i = 0U; i < 3U; i++)
+    {
+        p_reserved[i] = SPP_SERVICES_DATABANK_getPacketFor(K_TEST_QUOTA_APID, 0U);
+        assert_that(p_reserved[i], is_non_null);
+    }
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(0U));
+
+    refillPool(p_reserved, 3U);
+    refillPool(s_pkts, n);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_DATABANK_getPacketFor, set_quota_rejects_invalid_limits)
+{
+    assert_that(SPP_SERVICES_DATABANK_setQuota(K_SPP_APID_NONE, 0U, 1U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_DATABANK_setQuota(K_TEST_QUOTA_APID, 3U, 2U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_DATABANK_setQuota(K_TEST_QUOTA_APID, K_SPP_DATABANK_SIZE + 1U,
+                                               K_SPP_DATABANK_QUOTA_UNLIMITED),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_returnPacket
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_returnPacket);
+BeforeEach(SPP_SERVICES_DATABANK_returnPacket) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_returnPacket)  {}
+
+Ensure(SPP_SERVICES_DATABANK_returnPacket, rejects_null_pointer)
+{
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(NULL),
+                is_equal_to(K_SPP_ERROR_NULL_POINTER));
+}
+
+Ensure(SPP_SERVICES_DATABANK_returnPacket, rejects_packet_outside_pool)
+{
+    static SPP_Packet_t s_foreign;
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(&s_foreign), is_equal_to(K_SPP_ERROR));
+}
+
+Ensure(SPP_SERVICES_DATABANK_returnPacket, rejects_pointer_into_middle_of_slot)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+    SPP_Packet_t *p_bad = (SPP_Packet_t *)(void *)((char *)p_pkt + 2);
+
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(p_bad), is_equal_to(K_SPP_ERROR));
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(p_pkt), is_equal_to(K_SPP_OK));
+}
+
+Ensure(SPP_SERVICES_DATABANK_returnPacket, rejects_double_return)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(p_pkt), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(p_pkt),
+                is_equal_to(K_SPP_ERROR_ALREADY_INITIALIZED));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_retain / release
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_retain);
+BeforeEach(SPP_SERVICES_DATABANK_retain) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_retain)  {}
+
+Ensure(SPP_SERVICES_DATABANK_retain, keeps_packet_out_of_pool_until_last_release)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+
+    assert_that(SPP_SERVICES_DATABANK_retain(p_pkt), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_DATABANK_refCount(p_pkt), is_equal_to(2U));
+
+    assert_that(SPP_SERVICES_DATABANK_returnPacket(p_pkt), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE - 1U));
+
+    assert_that(SPP_SERVICES_DATABANK_release(p_pkt), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_DATABANK_refCount(p_pkt), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+    assert_that(SPP_SERVICES_DATABANK_release(p_pkt),
+                is_equal_to(K_SPP_ERROR_ALREADY_INITIALIZED));
+}
+
+Ensure(SPP_SERVICES_DATABANK_retain, rejects_free_packet)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+
+    assert_that(SPP_SERVICES_DATABANK_retain(p_pkt), is_equal_to(K_SPP_ERROR));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_packetData
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_packetData);
+BeforeEach(SPP_SERVICES_DATABANK_packetData) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_packetData)  {}
+
+Ensure(SPP_SERVICES_DATABANK_packetData, fills_headers_and_crc)
+{
+    const spp_uint8_t data[4] = { 1U, 2U, 3U, 4U };
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+
+    assert_that(SPP_SERVICES_DATABANK_packetData(p_pkt, 0x0004U, 7U, data, sizeof(data)),
+                is_equal_to(K_SPP_OK));
+    assert_that(p_pkt->primaryHeader.version, is_equal_to(K_SPP_PKT_VERSION));
+    assert_that(p_pkt->primaryHeader.apid, is_equal_to(0x0004U));
+    assert_that(p_pkt->primaryHeader.seq, is_equal_to(7U));
+    assert_that(p_pkt->primaryHeader.payloadLen, is_equal_to(sizeof(data)));
+    assert_that(p_pkt->payload[3], is_equal_to(4U));
+    assert_that(p_pkt->crc, is_not_equal_to(0U));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+Ensure(SPP_SERVICES_DATABANK_packetData, rejects_payload_larger_than_class)
+{
+    static spp_uint8_t s_big[K_SPP_DATABANK_SMALL_PAYLOAD + 1U];
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(1U);
+
+    assert_that(SPP_SERVICES_DATABANK_packetData(p_pkt, 0x0004U, 0U, s_big, sizeof(s_big)),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_packetBegin / packetCommit
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_packetCommit);
+BeforeEach(SPP_SERVICES_DATABANK_packetCommit) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_packetCommit)  {}
+
+Ensure(SPP_SERVICES_DATABANK_packetCommit, builds_in_place_with_crc_over_used_bytes)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(3U * sizeof(float));
+    float *p_out = (float *)SPP_SERVICES_DATABANK_packetBegin(p_pkt, 0x0004U, 9U);
+
+    assert_that(((uintptr_t)p_out % 4U), is_equal_to(0U));
+    p_out[0] = 1.0f;
+    p_out[1] = 2.0f;
+    p_out[2] = 3.0f;
+    assert_that(SPP_SERVICES_DATABANK_packetCommit(p_pkt, 3U * sizeof(float)),
+                is_equal_to(K_SPP_OK));
+
+    spp_uint16_t crc = SPP_UTIL_crc16((const spp_uint8_t *)p_pkt,
+                                      (spp_uint32_t)offsetof(SPP_Packet_t, crc));
+    crc = SPP_UTIL_crc16Update(crc, p_pkt->payload, 3U * sizeof(float));
+
+    assert_that(p_pkt->primaryHeader.apid, is_equal_to(0x0004U));
+    assert_that(p_pkt->primaryHeader.seq, is_equal_to(9U));
+    assert_that(p_pkt->primaryHeader.payloadLen, is_equal_to(3U * sizeof(float)));
+    assert_that(p_pkt->crc, is_equal_to(crc));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+Ensure(SPP_SERVICES_DATABANK_packetCommit, rejects_length_beyond_capacity)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(1U);
+
+    (void)SPP_SERVICES_DATABANK_packetBegin(p_pkt, 0x0004U, 0U);
+    assert_that(SPP_SERVICES_DATABANK_packetCommit(p_pkt, K_SPP_DATABANK_SMALL_PAYLOAD + 1U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATABANK_leakReport
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATABANK_leakReport);
+BeforeEach(SPP_SERVICES_DATABANK_leakReport) { databankSetup(); }
+AfterEach(SPP_SERVICES_DATABANK_leakReport)  {}
+
+Ensure(SPP_SERVICES_DATABANK_leakReport, lists_held_packets_with_owner_and_state)
+{
+    const spp_uint8_t data[2] = { 0xAAU, 0x55U };
+    SPP_DatabankLeak_t leaks[4];
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+
+    (void)SPP_SERVICES_DATABANK_packetData(p_pkt, 0x0004U, 0U, data, sizeof(data));
+
+    assert_that(SPP_SERVICES_DATABANK_leakReport(0U, leaks, 4U), is_equal_to(1U));
+    assert_that(leaks[0].p_packet, is_equal_to(p_pkt));
+    assert_that(leaks[0].ownerApid, is_equal_to(0x0004U));
+    assert_that(leaks[0].state, is_equal_to(K_SPP_DATABANK_SLOT_ACQUIRED));
+
+    assert_that(SPP_SERVICES_DATABANK_markQueued(p_pkt), is_equal_to(K_SPP_OK));
+    (void)SPP_SERVICES_DATABANK_leakReport(0U, leaks, 4U);
+    assert_that(leaks[0].state, is_equal_to(K_SPP_DATABANK_SLOT_QUEUED));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+    assert_that(SPP_SERVICES_DATABANK_leakReport(0U, leaks, 4U), is_equal_to(0U));
+}
+
+Ensure(SPP_SERVICES_DATABANK_leakReport, ignores_packets_younger_than_threshold)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+
+    assert_that(SPP_SERVICES_DATABANK_leakReport(60000U, NULL, 0U), is_equal_to(0U));
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+Ensure(SPP_SERVICES_DATABANK_leakReport, mark_queued_rejects_free_packet)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacket();
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+
+    assert_that(SPP_SERVICES_DATABANK_markQueued(p_pkt), is_equal_to(K_SPP_ERROR));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: concurrency (lock-free build only)
+ * ---------------------------------------------------------------- */
+
+#if SPP_DATABANK_LOCKFREE
+
+#define K_STRESS_THREADS    (8U)
+#define K_STRESS_ITERATIONS (20000U)
+#define K_STRESS_HOLD       (4U)
+
+static SPP_Packet_t *s_slots[K_SPP_DATABANK_SIZE];
+static atomic_uint   s_owners[K_SPP_DATABANK_SIZE];
+static atomic_uint   s_duplicates;
+static atomic_uint   s_badReturns;
+
+static int slotCompare(const void *p_a, const void *p_b)
+{
+    const SPP_Packet_t *a = *(SPP_Packet_t *const *)p_a;
+    const SPP_Packet_t *b = *(SPP_Packet_t *const *)p_b;
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static spp_uint32_t slotIndex(const SPP_Packet_t *p_pkt)
+{
+    SPP_Packet_t *const *pp = bsearch(&p_pkt, s_slots, K_SPP_DATABANK_SIZE,
+                                      sizeof(s_slots[0]), slotCompare);
+    return (spp_uint32_t)(pp - s_slots);
+}
+
+/* Each worker repeatedly grabs a few packets, proves it is their only
+ * owner, and hands them back. */
+static void *stressWorker(void *p_arg)
+{
+    SPP_Packet_t *held[K_STRESS_HOLD];
+    (void)p_arg;
+
+    for (spp_uint32_t it = 0U; it < K_STRESS_ITERATIONS; it++)
+    {
+        spp_uint32_t n = 0U;
+
+        for (spp_uint32_t k = 0U; k < K_STRESS_HOLD; k++)
+        {
+            /* Mix sizes so every class's free list is contended. */
+            SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(
+                (spp_uint16_t)(k * K_SPP_DATABANK_SMALL_PAYLOAD));
+            if (p_pkt == NULL) break;
+            if (atomic_fetch_add(&s_owners[slotIndex(p_pkt)], 1U) != 0U)
+            {
+                atomic_fetch_add(&s_duplicates, 1U);
+            }
+            held[n++] = p_pkt;
+        }
+
+        for (spp_uint32_t k = 0U; k < n; k++)
+        {
+            (void)atomic_fetch_sub(&s_owners[slotIndex(held[k])], 1U);
+            if (SPP_SERVICES_DATABANK_returnPacket(held[k]) != K_SPP_OK)
+            {
+                atomic_fetch_add(&s_badReturns, 1U);
+            }
+        }
+    }
+    return NULL;
+}
+
+Describe(SPP_SERVICES_DATABANK_lockfree);
+BeforeEach(SPP_SERVICES_DATABANK_lockfree)
+{
+    databankSetup();
+    spp_uint32_t n = drainPool(s_slots);
+    refillPool(s_slots, n);
+    qsort(s_slots, n, sizeof(s_slots[0]), slotCompare);
+}
+AfterEach(SPP_SERVICES_DATABANK_lockfree) {}
+
+Ensure(SPP_SERVICES_DATABANK_lockfree, no_lost_or_duplicated_packets_under_contention)
+{
+    pthread_t threads[K_STRESS_THREADS];
+    static SPP_Packet_t *s_after[K_SPP_DATABANK_SIZE];
+
+    for (spp_uint32_t t = 0U; t < K_STRESS_THREADS; t++)
+    {
+        (void)pthread_create(&threads[t], NULL, stressWorker, NULL);
+    }
+    for (spp_uint32_t t = 0U; t < K_STRESS_THREADS; t++)
+    {
+        (void)pthread_join(threads[t], NULL);
+    }
+
+    assert_that(atomic_load(&s_duplicates), is_equal_to(0U));
+    assert_that(atomic_load(&s_badReturns), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    /* Every slot must still be reachable exactly once. */
+    spp_uint32_t n = drainPool(s_after);
+    assert_that(n, is_equal_to(K_SPP_DATABANK_SIZE));
+    qsort(s_after, n, sizeof(s_after[0]), slotCompare);
+    for (spp_uint32_t i = 0U; i < n; i++)
+    {
+        assert_that(s_after[i], is_equal_to(s_slots[i]));
+    }
+    refillPool(s_after, n);
+}
+
+#endif /* SPP_DATABANK_LOCKFREE */
+
+/* ----------------------------------------------------------------
+ * Test suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *databank_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("databank");
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacket, hands_out_every_slot_once_then_null);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacketSized, picks_smallest_fitting_class);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacketSized, falls_back_upward_when_class_is_empty);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacketFor, refuses_apid_at_quota_and_counts_it);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacketFor, keeps_reservation_from_other_apids);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_getPacketFor, set_quota_rejects_invalid_limits);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_returnPacket, rejects_null_pointer);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_returnPacket, rejects_packet_outside_pool);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_returnPacket, rejects_pointer_into_middle_of_slot);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_returnPacket, rejects_double_return);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_retain, keeps_packet_out_of_pool_until_last_release);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_retain, rejects_free_packet);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_packetData, fills_headers_and_crc);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_packetData, rejects_payload_larger_than_class);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_packetCommit, builds_in_place_with_crc_over_used_bytes);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_packetCommit, rejects_length_beyond_capacity);
+
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_leakReport, lists_held_packets_with_owner_and_state);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_leakReport, ignores_packets_younger_than_threshold);
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_leakReport, mark_queued_rejects_free_packet);
+
+#if SPP_DATABANK_LOCKFREE
+    add_test_with_context(suite, SPP_SERVICES_DATABANK_lockfree, no_lost_or_duplicated_packets_under_contention);
+#endif
+
+    return suite;
+}
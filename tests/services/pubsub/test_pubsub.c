@@ -0,0 +1,1257 @@
+/**
+ * @file test_pubsub.c
+ * @brief BDD unit tests for the publish-subscribe router.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_PUBSUB_subscribe()            — argument checks, queued
+ *    packets keep their subscriber set
+ *  - SPP_SERVICES_PUBSUB_subscribeEx()          — decimation and rate limit
+ *    filter before queueing; APID ranges and sets, route block limit;
+ *    consumer groups, round-robin and least-loaded
+ *  - SPP_SERVICES_PUBSUB_publish()              — routing by APID,
+ *    wildcard subscribers, priority order; publishMany() chunking and
+ *    batch SYNC handlers
+ *  - SPP_SERVICES_PUBSUB_setOverflowPolicy()    — drop-oldest, drop-lowest,
+ *    coalesce-latest and their counters
+ *  - SPP_SERVICES_PUBSUB_callConsumers()        — HIGH latency independent of
+ *    a backlogged LOW subscriber; earliest-deadline-first order, misses;
+ *    batch subscribers take the packets waiting for them, up to batchMax;
+ *    packets past the subscriber or APID TTL are skipped and counted
+ *  - SPP_SERVICES_PUBSUB_callConsumersBudget()  — count budget, time budget,
+ *    whole pool queued at two levels without a limit, full drain returns
+ *    every packet to the databank
+ *  - SPP_SERVICES_PUBSUB_setSpill()            — no loss and publish order
+ *    kept under a sustained 2x overload burst; subscribe refused meanwhile
+ *  - SPP_SERVICES_PUBSUB_subscriberStats() / apidStats() — wait, run and
+ *    lifetime histograms, percentile lookup
+ *  - Concurrency (SPP_PUBSUB_MPSC=1 only) — every packet published from
+ *    many threads is either delivered once or counted as overflow
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/services/databank/databank.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+#include "spp/hal/time.h"
+
+#include <stdio.h>
+
+#if SPP_PUBSUB_MPSC
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_TEST_PUBSUB_APID (0x0020U)
+#define K_TEST_OTHER_APID  (0x0040U)
+#define K_TEST_HIGH_APID   (0x07F0U)
+#define K_TEST_MAX_TRACE   (16U)
+#define K_TEST_QUEUE_LIMIT (16U)
+
+static spp_uint32_t s_calls;
+static spp_uint32_t s_spinUs;
+static spp_uint32_t s_highSeen;
+static spp_uint16_t s_seqSeen[2U * K_TEST_QUEUE_LIMIT];
+static spp_uint32_t s_seqCount;
+static char         s_trace[K_TEST_MAX_TRACE + 1U];
+static spp_uint32_t s_traceLen;
+static spp_uint32_t s_batchCalls;
+static spp_uint32_t s_batchPackets;
+static spp_bool_t   s_batchOrdered;
+
+/* Appends the one-character tag passed as p_ctx, to check who ran and when. */
+static void tracingHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_packet;
+    if (s_traceLen < K_TEST_MAX_TRACE)
+    {
+        s_trace[s_traceLen++] = *(const char *)p_ctx;
+        s_trace[s_traceLen]   = '\0';
+    }
+}
+
+static void countingHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_packet;
+    (void)p_ctx;
+    s_calls++;
+
+    if (s_spinUs != 0U)
+    {
+        spp_uint32_t start = SPP_HAL_getTimeUs();
+        while ((SPP_HAL_getTimeUs() - start) < s_spinUs)
+        { /* busy-wait */
+        }
+    }
+}
+
+static void highHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_packet;
+    (void)p_ctx;
+    s_highSeen++;
+}
+
+static void seqHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_ctx;
+    if (s_seqCount < (2U * K_TEST_QUEUE_LIMIT))
+    {
+        s_seqSeen[s_seqCount++] = p_packet->primaryHeader.seq;
+    }
+}
+
+/* Counts calls and packets, and checks each batch arrives in seq order. */
+static void batchHandler(const SPP_Packet_t *const *pp_packets, spp_uint16_t count, void *p_ctx)
+{
+    (void)p_ctx;
+    s_batchCalls++;
+    for (spp_uint16_t k = 1U; k < count; k++)
+    {
+        if (pp_packets[k]->primaryHeader.seq <= pp_packets[k - 1U]->primaryHeader.seq)
+        {
+            s_batchOrdered = false;
+        }
+    }
+    s_batchPackets += count;
+}
+
+static void pubsubSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+    s_calls    = 0U;
+    s_spinUs   = 0U;
+    s_highSeen = 0U;
+    s_seqCount = 0U;
+    s_traceLen = 0U;
+    s_trace[0] = '\0';
+
+    s_batchCalls   = 0U;
+    s_batchPackets = 0U;
+    s_batchOrdered = true;
+}
+
+static SPP_Packet_t *makePacket(spp_uint16_t apid, spp_uint16_t seq)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(4U);
+    (void)SPP_SERVICES_DATABANK_packetBegin(p_pkt, apid, seq);
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, 4U);
+    return p_pkt;
+}
+
+static void publishApid(spp_uint16_t apid, spp_uint16_t seq)
+{
+    (void)SPP_SERVICES_PUBSUB_publish(makePacket(apid, seq));
+}
+
+static void publishN(spp_uint32_t n)
+{
+    for (spp_uint32_t i = 0U; i < n; i++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, (spp_uint16_t)i);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_subscribe
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_subscribe);
+BeforeEach(SPP_SERVICES_PUBSUB_subscribe) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_subscribe)  {}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribe, rejects_null_handler)
+{
+    assert_that(SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                              NULL, NULL),
+                is_equal_to(K_SPP_ERROR_NULL_POINTER));
+    assert_that(SPP_SERVICES_PUBSUB_subscriberCount(), is_equal_to(0U));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribe, leaves_queued_packets_with_their_subscribers)
+{
+    static const char k_a = 'a';
+    static const char k_b = 'b';
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        tracingHandler, (void *)&k_a);
+    publishN(1U);
+
+    /* Inserted ahead of 'a' in the table; must not run for the queued packet. */
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_HIGH,
+                                        tracingHandler, (void *)&k_b);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+
+    assert_that(s_trace, is_equal_to_string("a"));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_subscribeEx
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_subscribeEx);
+BeforeEach(SPP_SERVICES_PUBSUB_subscribeEx) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_subscribeEx)
+{
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribeEx, decimation_skips_packets_before_queueing)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    cfg.apid       = K_TEST_PUBSUB_APID;
+    cfg.prio       = K_SPP_PUBSUB_PRIO_LOW;
+    cfg.handler    = seqHandler;
+    cfg.decimation = 3U;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_OK));
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+
+    publishN(9U);
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_LOW), is_equal_to(3U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_NORMAL), is_equal_to(9U));
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_calls, is_equal_to(9U));
+    assert_that(s_seqCount, is_equal_to(3U));
+    assert_that(s_seqSeen[0], is_equal_to(0U));
+    assert_that(s_seqSeen[1], is_equal_to(3U));
+    assert_that(s_seqSeen[2], is_equal_to(6U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribeEx, rate_limit_delivers_at_most_one_per_period)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+    spp_uint32_t        start;
+
+    cfg.apid        = K_TEST_PUBSUB_APID;
+    cfg.prio        = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler     = countingHandler;
+    cfg.minPeriodMs = 20U;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_OK));
+
+    publishN(5U);
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(1U));
+
+    start = SPP_HAL_getTimeMs();
+    while ((SPP_HAL_getTimeMs() - start) <= cfg.minPeriodMs)
+    { /* busy-wait past the period */
+    }
+    publishN(1U);
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(2U));
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_calls, is_equal_to(2U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribeEx, routes_ranges_across_pages_and_limits_route_blocks)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+    spp_uint8_t         page;
+
+    cfg.apid     = (spp_uint16_t)(K_TEST_HIGH_APID - 60U); /* Spans three pages. */
+    cfg.apidLast = K_TEST_HIGH_APID;
+    cfg.prio     = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler  = countingHandler;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_OK));
+
+    publishApid((spp_uint16_t)(K_TEST_HIGH_APID - 61U), 0U);
+    publishApid((spp_uint16_t)(K_TEST_HIGH_APID - 60U), 1U);
+    publishApid((spp_uint16_t)(K_TEST_HIGH_APID - 30U), 2U);
+    publishApid(K_TEST_HIGH_APID, 3U);
+    publishApid((spp_uint16_t)(K_TEST_HIGH_APID + 1U), 4U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_calls, is_equal_to(3U));
+
+    cfg.apidLast = (spp_uint16_t)(K_SPP_APID_MAX + 1U);
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+
+    /* One APID per page: each needs its own block until they run out. */
+    cfg.apidLast = 0U;
+    for (page = 0U; page < (K_SPP_PUBSUB_ROUTE_BLOCKS - 2U); page++)
+    {
+        cfg.apid = (spp_uint16_t)((page * 32U) + 1U);
+        assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_OK));
+    }
+    cfg.apid = (spp_uint16_t)((page * 32U) + 1U);
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribeEx, consumer_group_gives_each_packet_to_one_member)
+{
+    static const char   k_a = 'a';
+    static const char   k_b = 'b';
+    static const char   k_c = 'c';
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    cfg.apid    = K_TEST_PUBSUB_APID;
+    cfg.prio    = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler = tracingHandler;
+    cfg.group   = 1U;
+    cfg.p_ctx   = (void *)&k_a;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    cfg.p_ctx = (void *)&k_b;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    cfg.p_ctx = (void *)&k_c;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+
+    /* Round-robin over the members; subscribers outside the group still
+     * see every packet. */
+    publishN(6U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_trace, is_equal_to_string("abcabc"));
+    assert_that(s_calls, is_equal_to(6U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    cfg.group = (spp_uint8_t)(K_SPP_PUBSUB_MAX_GROUPS + 1U);
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    cfg.group = 1U;
+    cfg.prio  = K_SPP_PUBSUB_PRIO_SYNC;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_setGroupMode(0U, K_SPP_PUBSUB_GROUP_ROUND_ROBIN),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_setGroupMode(1U, K_SPP_PUBSUB_GROUP_MODES),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+}
+
+/* x serves the group at HIGH, y at LOW; one dispatch after the first and
+ * third publish.  s_trace records who handled what, in order. */
+static void groupLoadRun(spp_uint8_t mode)
+{
+    static const char   k_x = 'x';
+    static const char   k_y = 'y';
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    cfg.apid    = K_TEST_PUBSUB_APID;
+    cfg.handler = tracingHandler;
+    cfg.group   = 2U;
+    cfg.prio    = K_SPP_PUBSUB_PRIO_HIGH;
+    cfg.p_ctx   = (void *)&k_x;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    cfg.prio  = K_SPP_PUBSUB_PRIO_LOW;
+    cfg.p_ctx = (void *)&k_y;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_setGroupMode(2U, mode);
+
+    for (spp_uint16_t k = 0U; k < 4U; k++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, k);
+        if ((k == 0U) || (k == 2U))
+        {
+            (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        }
+    }
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_subscribeEx, least_loaded_group_favours_the_member_that_keeps_up)
+{
+    /* Round-robin alternates regardless of y's backlog ... */
+    groupLoadRun(K_SPP_PUBSUB_GROUP_ROUND_ROBIN);
+    assert_that(s_trace, is_equal_to_string("xxyy"));
+
+    /* ... least-loaded sends the last packet to x, whose queue is empty. */
+    pubsubSetup();
+    groupLoadRun(K_SPP_PUBSUB_GROUP_LEAST_LOADED);
+    assert_that(s_trace, is_equal_to_string("xxxy"));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_publish
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_publish);
+BeforeEach(SPP_SERVICES_PUBSUB_publish) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_publish)
+{
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_publish, routes_by_apid_in_priority_order)
+{
+    static const char k_s = 's';
+    static const char k_h = 'h';
+    static const char k_l = 'l';
+    static const char k_w = 'w';
+    static const char k_o = 'o';
+    SPP_ApidSet_t       set = { 0 };
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    SPP_SERVICES_PUBSUB_apidSetAdd(&set, K_TEST_PUBSUB_APID, K_TEST_PUBSUB_APID);
+    SPP_SERVICES_PUBSUB_apidSetAdd(&set, K_TEST_OTHER_APID, K_TEST_OTHER_APID);
+    cfg.p_apidSet = &set;
+    cfg.prio      = K_SPP_PUBSUB_PRIO_HIGH;
+    cfg.handler   = tracingHandler;
+    cfg.p_ctx     = (void *)&k_h;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        tracingHandler, (void *)&k_l);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_SPP_APID_ALL, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        tracingHandler, (void *)&k_w);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_OTHER_APID, K_SPP_PUBSUB_PRIO_HIGH,
+                                        tracingHandler, (void *)&k_o);
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_SYNC,
+                                        tracingHandler, (void *)&k_s);
+
+    publishApid(K_TEST_PUBSUB_APID, 0U);
+    assert_that(s_trace, is_equal_to_string("s"));
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_trace, is_equal_to_string("shwl"));
+
+    /* K_SPP_APID_NONE only reaches wildcard subscribers; an APID between
+     * the two set members reaches none of the set subscribers. */
+    publishApid(K_SPP_APID_NONE, 1U);
+    publishApid((spp_uint16_t)(K_TEST_PUBSUB_APID + 1U), 2U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_trace, is_equal_to_string("shwlww"));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_publish, publish_many_batches_sync_calls_per_chunk)
+{
+    SPP_Packet_t       *p_pkts[K_SPP_PUBSUB_BATCH_MAX + 4U];
+    SPP_PubSub_SubCfg_t cfg   = { 0 };
+    spp_uint16_t        count = (spp_uint16_t)(K_SPP_PUBSUB_BATCH_MAX + 4U);
+
+    cfg.apid         = K_TEST_PUBSUB_APID;
+    cfg.prio         = K_SPP_PUBSUB_PRIO_SYNC;
+    cfg.batchHandler = batchHandler;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_OK));
+    cfg.batchMax = (spp_uint16_t)(K_SPP_PUBSUB_BATCH_MAX + 1U);
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_SYNC,
+                                        seqHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_SPP_APID_ALL, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+
+    /* One packet of another APID inside the first chunk. */
+    for (spp_uint16_t k = 0U; k < count; k++)
+    {
+        p_pkts[k] = makePacket((k == 3U) ? K_TEST_OTHER_APID : K_TEST_PUBSUB_APID, k);
+    }
+    assert_that(SPP_SERVICES_PUBSUB_publishMany(p_pkts, count), is_equal_to(K_SPP_OK));
+
+    assert_that(s_batchCalls, is_equal_to(2U));
+    assert_that(s_batchPackets, is_equal_to(count - 1U));
+    assert_that(s_batchOrdered, is_true);
+    assert_that(s_seqCount, is_equal_to(count - 1U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(count));
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_calls, is_equal_to(count));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    /* A NULL entry rejects the whole batch. */
+    p_pkts[0] = makePacket(K_TEST_PUBSUB_APID, 0U);
+    p_pkts[1] = NULL;
+    assert_that(SPP_SERVICES_PUBSUB_publishMany(p_pkts, 2U), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+    assert_that(s_batchCalls, is_equal_to(2U));
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkts[0]);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_setOverflowPolicy
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_setOverflowPolicy);
+BeforeEach(SPP_SERVICES_PUBSUB_setOverflowPolicy)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    pubsubSetup();
+    cfg.apid     = K_TEST_PUBSUB_APID;
+    cfg.apidLast = K_TEST_OTHER_APID;
+    cfg.prio     = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler  = seqHandler;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_setQueueLimit(K_SPP_PUBSUB_PRIO_NORMAL, K_TEST_QUEUE_LIMIT);
+}
+AfterEach(SPP_SERVICES_PUBSUB_setOverflowPolicy)
+{
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setOverflowPolicy, drop_oldest_keeps_the_freshest_packets)
+{
+    (void)SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_DROP_OLDEST, 0U);
+    publishN(K_TEST_QUEUE_LIMIT + 3U);
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_seqCount, is_equal_to(K_TEST_QUEUE_LIMIT));
+    assert_that(s_seqSeen[0], is_equal_to(3U));
+    assert_that(s_seqSeen[K_TEST_QUEUE_LIMIT - 1U], is_equal_to(K_TEST_QUEUE_LIMIT + 2U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCountBy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_DROP_OLDEST),
+                is_equal_to(3U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_TEST_PUBSUB_APID), is_equal_to(3U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setOverflowPolicy, coalesce_replaces_newest_entry_of_same_apid)
+{
+    (void)SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_COALESCE, 0U);
+    publishN(K_TEST_QUEUE_LIMIT);
+    publishApid(K_TEST_PUBSUB_APID, 100U);
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_seqCount, is_equal_to(K_TEST_QUEUE_LIMIT));
+    assert_that(s_seqSeen[K_TEST_QUEUE_LIMIT - 2U], is_equal_to(K_TEST_QUEUE_LIMIT - 2U));
+    assert_that(s_seqSeen[K_TEST_QUEUE_LIMIT - 1U], is_equal_to(100U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCountBy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_COALESCE),
+                is_equal_to(1U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setOverflowPolicy, drop_lowest_evicts_only_lower_ranked_apids)
+{
+    spp_uint16_t i;
+
+    (void)SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_DROP_LOWEST, 5U);
+    for (i = 0U; i < K_TEST_QUEUE_LIMIT; i++)
+    {
+        publishApid((i == 2U) ? K_TEST_OTHER_APID : K_TEST_PUBSUB_APID, i);
+    }
+
+    /* Evicts the single lower-ranked entry (seq 2)… */
+    publishApid(K_TEST_PUBSUB_APID, 100U);
+    /* …then finds none left and drops the newcomer instead. */
+    publishApid(K_TEST_PUBSUB_APID, 101U);
+
+    assert_that(SPP_SERVICES_PUBSUB_overflowCountBy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_DROP_LOWEST),
+                is_equal_to(1U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCountBy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_DROP_NEWEST),
+                is_equal_to(1U));
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_seqSeen[2], is_equal_to(3U));
+    assert_that(s_seqSeen[K_TEST_QUEUE_LIMIT - 1U], is_equal_to(100U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setOverflowPolicy, rejects_unknown_policy_and_empty_apid)
+{
+    assert_that(SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_OVF_POLICIES, 0U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_setOverflowPolicy(K_SPP_APID_NONE, K_SPP_PUBSUB_OVF_DROP_OLDEST, 0U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_setQueueLimit(K_SPP_PUBSUB_PRIO_SYNC, 4U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_callConsumers
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_callConsumers);
+BeforeEach(SPP_SERVICES_PUBSUB_callConsumers) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_callConsumers)
+{
+    s_spinUs = 0U;
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumers, high_latency_stays_flat_behind_slow_low_consumer)
+{
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_HIGH,
+                                        highHandler, NULL);
+    s_spinUs = 500U;
+
+    /* One publish and one dispatch per superloop iteration: the HIGH
+     * subscriber must see every packet in the iteration it was published,
+     * while the slow LOW backlog only grows. */
+    for (spp_uint32_t i = 0U; i < 8U; i++)
+    {
+        publishN(1U);
+        SPP_SERVICES_PUBSUB_callConsumers();
+        assert_that(s_highSeen, is_equal_to(i + 1U));
+    }
+    assert_that(s_calls, is_equal_to(0U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_HIGH), is_equal_to(0U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_LOW), is_equal_to(8U));
+
+    /* Once HIGH is idle, LOW drains and every packet goes back to the pool. */
+    s_spinUs = 0U;
+    assert_that(SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U), is_equal_to(8U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumers, serves_earliest_deadline_first_and_counts_misses)
+{
+    static const char   k_c = 'c';
+    static const char   k_x = 'x';
+    static const char   k_y = 'y';
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_HIGH,
+                                        tracingHandler, (void *)&k_c);
+    cfg.apid       = K_TEST_PUBSUB_APID;
+    cfg.prio       = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler    = tracingHandler;
+    cfg.p_ctx      = (void *)&k_x;
+    cfg.deadlineUs = 100000U;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    cfg.prio       = K_SPP_PUBSUB_PRIO_LOW;
+    cfg.p_ctx      = (void *)&k_y;
+    cfg.deadlineUs = 10000U;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+
+    /* Both of y's deliveries are due before x's first; the subscriber
+     * without a deadline runs in the slack. */
+    publishN(2U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_trace, is_equal_to_string("yyxxcc"));
+    assert_that(SPP_SERVICES_PUBSUB_deadlineMisses(tracingHandler, &k_y), is_equal_to(0U));
+
+    /* A handler slower than its deadline is counted as a miss. */
+    cfg.handler    = countingHandler;
+    cfg.p_ctx      = NULL;
+    cfg.deadlineUs = 1000U;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    s_spinUs = 2000U;
+    publishN(1U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(SPP_SERVICES_PUBSUB_deadlineMisses(countingHandler, NULL), is_equal_to(1U));
+    assert_that(SPP_SERVICES_PUBSUB_deadlineMisses(NULL, NULL), is_equal_to(1U));
+
+    cfg.prio = K_SPP_PUBSUB_PRIO_SYNC;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumers, batch_subscriber_takes_waiting_packets_in_one_call)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+
+    cfg.apid         = K_TEST_PUBSUB_APID;
+    cfg.prio         = K_SPP_PUBSUB_PRIO_LOW;
+    cfg.batchHandler = batchHandler;
+    cfg.batchMax     = 4U;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_SPP_APID_ALL, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+
+    /* Packets of another APID in between are left for the other subscriber. */
+    for (spp_uint16_t k = 0U; k < 10U; k++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, k);
+        publishApid(K_TEST_OTHER_APID, k);
+    }
+
+    /* Three batch calls (4 + 4 + 2) and one call per packet for the rest. */
+    assert_that(SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U), is_equal_to(3U + 20U));
+    assert_that(s_batchCalls, is_equal_to(3U));
+    assert_that(s_batchPackets, is_equal_to(10U));
+    assert_that(s_batchOrdered, is_true);
+    assert_that(s_calls, is_equal_to(20U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+#if !SPP_NO_PUBSUB_STATS
+    {
+        SPP_PubSub_SubStats_t sub;
+
+        /* Looked up by its batch handler: one run sample per call. */
+        assert_that(SPP_SERVICES_PUBSUB_batchSubscriberStats(batchHandler, NULL, &sub),
+                    is_equal_to(K_SPP_OK));
+        assert_that(sub.runUs.samples, is_equal_to(3U));
+        assert_that(sub.waitUs.samples, is_equal_to(10U));
+        assert_that(SPP_SERVICES_PUBSUB_subscriberStats(countingHandler, NULL, &sub),
+                    is_equal_to(K_SPP_OK));
+        assert_that(sub.runUs.samples, is_equal_to(20U));
+    }
+#endif
+    assert_that(SPP_SERVICES_PUBSUB_batchDeadlineMisses(batchHandler, NULL), is_equal_to(0U));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumers, skips_and_counts_packets_past_their_ttl)
+{
+    SPP_PubSub_SubCfg_t cfg = { 0 };
+    SPP_Packet_t       *p_pkt;
+
+    cfg.apid     = K_TEST_PUBSUB_APID;
+    cfg.prio     = K_SPP_PUBSUB_PRIO_NORMAL;
+    cfg.handler  = seqHandler;
+    cfg.maxAgeMs = 50U;
+    (void)SPP_SERVICES_PUBSUB_subscribeEx(&cfg);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_SPP_APID_ALL, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+
+    /* Seqs 0 and 1 are a second old: only the subscriber without a TTL
+     * still gets them. */
+    for (spp_uint16_t k = 0U; k < 3U; k++)
+    {
+        p_pkt = makePacket(K_TEST_PUBSUB_APID, k);
+        if (k < 2U)
+        {
+            p_pkt->secondaryHeader.timestampMs -= 1000U;
+        }
+        (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+    }
+
+    /* The APID limit applies to every deferred subscriber of the APID. */
+    assert_that(SPP_SERVICES_PUBSUB_setMaxAge(K_TEST_OTHER_APID, 10U), is_equal_to(K_SPP_OK));
+    p_pkt = makePacket(K_TEST_OTHER_APID, 7U);
+    p_pkt->secondaryHeader.timestampMs -= 1000U;
+    (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    assert_that(s_seqCount, is_equal_to(1U));
+    assert_that(s_seqSeen[0], is_equal_to(2U));
+    assert_that(s_calls, is_equal_to(3U));
+    assert_that(SPP_SERVICES_PUBSUB_expiredCount(K_TEST_PUBSUB_APID), is_equal_to(2U));
+    assert_that(SPP_SERVICES_PUBSUB_expiredCount(K_TEST_OTHER_APID), is_equal_to(1U));
+    assert_that(SPP_SERVICES_PUBSUB_expiredCount(K_SPP_APID_ALL), is_equal_to(3U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    cfg.prio = K_SPP_PUBSUB_PRIO_SYNC;
+    assert_that(SPP_SERVICES_PUBSUB_subscribeEx(&cfg), is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_setMaxAge(K_SPP_APID_NONE, 10U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_callConsumersBudget
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_PUBSUB_callConsumersBudget);
+BeforeEach(SPP_SERVICES_PUBSUB_callConsumersBudget) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_callConsumersBudget)
+{
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumersBudget, stops_at_dispatch_count)
+{
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+    publishN(4U);
+
+    assert_that(SPP_SERVICES_PUBSUB_callConsumersBudget(3U, 0U), is_equal_to(3U));
+    assert_that(s_calls, is_equal_to(3U));
+    /* NORMAL is served first: three of its four entries are done. */
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_NORMAL), is_equal_to(1U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepthAt(K_SPP_PUBSUB_PRIO_LOW), is_equal_to(4U));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(5U));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumersBudget, drains_queue_and_returns_packets_without_limits)
+{
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+
+    /* The queues are linked through the packets: the whole pool fits, at
+     * both levels at once, without an overflow. */
+    publishN(K_SPP_DATABANK_SIZE);
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(2U * K_SPP_DATABANK_SIZE));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(0U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL), is_equal_to(0U));
+
+    assert_that(SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U),
+                is_equal_to(2U * K_SPP_DATABANK_SIZE));
+    assert_that(SPP_SERVICES_PUBSUB_queueDepth(), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_callConsumersBudget, stops_when_time_budget_is_spent)
+{
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    publishN(8U);
+    s_spinUs = 2000U;
+
+    /* Each handler overruns the 1 ms budget on its own: exactly one runs. */
+    assert_that(SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 1000U), is_equal_to(1U));
+    assert_that(s_calls, is_equal_to(1U));
+    s_spinUs = 0U;
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_setSpill
+ * ---------------------------------------------------------------- */
+
+#if !SPP_NO_STORAGE
+
+#define K_TEST_SPILL_PATH "spp_test_spill.bin"
+
+static spp_uint16_t s_nextSeq;
+static spp_bool_t   s_inOrder;
+
+static void orderHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_ctx;
+    if (p_packet->primaryHeader.seq != s_nextSeq)
+    {
+        s_inOrder = false;
+    }
+    s_nextSeq = (spp_uint16_t)(p_packet->primaryHeader.seq + 1U);
+    s_calls++;
+}
+
+/* Like orderHandler, but allows gaps: only checks nothing comes early. */
+static void risingHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_ctx;
+    if (p_packet->primaryHeader.seq < s_nextSeq)
+    {
+        s_inOrder = false;
+    }
+    s_nextSeq = (spp_uint16_t)(p_packet->primaryHeader.seq + 1U);
+    s_calls++;
+}
+
+static void drainAll(void)
+{
+    while ((SPP_SERVICES_PUBSUB_queueDepth() != 0U) || (SPP_SERVICES_PUBSUB_spillCount() != 0U))
+    {
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    }
+}
+
+Describe(SPP_SERVICES_PUBSUB_setSpill);
+BeforeEach(SPP_SERVICES_PUBSUB_setSpill)
+{
+    pubsubSetup();
+    s_nextSeq = 0U;
+    s_inOrder = true;
+}
+AfterEach(SPP_SERVICES_PUBSUB_setSpill)
+{
+    (void)SPP_SERVICES_PUBSUB_setSpill(NULL, 0U);
+    (void)remove(K_TEST_SPILL_PATH);
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setSpill, loses_nothing_under_sustained_double_rate_burst)
+{
+    spp_uint32_t rounds = 4U * K_SPP_DATABANK_SIZE;
+    spp_uint32_t peak   = 0U;
+    spp_uint16_t seq    = 0U;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        orderHandler, NULL);
+    assert_that(SPP_SERVICES_PUBSUB_setSpill(K_TEST_SPILL_PATH, 2U), is_equal_to(K_SPP_OK));
+
+    /* Two packets in for every one the consumer takes out. */
+    for (spp_uint32_t r = 0U; r < rounds; r++)
+    {
+        for (spp_uint32_t k = 0U; k < 2U; k++)
+        {
+            assert_that(SPP_SERVICES_DATABANK_freeCount(), is_greater_than(0U));
+            publishApid(K_TEST_PUBSUB_APID, seq++);
+        }
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        if (SPP_SERVICES_PUBSUB_spillCount() > peak)
+        {
+            peak = SPP_SERVICES_PUBSUB_spillCount();
+        }
+    }
+    assert_that(peak, is_greater_than(K_SPP_DATABANK_SIZE));
+    assert_that(SPP_SERVICES_PUBSUB_subscribe(K_TEST_OTHER_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                              countingHandler, NULL),
+                is_equal_to(K_SPP_ERROR));
+
+    drainAll();
+
+    assert_that(s_calls, is_equal_to(2U * rounds));
+    assert_that(s_inOrder, is_true);
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setSpill, reuses_the_file_while_a_backlog_persists)
+{
+    /* Every spilled record is at least 16 bytes, so the steady state below
+     * writes the ring over several times. */
+    spp_uint32_t steady = (4U * K_SPP_PUBSUB_SPILL_MAX_BYTES) / 16U;
+    spp_uint32_t total  = 0U;
+    spp_uint16_t seq    = 0U;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        orderHandler, NULL);
+    assert_that(SPP_SERVICES_PUBSUB_setSpill(K_TEST_SPILL_PATH, 2U), is_equal_to(K_SPP_OK));
+
+    /* Build a backlog at twice the consumer's rate... */
+    for (spp_uint32_t r = 0U; r < K_SPP_DATABANK_SIZE; r++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        total += 2U;
+    }
+    /* ...then hold it: one in, one out, far longer than one pass over the file. */
+    for (spp_uint32_t r = 0U; r < steady; r++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        total++;
+        assert_that(SPP_SERVICES_PUBSUB_spillCount(), is_greater_than(0U));
+    }
+    drainAll();
+
+    assert_that(s_calls, is_equal_to(total));
+    assert_that(s_inOrder, is_true);
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL), is_equal_to(0U));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setSpill, full_file_drops_without_reordering)
+{
+    spp_uint32_t rounds = K_SPP_PUBSUB_SPILL_MAX_BYTES / 16U;
+    spp_uint16_t seq    = 0U;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        risingHandler, NULL);
+    assert_that(SPP_SERVICES_PUBSUB_setSpill(K_TEST_SPILL_PATH, 2U), is_equal_to(K_SPP_OK));
+
+    for (spp_uint32_t r = 0U; r < rounds; r++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+    }
+    drainAll();
+
+    /* DROP_NEWEST: the file filled up and later packets were lost, but none
+     * overtook a spilled one. */
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL), is_greater_than(0U));
+    assert_that(s_calls + SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL),
+                is_equal_to(2U * rounds));
+    assert_that(s_inOrder, is_true);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_setSpill, drop_oldest_counts_the_skipped_apid)
+{
+    spp_uint32_t published = 0U;
+    spp_uint16_t filled;
+    spp_uint16_t seq       = 0U;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_OTHER_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID,
+                                                K_SPP_PUBSUB_OVF_DROP_OLDEST, 0U);
+    assert_that(SPP_SERVICES_PUBSUB_setSpill(K_TEST_SPILL_PATH, 2U), is_equal_to(K_SPP_OK));
+
+    /* Fill the file with the other APID until it drops its own packets. */
+    while (SPP_SERVICES_PUBSUB_overflowCount(K_TEST_OTHER_APID) == 0U)
+    {
+        publishApid(K_TEST_OTHER_APID, seq++);
+        publishApid(K_TEST_OTHER_APID, seq++);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        published += 2U;
+    }
+    filled = SPP_SERVICES_PUBSUB_overflowCount(K_TEST_OTHER_APID);
+
+    /* DROP_OLDEST makes room by skipping the other APID's spilled packets. */
+    for (spp_uint32_t r = 0U; r < 8U; r++)
+    {
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        publishApid(K_TEST_PUBSUB_APID, seq++);
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(1U, 0U);
+        published += 2U;
+    }
+    drainAll();
+
+    assert_that(SPP_SERVICES_PUBSUB_overflowCountBy(K_TEST_PUBSUB_APID,
+                                                    K_SPP_PUBSUB_OVF_DROP_OLDEST),
+                is_greater_than(0U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_TEST_PUBSUB_APID), is_equal_to(0U));
+    assert_that(SPP_SERVICES_PUBSUB_overflowCount(K_TEST_OTHER_APID), is_greater_than(filled));
+    assert_that(s_calls + SPP_SERVICES_PUBSUB_overflowCount(K_SPP_APID_ALL),
+                is_equal_to(published));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_stats
+ * ---------------------------------------------------------------- */
+
+#if !SPP_NO_PUBSUB_STATS
+
+Describe(SPP_SERVICES_PUBSUB_stats);
+BeforeEach(SPP_SERVICES_PUBSUB_stats) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_stats)  {}
+
+Ensure(SPP_SERVICES_PUBSUB_stats, records_wait_run_and_lifetime)
+{
+    SPP_PubSub_SubStats_t  sub;
+    SPP_PubSub_ApidStats_t apid;
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    s_spinUs = 2000U;
+    publishN(2U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+
+    assert_that(SPP_SERVICES_PUBSUB_subscriberStats(countingHandler, NULL, &sub),
+                is_equal_to(K_SPP_OK));
+    assert_that(sub.runUs.samples, is_equal_to(2U));
+    assert_that(sub.runUs.maxUs, is_greater_than(1999U));
+    assert_that(SPP_SERVICES_PUBSUB_histPercentile(&sub.runUs, 50U), is_greater_than(1023U));
+    /* The second packet waited behind the first handler. */
+    assert_that(sub.waitUs.samples, is_equal_to(2U));
+    assert_that(sub.waitUs.maxUs, is_greater_than(1999U));
+
+    assert_that(SPP_SERVICES_PUBSUB_apidStats(K_TEST_PUBSUB_APID, &apid), is_equal_to(K_SPP_OK));
+    assert_that(apid.waitUs.samples, is_equal_to(2U));
+    assert_that(apid.lifetimeUs.samples, is_equal_to(2U));
+    assert_that(apid.lifetimeUs.maxUs, is_greater_than(3999U));
+
+    assert_that(SPP_SERVICES_PUBSUB_subscriberStats(highHandler, NULL, &sub),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_PUBSUB_batchSubscriberStats(batchHandler, NULL, &sub),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+}
+
+static SPP_Packet_t *s_kept[2];
+static spp_uint32_t  s_keptCount;
+
+/* Keeps the packet past the callback, as the SD logger does with a batch. */
+static void retainingHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_ctx;
+    if ((s_keptCount < 2U) &&
+        (SPP_SERVICES_DATABANK_retain((SPP_Packet_t *)p_packet) == K_SPP_OK))
+    {
+        s_kept[s_keptCount++] = (SPP_Packet_t *)p_packet;
+    }
+}
+
+Ensure(SPP_SERVICES_PUBSUB_stats, samples_lifetime_of_retained_packets)
+{
+    SPP_PubSub_ApidStats_t apid;
+
+    s_keptCount = 0U;
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        retainingHandler, NULL);
+    publishN(2U);
+    (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+
+    /* Both packets are still held by the handler, yet pub/sub is done. */
+    assert_that(s_keptCount, is_equal_to(2U));
+    assert_that(SPP_SERVICES_PUBSUB_apidStats(K_TEST_PUBSUB_APID, &apid), is_equal_to(K_SPP_OK));
+    assert_that(apid.lifetimeUs.samples, is_equal_to(2U));
+
+    (void)SPP_SERVICES_DATABANK_release(s_kept[0]);
+    (void)SPP_SERVICES_DATABANK_release(s_kept[1]);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_stats, percentile_returns_bucket_upper_bound)
+{
+    SPP_PubSub_Hist_t hist = { 0 };
+
+    hist.bucket[0]  = 50U; /* 0 µs          */
+    hist.bucket[4]  = 45U; /* 8 … 15 µs     */
+    hist.bucket[11] = 5U;  /* 1024 … 2047 µs */
+    hist.samples    = 100U;
+    hist.maxUs      = 1500U;
+
+    assert_that(SPP_SERVICES_PUBSUB_histPercentile(&hist, 50U), is_equal_to(0U));
+    assert_that(SPP_SERVICES_PUBSUB_histPercentile(&hist, 90U), is_equal_to(15U));
+    assert_that(SPP_SERVICES_PUBSUB_histPercentile(&hist, 99U), is_equal_to(1500U));
+    assert_that(SPP_SERVICES_PUBSUB_histPercentile(NULL, 50U), is_equal_to(0U));
+}
+
+#endif /* !SPP_NO_PUBSUB_STATS */
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_PUBSUB_mpsc (concurrency)
+ * ---------------------------------------------------------------- */
+
+#if SPP_PUBSUB_MPSC
+
+#define K_MPSC_THREADS    (4U)
+#define K_MPSC_PER_THREAD (4000U)  /* Keeps total drops inside the 16-bit counters. */
+
+static atomic_uint s_mpscProduced;
+static atomic_uint s_mpscRunning;
+static spp_uint32_t s_mpscSeen[K_MPSC_THREADS];
+static spp_uint32_t s_mpscOutOfOrder;
+
+static void mpscHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    spp_uint32_t t = p_packet->payload[0];
+    (void)p_ctx;
+
+    /* Each producer's packets must arrive in its own publish order. */
+    if (p_packet->primaryHeader.seq != (spp_uint16_t)s_mpscSeen[t])
+    {
+        s_mpscOutOfOrder++;
+    }
+    s_mpscSeen[t] = (spp_uint32_t)p_packet->primaryHeader.seq + 1U;
+}
+
+static void *mpscProducer(void *p_arg)
+{
+    spp_uint8_t  t   = (spp_uint8_t)(uintptr_t)p_arg;
+    spp_uint16_t seq = 0U;
+
+    for (spp_uint32_t i = 0U; i < K_MPSC_PER_THREAD; i++)
+    {
+        SPP_Packet_t *p_pkt;
+        while ((p_pkt = SPP_SERVICES_DATABANK_getPacketSized(1U)) == NULL)
+        {
+            sched_yield();
+        }
+        spp_uint8_t *p_out = SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_TEST_PUBSUB_APID, seq);
+        p_out[0] = t;
+        (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, 1U);
+        (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+        (void)atomic_fetch_add(&s_mpscProduced, 1U);
+        seq++;
+    }
+    (void)atomic_fetch_sub(&s_mpscRunning, 1U);
+    return NULL;
+}
+
+Describe(SPP_SERVICES_PUBSUB_mpsc);
+BeforeEach(SPP_SERVICES_PUBSUB_mpsc) { pubsubSetup(); }
+AfterEach(SPP_SERVICES_PUBSUB_mpsc)  {}
+
+Ensure(SPP_SERVICES_PUBSUB_mpsc, delivers_or_counts_every_packet_from_concurrent_producers)
+{
+    pthread_t threads[K_MPSC_THREADS];
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        countingHandler, NULL);
+    (void)SPP_SERVICES_PUBSUB_setOverflowPolicy(K_TEST_PUBSUB_APID,
+                                                K_SPP_PUBSUB_OVF_DROP_OLDEST, 0U);
+    atomic_store(&s_mpscProduced, 0U);
+    atomic_store(&s_mpscRunning, K_MPSC_THREADS);
+
+    for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+    {
+        (void)pthread_create(&threads[t], NULL, mpscProducer, (void *)(uintptr_t)t);
+    }
+    while ((atomic_load(&s_mpscRunning) != 0U) || (SPP_SERVICES_PUBSUB_queueDepth() != 0U))
+    {
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    }
+    for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+    {
+        (void)pthread_join(threads[t], NULL);
+    }
+
+    assert_that(atomic_load(&s_mpscProduced), is_equal_to(K_MPSC_THREADS * K_MPSC_PER_THREAD));
+    assert_that(s_calls + SPP_SERVICES_PUBSUB_overflowCount(K_TEST_PUBSUB_APID),
+                is_equal_to(K_MPSC_THREADS * K_MPSC_PER_THREAD));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_PUBSUB_mpsc, keeps_per_producer_order_without_overflow)
+{
+    pthread_t threads[K_MPSC_THREADS];
+
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_PUBSUB_APID, K_SPP_PUBSUB_PRIO_NORMAL,
+                                        mpscHandler, NULL);
+    for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+    {
+        s_mpscSeen[t] = 0U;
+    }
+    s_mpscOutOfOrder = 0U;
+    atomic_store(&s_mpscRunning, K_MPSC_THREADS);
+
+    for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+    {
+        (void)pthread_create(&threads[t], NULL, mpscProducer, (void *)(uintptr_t)t);
+    }
+    while ((atomic_load(&s_mpscRunning) != 0U) || (SPP_SERVICES_PUBSUB_queueDepth() != 0U))
+    {
+        (void)SPP_SERVICES_PUBSUB_callConsumersBudget(0U, 0U);
+    }
+    for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+    {
+        (void)pthread_join(threads[t], NULL);
+    }
+
+    /* Without overflow every packet arrives, in order per producer. */
+    if (SPP_SERVICES_PUBSUB_overflowCount(K_TEST_PUBSUB_APID) == 0U)
+    {
+        for (spp_uint32_t t = 0U; t < K_MPSC_THREADS; t++)
+        {
+            assert_that(s_mpscSeen[t], is_equal_to(K_MPSC_PER_THREAD));
+        }
+        assert_that(s_mpscOutOfOrder, is_equal_to(0U));
+    }
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+#endif /* SPP_PUBSUB_MPSC */
+
+/* ----------------------------------------------------------------
+ * Suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *pubsub_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("pubsub");
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribe, rejects_null_handler);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribe, leaves_queued_packets_with_their_subscribers);
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribeEx, decimation_skips_packets_before_queueing);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribeEx, rate_limit_delivers_at_most_one_per_period);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribeEx, routes_ranges_across_pages_and_limits_route_blocks);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribeEx, consumer_group_gives_each_packet_to_one_member);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_subscribeEx, least_loaded_group_favours_the_member_that_keeps_up);
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_publish, routes_by_apid_in_priority_order);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_publish, publish_many_batches_sync_calls_per_chunk);
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setOverflowPolicy, drop_oldest_keeps_the_freshest_packets);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setOverflowPolicy, coalesce_replaces_newest_entry_of_same_apid);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setOverflowPolicy, drop_lowest_evicts_only_lower_ranked_apids);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setOverflowPolicy, rejects_unknown_policy_and_empty_apid);
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumers, high_latency_stays_flat_behind_slow_low_consumer);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumers, serves_earliest_deadline_first_and_counts_misses);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumers, batch_subscriber_takes_waiting_packets_in_one_call);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumers, skips_and_counts_packets_past_their_ttl);
+
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumersBudget, stops_at_dispatch_count);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumersBudget, drains_queue_and_returns_packets_without_limits);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_callConsumersBudget, stops_when_time_budget_is_spent);
+
+#if !SPP_NO_STORAGE
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setSpill, loses_nothing_under_sustained_double_rate_burst);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setSpill, reuses_the_file_while_a_backlog_persists);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setSpill, full_file_drops_without_reordering);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_setSpill, drop_oldest_counts_the_skipped_apid);
+#endif
+
+#if !SPP_NO_PUBSUB_STATS
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_stats, records_wait_run_and_lifetime);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_stats, samples_lifetime_of_retained_packets);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_stats, percentile_returns_bucket_upper_bound);
+#endif
+
+#if SPP_PUBSUB_MPSC
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_mpsc, delivers_or_counts_every_packet_from_concurrent_producers);
+    add_test_with_context(suite, SPP_SERVICES_PUBSUB_mpsc, keeps_per_producer_order_without_overflow);
+#endif
+
+    return suite;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file test_segment.c
+ * @brief BDD unit tests for payload segmentation and reassembly.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_SEGMENT_publish()    — chunking, sequence flags, seq advance
+ *  - SPP_SERVICES_SEGMENT_publishParts() — pieces spanning segment boundaries
+ *  - SPP_SERVICES_SEGMENT_reassemble() — round trip, zero-copy fast path,
+ *    gap detection, bounded record size
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/segment/segment.h"
+#include "spp/services/databank/databank.h"
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+
+#include <string.h>
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_TEST_SEGMENT_APID (0x0010U)
+
+typedef struct
+{
+    SPP_SegmentReasm_t reasm;
+    spp_uint8_t        record[K_SPP_SEGMENT_MAX_RECORD];
+    spp_uint32_t       recordLen;
+    spp_uint32_t       records;
+    spp_uint32_t       packets;
+    spp_bool_t         zeroCopy;
+} TestSink_t;
+
+static TestSink_t s_sink;
+
+static void sinkHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    TestSink_t        *p_sink = (TestSink_t *)p_ctx;
+    const spp_uint8_t *p_rec;
+    spp_uint32_t       len;
+
+    p_sink->packets++;
+    if ((SPP_SERVICES_SEGMENT_reassemble(&p_sink->reasm, p_packet, &p_rec, &len) == K_SPP_OK) &&
+        (p_rec != NULL))
+    {
+        memcpy(p_sink->record, p_rec, len);
+        p_sink->recordLen = len;
+        p_sink->zeroCopy  = (spp_bool_t)(p_rec == p_packet->payload);
+        p_sink->records++;
+    }
+}
+
+static void segmentSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+
+    memset(&s_sink, 0, sizeof(s_sink));
+    SPP_SERVICES_SEGMENT_reasmInit(&s_sink.reasm);
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_SEGMENT_APID, K_SPP_PUBSUB_PRIO_SYNC,
+                                        sinkHandler, &s_sink);
+}
+
+/* Build one segment by hand, as a remote sender would have. */
+static SPP_Packet_t *makeSegment(spp_uint16_t seq, spp_uint8_t flags, spp_uint16_t len,
+                                 spp_uint8_t fill)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(len);
+    void *p_out = SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_TEST_SEGMENT_APID, seq);
+    memset(p_out, fill, len);
+    p_pkt->primaryHeader.seqFlags = flags;
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, len);
+    return p_pkt;
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_SEGMENT_publish
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_SEGMENT_publish);
+BeforeEach(SPP_SERVICES_SEGMENT_publish) { segmentSetup(); }
+AfterEach(SPP_SERVICES_SEGMENT_publish)  {}
+
+Ensure(SPP_SERVICES_SEGMENT_publish, splits_long_record_and_reassembles_it)
+{
+    static spp_uint8_t s_data[(2U * K_SPP_SEGMENT_CHUNK) + (K_SPP_SEGMENT_CHUNK / 2U)];
+    spp_uint16_t seq = 0xFFFEU; /* Segment seq must survive wrap-around. */
+
+    for (spp_uint32_t i = 0U; i < sizeof(s_data); i++)
+    {
+        s_data[i] = (spp_uint8_t)(i * 7U);
+    }
+
+    assert_that(SPP_SERVICES_SEGMENT_publish(K_TEST_SEGMENT_APID, &seq, s_data, sizeof(s_data)),
+                is_equal_to(K_SPP_OK));
+
+    assert_that(s_sink.packets, is_equal_to(3U));
+    assert_that(seq, is_equal_to(1U));
+    assert_that(s_sink.records, is_equal_to(1U));
+    assert_that(s_sink.recordLen, is_equal_to(sizeof(s_data)));
+    assert_that(memcmp(s_sink.record, s_data, sizeof(s_data)), is_equal_to(0));
+    assert_that(s_sink.zeroCopy, is_false);
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+}
+
+Ensure(SPP_SERVICES_SEGMENT_publish, sends_short_record_unsegmented_without_copy)
+{
+    static const char k_msg[] = "short";
+    spp_uint16_t seq = 5U;
+
+    assert_that(SPP_SERVICES_SEGMENT_publish(K_TEST_SEGMENT_APID, &seq, k_msg, sizeof(k_msg)),
+                is_equal_to(K_SPP_OK));
+
+    assert_that(s_sink.packets, is_equal_to(1U));
+    assert_that(seq, is_equal_to(6U));
+    assert_that(s_sink.records, is_equal_to(1U));
+    assert_that(s_sink.zeroCopy, is_true);
+    assert_that((const char *)s_sink.record, is_equal_to_string(k_msg));
+}
+
+Ensure(SPP_SERVICES_SEGMENT_publish, joins_parts_across_segment_boundaries)
+{
+    static spp_uint8_t s_body[K_SPP_SEGMENT_CHUNK + 10U];
+    static spp_uint8_t s_whole[3U + sizeof(s_body) + 1U];
+    SPP_SegmentPart_t  parts[4];
+    spp_uint16_t       seq = 0U;
+
+    for (spp_uint32_t i = 0U; i < sizeof(s_body); i++)
+    {
+        s_body[i] = (spp_uint8_t)(i * 3U);
+    }
+    memcpy(s_whole, "abc", 3U);
+    memcpy(&s_whole[3], s_body, sizeof(s_body));
+    s_whole[sizeof(s_whole) - 1U] = 0xEEU;
+
+    parts[0].p_data = "abc";
+    parts[0].len    = 3U;
+    parts[1].p_data = NULL; /* Empty pieces are skipped. */
+    parts[1].len    = 0U;
+    parts[2].p_data = s_body;
+    parts[2].len    = sizeof(s_body);
+    parts[3].p_data = &s_whole[sizeof(s_whole) - 1U];
+    parts[3].len    = 1U;
+    assert_that(SPP_SERVICES_SEGMENT_publishParts(K_TEST_SEGMENT_APID, &seq, parts, 4U),
+                is_equal_to(K_SPP_OK));
+
+    assert_that(s_sink.packets, is_equal_to(2U));
+    assert_that(s_sink.records, is_equal_to(1U));
+    assert_that(s_sink.recordLen, is_equal_to(sizeof(s_whole)));
+    assert_that(memcmp(s_sink.record, s_whole, sizeof(s_whole)), is_equal_to(0));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    parts[1].len = 1U;
+    assert_that(SPP_SERVICES_SEGMENT_publishParts(K_TEST_SEGMENT_APID, &seq, parts, 4U),
+                is_equal_to(K_SPP_ERROR_NULL_POINTER));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_SEGMENT_reassemble
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_SEGMENT_reassemble);
+BeforeEach(SPP_SERVICES_SEGMENT_reassemble) { segmentSetup(); }
+AfterEach(SPP_SERVICES_SEGMENT_reassemble)  {}
+
+Ensure(SPP_SERVICES_SEGMENT_reassemble, drops_record_with_sequence_gap)
+{
+    SPP_SegmentReasm_t *p_r = &s_sink.reasm;
+    const spp_uint8_t  *p_rec;
+    spp_uint32_t        len;
+    SPP_Packet_t       *p_first = makeSegment(10U, K_SPP_PKT_SEQ_FIRST, 32U, 0xAAU);
+    SPP_Packet_t       *p_last  = makeSegment(12U, K_SPP_PKT_SEQ_LAST, 32U, 0xBBU);
+
+    assert_that(SPP_SERVICES_SEGMENT_reassemble(p_r, p_first, &p_rec, &len), is_equal_to(K_SPP_OK));
+    assert_that(p_rec, is_null);
+    assert_that(SPP_SERVICES_SEGMENT_reassemble(p_r, p_last, &p_rec, &len), is_equal_to(K_SPP_ERROR));
+    assert_that(p_rec, is_null);
+    assert_that(p_r->dropped, is_equal_to(1U));
+    assert_that(p_r->active, is_false);
+
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_first);
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_last);
+}
+
+Ensure(SPP_SERVICES_SEGMENT_reassemble, rejects_record_larger_than_buffer)
+{
+    SPP_SegmentReasm_t *p_r = &s_sink.reasm;
+    const spp_uint8_t  *p_rec;
+    spp_uint32_t        len;
+    SPP_RetVal_t        ret = K_SPP_OK;
+    spp_uint16_t        seq = 0U;
+    spp_uint32_t        fed = 0U;
+
+    while ((ret == K_SPP_OK) && (fed <= K_SPP_SEGMENT_MAX_RECORD))
+    {
+        SPP_Packet_t *p_pkt = makeSegment(seq, (seq == 0U) ? K_SPP_PKT_SEQ_FIRST
+                                                           : K_SPP_PKT_SEQ_CONTINUATION,
+                                          K_SPP_DATABANK_MEDIUM_PAYLOAD, 0x55U);
+        ret = SPP_SERVICES_SEGMENT_reassemble(p_r, p_pkt, &p_rec, &len);
+        (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+        fed += K_SPP_DATABANK_MEDIUM_PAYLOAD;
+        seq++;
+    }
+
+    assert_that(ret, is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(p_r->dropped, is_equal_to(1U));
+    assert_that(p_r->len, is_equal_to(0U));
+}
+
+/* ----------------------------------------------------------------
+ * Suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *segment_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("segment");
+
+    add_test_with_context(suite, SPP_SERVICES_SEGMENT_publish, splits_long_record_and_reassembles_it);
+    add_test_with_context(suite, SPP_SERVICES_SEGMENT_publish, sends_short_record_unsegmented_without_copy);
+    add_test_with_context(suite, SPP_SERVICES_SEGMENT_publish, joins_parts_across_segment_boundaries);
+
+    add_test_with_context(suite, SPP_SERVICES_SEGMENT_reassemble, drops_record_with_sequence_gap);
+    add_test_with_context(suite, SPP_SERVICES_SEGMENT_reassemble, rejects_record_larger_than_buffer);
+
+    return suite;
+}
@@ -0,0 +1,391 @@
+/**
+ * @file test_service.c
+ * @brief BDD unit tests for the module registry.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_register()      — a failed init leaves no binding behind
+ *  - SPP_SERVICES_bindReady()     — argument checks, module starts ready
+ *  - SPP_SERVICES_bindTimer()     — produce once per period, argument checks
+ *  - SPP_SERVICES_callProducers() — bound modules only after their ISR,
+ *    unbound producers on every pass
+ *  - SPP_SERVICES_idle()          — idle only with nothing ready, polled
+ *    or queued; the SD logger lets the loop sleep
+ *  - SPP_SERVICES_DATALOGGER_logPacket() — a log line that lost segments
+ *    is cut off instead of running into the next one
+ *
+ * The registry has no reset, so each test registers its own modules and
+ * checks only their counters; the timer wheel is reset so a module bound
+ * to a timer in one test stays quiet in the next.
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/service.h"
+#include "spp/services/databank/databank.h"
+#include "spp/services/pubsub/pubsub.h"
+#include "spp/services/datalogger/datalogger.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+#include "spp/hal/time.h"
+
+#include <stdio.h>
+#include <string.h>
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+#define K_TEST_SERVICE_APID (0x0050U)
+#define K_TEST_LOG_PATH     "spp_test_service_log.txt"
+
+typedef struct
+{
+    volatile spp_bool_t drdy;
+    SPP_GpioIsrCtx_t    isr;
+    spp_uint32_t        calls;    /* produce() calls.                  */
+    spp_uint32_t        produced; /* Calls that found the flag set.    */
+} TestProducer_t;
+
+static SPP_RetVal_t boundInit(void *p_ctx)
+{
+    TestProducer_t *p_prod = (TestProducer_t *)p_ctx;
+
+    p_prod->isr.p_flag = &p_prod->drdy;
+    return SPP_SERVICES_bindReady(p_ctx, &p_prod->isr);
+}
+
+static void testProduce(void *p_ctx)
+{
+    TestProducer_t *p_prod = (TestProducer_t *)p_ctx;
+
+    p_prod->calls++;
+    if (!p_prod->drdy) return;
+    p_prod->drdy = false;
+    p_prod->produced++;
+}
+
+static const SPP_Module_t k_boundModule = {
+    .p_name       = "bound",
+    .apid         = K_SPP_APID_NONE,
+    .init         = boundInit,
+    .produce      = testProduce,
+    .consumesApid = K_SPP_APID_NONE,
+};
+
+static SPP_Timer_t s_failTimer;
+
+/* Binds both an interrupt and a timer, then fails. */
+static SPP_RetVal_t failingInit(void *p_ctx)
+{
+    TestProducer_t *p_prod = (TestProducer_t *)p_ctx;
+
+    p_prod->isr.p_flag = &p_prod->drdy;
+    (void)SPP_SERVICES_bindReady(p_ctx, &p_prod->isr);
+    (void)SPP_SERVICES_bindTimer(p_ctx, &s_failTimer, 1U);
+    return K_SPP_ERROR;
+}
+
+static const SPP_Module_t k_failingModule = {
+    .p_name       = "failing",
+    .apid         = K_SPP_APID_NONE,
+    .init         = failingInit,
+    .produce      = testProduce,
+    .consumesApid = K_SPP_APID_NONE,
+};
+
+static const SPP_Module_t k_polledModule = {
+    .p_name       = "polled",
+    .apid         = K_SPP_APID_NONE,
+    .produce      = testProduce,
+    .consumesApid = K_SPP_APID_NONE,
+};
+
+/* What the port's GPIO ISR does. */
+static void fireIsr(TestProducer_t *p_prod)
+{
+    *p_prod->isr.p_flag       = true;
+    *p_prod->isr.p_readyMask |= p_prod->isr.readyBit;
+}
+
+static void countingHandler(const SPP_Packet_t *p_packet, void *p_ctx)
+{
+    (void)p_packet;
+    (void)p_ctx;
+}
+
+static void serviceSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    (void)SPP_SERVICES_DATABANK_init();
+    SPP_SERVICES_PUBSUB_init();
+    SPP_SERVICES_TIMER_init();
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_register
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_register);
+BeforeEach(SPP_SERVICES_register) { serviceSetup(); }
+AfterEach(SPP_SERVICES_register)  {}
+
+Ensure(SPP_SERVICES_register, failed_init_leaves_no_binding_behind)
+{
+    static TestProducer_t s_dead;
+    static TestProducer_t s_next;
+
+    memset(&s_dead, 0, sizeof(s_dead));
+    memset(&s_next, 0, sizeof(s_next));
+    assert_that(SPP_SERVICES_register(&k_failingModule, &s_dead), is_equal_to(K_SPP_ERROR));
+    assert_that(s_dead.isr.p_readyMask, is_null);
+    assert_that(SPP_SERVICES_TIMER_isActive(&s_failTimer), is_false);
+
+    /* The next module takes the same slot; only its own binding drives it. */
+    assert_that(SPP_SERVICES_register(&k_boundModule, &s_next), is_equal_to(K_SPP_OK));
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_next.calls, is_equal_to(1U));
+
+    (void)SPP_SERVICES_TIMER_advance(SPP_HAL_getTimeMs() + 5U);
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_next.calls, is_equal_to(1U));
+    assert_that(s_dead.calls, is_equal_to(0U));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_callProducers
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_callProducers);
+BeforeEach(SPP_SERVICES_callProducers) { serviceSetup(); }
+AfterEach(SPP_SERVICES_callProducers)  {}
+
+Ensure(SPP_SERVICES_callProducers, visits_bound_modules_only_after_their_isr_fired)
+{
+    static TestProducer_t s_a;
+    static TestProducer_t s_b;
+
+    memset(&s_a, 0, sizeof(s_a));
+    memset(&s_b, 0, sizeof(s_b));
+    assert_that(SPP_SERVICES_register(&k_boundModule, &s_a), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_register(&k_boundModule, &s_b), is_equal_to(K_SPP_OK));
+
+    /* Both start ready, in case their interrupt fired before the binding. */
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_a.calls, is_equal_to(1U));
+    assert_that(s_b.calls, is_equal_to(1U));
+
+    /* Nothing fired: neither is visited. */
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_a.calls + s_b.calls, is_equal_to(2U));
+
+    /* Two interrupts before the pass: one produce call. */
+    fireIsr(&s_b);
+    fireIsr(&s_b);
+    (void)SPP_SERVICES_callProducers();
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_a.calls, is_equal_to(1U));
+    assert_that(s_b.calls, is_equal_to(2U));
+    assert_that(s_b.produced, is_equal_to(1U));
+}
+
+Ensure(SPP_SERVICES_callProducers, bind_rejects_unknown_context)
+{
+    TestProducer_t prod;
+
+    memset(&prod, 0, sizeof(prod));
+    assert_that(SPP_SERVICES_bindReady(&prod, &prod.isr),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_bindReady(&prod, NULL), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+    assert_that(prod.isr.p_readyMask, is_null);
+}
+
+Ensure(SPP_SERVICES_callProducers, visits_timer_bound_modules_once_per_period)
+{
+    static TestProducer_t s_prod;
+    static SPP_Timer_t    s_timer;
+    spp_uint32_t          passes = 0U;
+    spp_uint32_t          start;
+
+    memset(&s_prod, 0, sizeof(s_prod));
+    assert_that(SPP_SERVICES_register(&k_polledModule, &s_prod), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_bindTimer(&s_prod, &s_timer, 2U), is_equal_to(K_SPP_OK));
+
+    start = SPP_HAL_getTimeMs();
+    do
+    {
+        (void)SPP_SERVICES_callProducers();
+        passes++;
+    } while ((SPP_HAL_getTimeMs() - start) < 7U);
+
+    /* At most one call per period, however many passes the loop made. */
+    assert_that(s_prod.calls >= 1U, is_true);
+    assert_that(s_prod.calls <= 4U, is_true);
+    assert_that(passes > s_prod.calls, is_true);
+}
+
+Ensure(SPP_SERVICES_callProducers, bind_timer_rejects_bad_arguments)
+{
+    static TestProducer_t s_prod;
+    static SPP_Timer_t    s_timer;
+
+    memset(&s_prod, 0, sizeof(s_prod));
+    assert_that(SPP_SERVICES_bindTimer(&s_prod, &s_timer, 10U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    (void)SPP_SERVICES_register(&k_polledModule, &s_prod);
+    assert_that(SPP_SERVICES_bindTimer(&s_prod, &s_timer, 0U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_bindTimer(&s_prod, NULL, 10U), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+
+    /* Bound after all, so it is no longer polled on every pass. */
+    assert_that(SPP_SERVICES_bindTimer(&s_prod, &s_timer, 10U), is_equal_to(K_SPP_OK));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_idle
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_idle);
+BeforeEach(SPP_SERVICES_idle) { serviceSetup(); }
+AfterEach(SPP_SERVICES_idle)  {}
+
+Ensure(SPP_SERVICES_idle, is_idle_only_with_nothing_ready_or_queued)
+{
+    static TestProducer_t s_bound;
+    static TestProducer_t s_polled;
+    SPP_Packet_t         *p_pkt;
+
+    memset(&s_bound, 0, sizeof(s_bound));
+    memset(&s_polled, 0, sizeof(s_polled));
+    (void)SPP_SERVICES_register(&k_boundModule, &s_bound);
+    assert_that(SPP_SERVICES_idle(0U), is_false);
+    (void)SPP_SERVICES_callProducers();
+    assert_that(SPP_SERVICES_idle(0U), is_true);
+
+    fireIsr(&s_bound);
+    assert_that(SPP_SERVICES_idle(0U), is_false);
+    (void)SPP_SERVICES_callProducers();
+    assert_that(SPP_SERVICES_idle(0U), is_true);
+
+    /* Queued deferred work keeps the loop awake. */
+    (void)SPP_SERVICES_PUBSUB_subscribe(K_TEST_SERVICE_APID, K_SPP_PUBSUB_PRIO_LOW,
+                                        countingHandler, NULL);
+    p_pkt = SPP_SERVICES_DATABANK_getPacketSized(4U);
+    (void)SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_TEST_SERVICE_APID, 0U);
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, 4U);
+    (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+    assert_that(SPP_SERVICES_idle(0U), is_false);
+    SPP_SERVICES_callConsumers();
+    assert_that(SPP_SERVICES_idle(0U), is_true);
+
+    /* A module without a bound interrupt is polled on every pass. */
+    (void)SPP_SERVICES_register(&k_polledModule, &s_polled);
+    assert_that(SPP_SERVICES_idle(0U), is_false);
+    (void)SPP_SERVICES_callProducers();
+    (void)SPP_SERVICES_callProducers();
+    assert_that(s_polled.calls, is_equal_to(2U));
+    assert_that(s_bound.calls, is_equal_to(2U));
+}
+
+Ensure(SPP_SERVICES_idle, sleeps_with_the_sd_logger_registered)
+{
+    static Datalogger_t s_logger;
+    SPP_Packet_t       *p_pkt;
+
+    memset(&s_logger, 0, sizeof(s_logger));
+    s_logger.p_filePath = K_TEST_LOG_PATH;
+    assert_that(SPP_SERVICES_register(&g_sdLoggerModule, &s_logger), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_idle(0U), is_true);
+
+    /* A held packet arms the hold timer; nothing is polled for it. */
+    p_pkt = SPP_SERVICES_DATABANK_getPacketSized(4U);
+    (void)SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_TEST_SERVICE_APID, 0U);
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, 4U);
+    (void)SPP_SERVICES_PUBSUB_publish(p_pkt);
+    SPP_SERVICES_callConsumers();
+    assert_that(s_logger.batch_count, is_equal_to(1U));
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_not_equal_to(K_SPP_TIMER_NONE));
+    assert_that(SPP_SERVICES_idle(0U), is_true);
+
+    /* The timer writes the batch once it has been held long enough. */
+    (void)SPP_SERVICES_TIMER_advance(SPP_HAL_getTimeMs() + K_SPP_DATALOGGER_MAX_HOLD_MS + 1U);
+    assert_that(s_logger.batch_count, is_equal_to(0U));
+    assert_that(s_logger.logged_packets, is_equal_to(1U));
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(K_SPP_TIMER_NONE));
+    assert_that(SPP_SERVICES_DATABANK_freeCount(), is_equal_to(K_SPP_DATABANK_SIZE));
+
+    (void)SPP_SERVICES_DATALOGGER_deinit(&s_logger);
+    (void)remove(K_TEST_LOG_PATH);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_DATALOGGER
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_DATALOGGER);
+BeforeEach(SPP_SERVICES_DATALOGGER) { serviceSetup(); }
+AfterEach(SPP_SERVICES_DATALOGGER)  {}
+
+/* Write one log segment straight to the logger, as pub/sub would. */
+static void logSegment(Datalogger_t *p_logger, spp_uint16_t seq, spp_uint8_t flags,
+                       const char *p_text, spp_uint16_t len)
+{
+    SPP_Packet_t *p_pkt = SPP_SERVICES_DATABANK_getPacketSized(len);
+    spp_uint8_t  *p_out = SPP_SERVICES_DATABANK_packetBegin(p_pkt, K_SPP_APID_LOG, seq);
+
+    memcpy(p_out, p_text, len);
+    (void)SPP_SERVICES_DATABANK_packetCommit(p_pkt, len);
+    p_pkt->primaryHeader.seqFlags = flags;
+    (void)SPP_SERVICES_DATALOGGER_logPacket(p_logger, p_pkt);
+    (void)SPP_SERVICES_DATABANK_returnPacket(p_pkt);
+}
+
+Ensure(SPP_SERVICES_DATALOGGER, cuts_log_lines_that_lost_segments)
+{
+    static Datalogger_t s_logger;
+    char                text[96] = { 0 };
+    FILE               *p_file;
+    size_t              n;
+
+    memset(&s_logger, 0, sizeof(s_logger));
+    s_logger.p_filePath = K_TEST_LOG_PATH;
+    assert_that(SPP_SERVICES_DATALOGGER_init(&s_logger), is_equal_to(K_SPP_OK));
+
+    logSegment(&s_logger, 0U, K_SPP_PKT_SEQ_FIRST, "ab", 2U);      /* LAST lost.      */
+    logSegment(&s_logger, 3U, K_SPP_PKT_SEQ_UNSEGMENTED, "x", 2U); /* Next line.      */
+    logSegment(&s_logger, 4U, K_SPP_PKT_SEQ_FIRST, "cd", 2U);
+    logSegment(&s_logger, 6U, K_SPP_PKT_SEQ_LAST, "f", 2U);        /* seq 5 lost.     */
+    logSegment(&s_logger, 7U, K_SPP_PKT_SEQ_FIRST, "gh", 2U);
+    logSegment(&s_logger, 8U, K_SPP_PKT_SEQ_LAST, "i", 2U);        /* Whole line.     */
+    (void)SPP_SERVICES_DATALOGGER_deinit(&s_logger);
+
+    p_file = fopen(K_TEST_LOG_PATH, "r");
+    assert_that(p_file, is_non_null);
+    n = fread(text, 1U, sizeof(text) - 1U, p_file);
+    (void)fclose(p_file);
+    (void)remove(K_TEST_LOG_PATH);
+
+    text[n] = '\0';
+    assert_that(text, is_equal_to_string("ab [truncated]\n"
+                                         "x\n"
+                                         "cd [truncated]\n"
+                                         "[truncated] f\n"
+                                         "ghi\n"));
+}
+
+/* ----------------------------------------------------------------
+ * Suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *service_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("service");
+
+    add_test_with_context(suite, SPP_SERVICES_register, failed_init_leaves_no_binding_behind);
+    add_test_with_context(suite, SPP_SERVICES_callProducers, visits_bound_modules_only_after_their_isr_fired);
+    add_test_with_context(suite, SPP_SERVICES_callProducers, bind_rejects_unknown_context);
+    add_test_with_context(suite, SPP_SERVICES_callProducers, visits_timer_bound_modules_once_per_period);
+    add_test_with_context(suite, SPP_SERVICES_callProducers, bind_timer_rejects_bad_arguments);
+
+    add_test_with_context(suite, SPP_SERVICES_idle, sleeps_with_the_sd_logger_registered);
+    add_test_with_context(suite, SPP_SERVICES_idle, is_idle_only_with_nothing_ready_or_queued);
+    add_test_with_context(suite, SPP_SERVICES_DATALOGGER, cuts_log_lines_that_lost_segments);
+
+    return suite;
+}
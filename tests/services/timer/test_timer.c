@@ -0,0 +1,245 @@
+/**
+ * @file test_timer.c
+ * @brief BDD unit tests for the timer wheel.
+ *
+ * Coverage targets:
+ *  - SPP_SERVICES_TIMER_start()     — one-shot and periodic expiry ticks,
+ *    delays on every wheel level, argument checks
+ *  - SPP_SERVICES_TIMER_advance()   — cascades, catch-up, skipped periods,
+ *    start / cancel from callbacks
+ *  - SPP_SERVICES_TIMER_msToNext()  — next expiry and cascade bound
+ *  - SPP_SERVICES_TIMER_getStats()  — fires, skipped, lateness
+ *
+ * The wheel is driven with explicit times through advance(), so nothing
+ * here depends on how fast the host runs.
+ */
+
+#include <cgreen/cgreen.h>
+#include "spp/services/timer/timer.h"
+#include "spp/core/returnTypes.h"
+#include "spp/core/core.h"
+#include "spp/hal/time.h"
+
+#include <string.h>
+
+extern const SPP_HalPort_t g_stubHalPort;
+
+typedef struct
+{
+    spp_uint32_t  fires;
+    SPP_Timer_t  *p_cancel;  /* Cancelled from the callback, if set.    */
+    spp_uint32_t  restartMs; /* Restarted as a one-shot after this, if set. */
+    SPP_Timer_t  *p_self;
+} TestTimerCtx_t;
+
+static spp_uint32_t s_base;
+
+static void countingCallback(void *p_ctx)
+{
+    TestTimerCtx_t *p_tc = (TestTimerCtx_t *)p_ctx;
+
+    p_tc->fires++;
+    if (p_tc->p_cancel != NULL)
+    {
+        (void)SPP_SERVICES_TIMER_cancel(p_tc->p_cancel);
+    }
+    if (p_tc->restartMs != 0U)
+    {
+        (void)SPP_SERVICES_TIMER_start(p_tc->p_self, p_tc->restartMs, 0U);
+        p_tc->restartMs = 0U;
+    }
+}
+
+static void timerSetup(void)
+{
+    (void)SPP_CORE_setHalPort(&g_stubHalPort);
+    SPP_SERVICES_TIMER_init();
+    s_base = SPP_HAL_getTimeMs();
+    (void)SPP_SERVICES_TIMER_advance(s_base);
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_TIMER_start
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_TIMER_start);
+BeforeEach(SPP_SERVICES_TIMER_start) { timerSetup(); }
+AfterEach(SPP_SERVICES_TIMER_start)  {}
+
+Ensure(SPP_SERVICES_TIMER_start, one_shot_fires_once_on_its_due_tick)
+{
+    static SPP_Timer_t s_t;
+    TestTimerCtx_t     tc;
+
+    memset(&tc, 0, sizeof(tc));
+    assert_that(SPP_SERVICES_TIMER_setup(&s_t, countingCallback, &tc), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_TIMER_start(&s_t, 10U, 0U), is_equal_to(K_SPP_OK));
+    assert_that(SPP_SERVICES_TIMER_isActive(&s_t), is_true);
+
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 9U), is_equal_to(0U));
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 10U), is_equal_to(1U));
+    assert_that(SPP_SERVICES_TIMER_isActive(&s_t), is_false);
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 500U), is_equal_to(0U));
+    assert_that(tc.fires, is_equal_to(1U));
+}
+
+Ensure(SPP_SERVICES_TIMER_start, expires_exactly_on_every_wheel_level)
+{
+    static const spp_uint32_t k_delays[] = { 1U, 63U, 64U, 65U, 4095U, 4096U, 70000U, 300000U };
+    static SPP_Timer_t        s_t[sizeof(k_delays) / sizeof(k_delays[0])];
+    static TestTimerCtx_t     s_tc[sizeof(k_delays) / sizeof(k_delays[0])];
+    spp_uint32_t              i;
+
+    memset(s_tc, 0, sizeof(s_tc));
+    for (i = 0U; i < (sizeof(k_delays) / sizeof(k_delays[0])); i++)
+    {
+        (void)SPP_SERVICES_TIMER_setup(&s_t[i], countingCallback, &s_tc[i]);
+        (void)SPP_SERVICES_TIMER_start(&s_t[i], k_delays[i], 0U);
+    }
+
+    for (i = 0U; i < (sizeof(k_delays) / sizeof(k_delays[0])); i++)
+    {
+        (void)SPP_SERVICES_TIMER_advance(s_base + k_delays[i] - 1U);
+        assert_that(s_tc[i].fires, is_equal_to(0U));
+        (void)SPP_SERVICES_TIMER_advance(s_base + k_delays[i]);
+        assert_that(s_tc[i].fires, is_equal_to(1U));
+    }
+}
+
+Ensure(SPP_SERVICES_TIMER_start, rejects_bad_arguments)
+{
+    static SPP_Timer_t s_t;
+    TestTimerCtx_t     tc;
+
+    memset(&s_t, 0, sizeof(s_t));
+    assert_that(SPP_SERVICES_TIMER_start(&s_t, 1U, 0U), is_equal_to(K_SPP_ERROR_NOT_INITIALIZED));
+    assert_that(SPP_SERVICES_TIMER_start(NULL, 1U, 0U), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+    assert_that(SPP_SERVICES_TIMER_setup(&s_t, NULL, NULL), is_equal_to(K_SPP_ERROR_NULL_POINTER));
+
+    (void)SPP_SERVICES_TIMER_setup(&s_t, countingCallback, &tc);
+    assert_that(SPP_SERVICES_TIMER_start(&s_t, K_SPP_TIMER_MAX_MS + 1U, 0U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_TIMER_start(&s_t, 1U, K_SPP_TIMER_MAX_MS + 1U),
+                is_equal_to(K_SPP_ERROR_INVALID_PARAMETER));
+    assert_that(SPP_SERVICES_TIMER_isActive(&s_t), is_false);
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(K_SPP_TIMER_NONE));
+}
+
+/* ----------------------------------------------------------------
+ * Describe: SPP_SERVICES_TIMER_advance
+ * ---------------------------------------------------------------- */
+
+Describe(SPP_SERVICES_TIMER_advance);
+BeforeEach(SPP_SERVICES_TIMER_advance) { timerSetup(); }
+AfterEach(SPP_SERVICES_TIMER_advance)  {}
+
+Ensure(SPP_SERVICES_TIMER_advance, periodic_keeps_its_phase_and_skips_missed_periods)
+{
+    static SPP_Timer_t s_t;
+    TestTimerCtx_t     tc;
+    SPP_TimerStats_t   stats;
+
+    memset(&tc, 0, sizeof(tc));
+    (void)SPP_SERVICES_TIMER_setup(&s_t, countingCallback, &tc);
+    (void)SPP_SERVICES_TIMER_start(&s_t, 5U, 10U);
+
+    (void)SPP_SERVICES_TIMER_advance(s_base + 5U);
+    /* Two ticks late: the next expiry is still at +25, not +27. */
+    (void)SPP_SERVICES_TIMER_advance(s_base + 17U);
+    (void)SPP_SERVICES_TIMER_advance(s_base + 24U);
+    assert_that(tc.fires, is_equal_to(2U));
+
+    /* +25 seen at +49: one call, +35 and +45 dropped, next at +55. */
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 49U), is_equal_to(1U));
+    (void)SPP_SERVICES_TIMER_advance(s_base + 54U);
+    assert_that(tc.fires, is_equal_to(3U));
+    (void)SPP_SERVICES_TIMER_advance(s_base + 55U);
+    assert_that(tc.fires, is_equal_to(4U));
+
+    assert_that(SPP_SERVICES_TIMER_getStats(&s_t, &stats), is_equal_to(K_SPP_OK));
+    assert_that(stats.fires, is_equal_to(4U));
+    assert_that(stats.skipped, is_equal_to(2U));
+    assert_that(stats.lateMaxMs, is_equal_to(24U));
+    assert_that(stats.jitterSamples, is_equal_to(3U));
+    assert_that(stats.jitterMinUs <= stats.jitterMaxUs, is_true);
+}
+
+Ensure(SPP_SERVICES_TIMER_advance, callbacks_may_cancel_and_restart_timers)
+{
+    static SPP_Timer_t s_a;
+    static SPP_Timer_t s_b;
+    TestTimerCtx_t     tcA;
+    TestTimerCtx_t     tcB;
+
+    memset(&tcA, 0, sizeof(tcA));
+    memset(&tcB, 0, sizeof(tcB));
+    (void)SPP_SERVICES_TIMER_setup(&s_a, countingCallback, &tcA);
+    (void)SPP_SERVICES_TIMER_setup(&s_b, countingCallback, &tcB);
+
+    /* Both due on the same tick; whichever runs first cancels the other. */
+    tcA.p_cancel  = &s_b;
+    tcA.p_self    = &s_a;
+    tcA.restartMs = 3U;
+    tcB.p_cancel  = &s_a;
+    (void)SPP_SERVICES_TIMER_start(&s_a, 7U, 0U);
+    (void)SPP_SERVICES_TIMER_start(&s_b, 7U, 0U);
+
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 7U), is_equal_to(1U));
+    assert_that(tcA.fires + tcB.fires, is_equal_to(1U));
+
+    if (tcA.fires == 1U)
+    {
+        /* A restarted itself for +10. */
+        tcA.p_cancel = NULL;
+        assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(3U));
+        (void)SPP_SERVICES_TIMER_advance(s_base + 10U);
+        assert_that(tcA.fires, is_equal_to(2U));
+    }
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(K_SPP_TIMER_NONE));
+}
+
+Ensure(SPP_SERVICES_TIMER_advance, reports_time_to_next_expiry)
+{
+    static SPP_Timer_t s_near;
+    static SPP_Timer_t s_far;
+    TestTimerCtx_t     tc;
+    spp_uint32_t       next;
+
+    memset(&tc, 0, sizeof(tc));
+    (void)SPP_SERVICES_TIMER_setup(&s_near, countingCallback, &tc);
+    (void)SPP_SERVICES_TIMER_setup(&s_far, countingCallback, &tc);
+    (void)SPP_SERVICES_TIMER_start(&s_far, 5000U, 0U);
+    (void)SPP_SERVICES_TIMER_start(&s_near, 20U, 0U);
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(20U));
+
+    /* Only the far timer left: a bound no later than its expiry. */
+    (void)SPP_SERVICES_TIMER_cancel(&s_near);
+    next = SPP_SERVICES_TIMER_msToNext();
+    assert_that(next >= 1U, is_true);
+    assert_that(next <= 5000U, is_true);
+
+    (void)SPP_SERVICES_TIMER_cancel(&s_far);
+    assert_that(SPP_SERVICES_TIMER_isActive(&s_far), is_false);
+    assert_that(SPP_SERVICES_TIMER_msToNext(), is_equal_to(K_SPP_TIMER_NONE));
+    assert_that(SPP_SERVICES_TIMER_advance(s_base + 6000U), is_equal_to(0U));
+    assert_that(tc.fires, is_equal_to(0U));
+}
+
+/* ----------------------------------------------------------------
+ * Suite factory
+ * ---------------------------------------------------------------- */
+
+TestSuite *timer_suite(void)
+{
+    TestSuite *suite = create_named_test_suite("timer");
+
+    add_test_with_context(suite, SPP_SERVICES_TIMER_start, one_shot_fires_once_on_its_due_tick);
+    add_test_with_context(suite, SPP_SERVICES_TIMER_start, expires_exactly_on_every_wheel_level);
+    add_test_with_context(suite, SPP_SERVICES_TIMER_start, rejects_bad_arguments);
+
+    add_test_with_context(suite, SPP_SERVICES_TIMER_advance, periodic_keeps_its_phase_and_skips_missed_periods);
+    add_test_with_context(suite, SPP_SERVICES_TIMER_advance, callbacks_may_cancel_and_restart_timers);
+    add_test_with_context(suite, SPP_SERVICES_TIMER_advance, reports_time_to_next_expiry);
+
+    return suite;
+}
@@ -7,8 +7,12 @@
 
 spp_uint16_t SPP_UTIL_crc16(const spp_uint8_t *p_data, spp_uint32_t length)
 {
-    spp_uint16_t crc = K_SPP_CRC_INIT;
+    return SPP_UTIL_crc16Update((spp_uint16_t)K_SPP_CRC_INIT, p_data, length);
+}
 
+spp_uint16_t SPP_UTIL_crc16Update(spp_uint16_t crc, const spp_uint8_t *p_data,
+                                  spp_uint32_t length)
+{
     for (spp_uint32_t i = 0U; i < length; i++)
     {
         crc ^= (spp_uint16_t)((spp_uint16_t)p_data[i] << 8U);
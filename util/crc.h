@@ -4,7 +4,7 @@
  *
  * Naming conventions used in this file:
  * - Constants/macros: K_SPP_CRC_*
- * - Public functions: SPP_UTIL_crc16()
+ * - Public functions: SPP_UTIL_crc16*()
  */
 
 #ifndef SPP_CRC_H
@@ -36,4 +36,19 @@
  */
 spp_uint16_t SPP_UTIL_crc16(const spp_uint8_t *p_data, spp_uint32_t length);
 
+/**
+ * @brief Continue a CRC-16/CCITT over another, non-contiguous buffer.
+ *
+ * @c SPP_UTIL_crc16Update(SPP_UTIL_crc16(a, n), b, m) equals the CRC of
+ * @c a followed by @c b.
+ *
+ * @param[in] crc      Running CRC (start from K_SPP_CRC_INIT).
+ * @param[in] p_data   Pointer to the next data chunk.
+ * @param[in] length   Number of bytes to process.
+ *
+ * @return Updated 16-bit CRC value.
+ */
+spp_uint16_t SPP_UTIL_crc16Update(spp_uint16_t crc, const spp_uint8_t *p_data,
+                                  spp_uint32_t length);
+
 #endif /* SPP_CRC_H */
@@ -38,16 +38,103 @@
 #define SPP_NO_STORAGE 0
 #endif
 
+/**
+ * @brief Disable pub/sub latency and execution-time histograms.
+ *
+ * When set, the stats types and SPP_SERVICES_PUBSUB_*Stats() functions are
+ * not compiled and publish/dispatch read no timestamps.
+ */
+#ifndef SPP_NO_PUBSUB_STATS
+#define SPP_NO_PUBSUB_STATS 0
+#endif
+
+/* ----------------------------------------------------------------
+ * Feature-enable flags
+ * (Define to 1 in CMake to enable the feature)
+ * ---------------------------------------------------------------- */
+
+/**
+ * @brief Build the databank free list as a lock-free tagged stack.
+ *
+ * When set, SPP_SERVICES_DATABANK_getPacket() and returnPacket() may be
+ * called concurrently from GPIO ISRs and from a second core.  Requires C11
+ * <stdatomic.h> with lock-free 32-bit compare-and-swap (ESP32-S3, any
+ * posix host).  Leave at 0 for single-threaded superloops — the plain
+ * stack is cheaper.
+ */
+#ifndef SPP_DATABANK_LOCKFREE
+#define SPP_DATABANK_LOCKFREE 0
+#endif
+
+/**
+ * @brief Accept publish() calls from GPIO ISRs and from a second core.
+ *
+ * When set, SPP_SERVICES_PUBSUB_publish() runs SYNC subscribers in the
+ * caller's context and hands the packet to a lock-free multi-producer
+ * intake list; the superloop moves it into the deferred queues on its next
+ * callConsumers().  Requires SPP_DATABANK_LOCKFREE.  Subscribe before any
+ * producer starts.
+ */
+#ifndef SPP_PUBSUB_MPSC
+#define SPP_PUBSUB_MPSC 0
+#endif
+
 /* ----------------------------------------------------------------
  * Capacity constants
  * ---------------------------------------------------------------- */
 
-/** @brief Number of packets in the static databank pool. */
-#ifndef K_SPP_DATABANK_SIZE
-#define K_SPP_DATABANK_SIZE (50U)
+/*
+ * Databank size classes.  Each class is a separate pool of packets whose
+ * payload area is exactly *_PAYLOAD bytes; SPP_SERVICES_DATABANK_getPacketSized()
+ * picks the smallest class that fits and falls back upward.  Payload sizes
+ * must be strictly ascending and the largest must not exceed
+ * K_SPP_PKT_PAYLOAD_MAX.  A class may be disabled by setting its count to 0.
+ */
+
+/** @brief Payload capacity of the small databank class (bytes). */
+#ifndef K_SPP_DATABANK_SMALL_PAYLOAD
+#define K_SPP_DATABANK_SMALL_PAYLOAD (16U)
+#endif
+
+/** @brief Number of packets in the small databank class. */
+#ifndef K_SPP_DATABANK_SMALL_COUNT
+#define K_SPP_DATABANK_SMALL_COUNT (16U)
+#endif
+
+/** @brief Payload capacity of the medium databank class (bytes). */
+#ifndef K_SPP_DATABANK_MEDIUM_PAYLOAD
+#define K_SPP_DATABANK_MEDIUM_PAYLOAD (48U)
+#endif
+
+/** @brief Number of packets in the medium databank class. */
+#ifndef K_SPP_DATABANK_MEDIUM_COUNT
+#define K_SPP_DATABANK_MEDIUM_COUNT (40U)
+#endif
+
+/** @brief Payload capacity of the large databank class (bytes). */
+#ifndef K_SPP_DATABANK_LARGE_PAYLOAD
+#define K_SPP_DATABANK_LARGE_PAYLOAD (256U)
 #endif
 
-/** @brief Maximum number of pub/sub subscribers that can be registered. */
+/** @brief Number of packets in the large databank class. */
+#ifndef K_SPP_DATABANK_LARGE_COUNT
+#define K_SPP_DATABANK_LARGE_COUNT (1U)
+#endif
+
+#ifdef K_SPP_DATABANK_SIZE
+#error "K_SPP_DATABANK_SIZE is derived — set K_SPP_DATABANK_<CLASS>_COUNT instead"
+#endif
+
+/** @brief Total number of packets in the static databank pool (all classes). */
+#define K_SPP_DATABANK_SIZE \
+    (K_SPP_DATABANK_SMALL_COUNT + K_SPP_DATABANK_MEDIUM_COUNT + K_SPP_DATABANK_LARGE_COUNT)
+
+/** @brief Maximum number of APIDs with a databank quota or reservation. */
+#ifndef K_SPP_DATABANK_MAX_QUOTAS
+#define K_SPP_DATABANK_MAX_QUOTAS (8U)
+#endif
+
+/** @brief Maximum number of pub/sub subscribers that can be registered (≤ 32). */
 #ifndef K_SPP_PUBSUB_MAX_SUBSCRIBERS
 #define K_SPP_PUBSUB_MAX_SUBSCRIBERS (8U)
 #endif
@@ -61,16 +148,110 @@
  * Pub/sub constants
  * ---------------------------------------------------------------- */
 
-/** @brief APID bitmask meaning "no APID — module neither produces nor consumes". */
+/** @brief APID 0, meaning "no APID — module neither produces nor consumes". */
 #ifndef K_SPP_APID_NONE
 #define K_SPP_APID_NONE (0x0000U)
 #endif
 
-/** @brief Deferred dispatch ring-buffer size.  Must be a power of 2. */
-#ifndef K_SPP_PUBSUB_QUEUE_SIZE
-#define K_SPP_PUBSUB_QUEUE_SIZE (16U)
+#ifdef K_SPP_PUBSUB_QUEUE_SIZE
+#error "K_SPP_PUBSUB_QUEUE_SIZE is gone — deferred queues hold any pool packet; see K_SPP_PUBSUB_QUEUE_LIMIT"
+#endif
+
+/** @brief Default depth limit of each deferred pub/sub level (0 = bounded
+ *  only by the databank pool).  See SPP_SERVICES_PUBSUB_setQueueLimit(). */
+#ifndef K_SPP_PUBSUB_QUEUE_LIMIT
+#define K_SPP_PUBSUB_QUEUE_LIMIT (0U)
+#endif
+
+/** @brief APIDs with their own overflow policy, counters and stats; others
+ *  share one catch-all entry.  Power of 2, ≤ 128. */
+#ifndef K_SPP_PUBSUB_MAX_APIDS
+#define K_SPP_PUBSUB_MAX_APIDS (16U)
+#endif
+
+/** @brief Routing blocks for 32-APID pages that a subscription covers only
+ *  in part (128 B each with 32-bit masks).  Pages covered completely, and
+ *  wildcard subscriptions, need none. */
+#ifndef K_SPP_PUBSUB_ROUTE_BLOCKS
+#define K_SPP_PUBSUB_ROUTE_BLOCKS (8U)
+#endif
+
+/** @brief Packets SPP_SERVICES_PUBSUB_publishMany() matches and hands to a
+ *  batch handler at once (sizes two arrays on the caller's stack). */
+#ifndef K_SPP_PUBSUB_BATCH_MAX
+#define K_SPP_PUBSUB_BATCH_MAX (16U)
+#endif
+
+/** @brief Number of pub/sub consumer groups (group ids 1 … this). */
+#ifndef K_SPP_PUBSUB_MAX_GROUPS
+#define K_SPP_PUBSUB_MAX_GROUPS (4U)
+#endif
+
+/** @brief Size of the spill ring SPP_SERVICES_PUBSUB_setSpill() writes
+ *  (bytes); once the packets waiting fill it, the overflow policy applies. */
+#ifndef K_SPP_PUBSUB_SPILL_MAX_BYTES
+#define K_SPP_PUBSUB_SPILL_MAX_BYTES (1048576UL)
+#endif
+
+#ifdef K_SPP_PUBSUB_INTAKE_SIZE
+#error "K_SPP_PUBSUB_INTAKE_SIZE is gone — the MPSC intake is threaded through the packets"
+#endif
+
+/** @brief Buckets per pub/sub latency histogram; bucket b counts samples in
+ *  [2^(b-1), 2^b) µs, the last one everything above. */
+#ifndef K_SPP_PUBSUB_HIST_BUCKETS
+#define K_SPP_PUBSUB_HIST_BUCKETS (16U)
 #endif
 
 /* Subscriber dispatch priorities — defined in pubsub.h */
 
+/* ----------------------------------------------------------------
+ * Segmentation constants
+ * ---------------------------------------------------------------- */
+
+/** @brief Payload bytes carried by each segment of a segmented record.
+ *  The medium class is the most plentiful, so long log lines do not
+ *  compete for the few large packets. */
+#ifndef K_SPP_SEGMENT_CHUNK
+#define K_SPP_SEGMENT_CHUNK K_SPP_DATABANK_MEDIUM_PAYLOAD
+#endif
+
+/** @brief Largest record one reassembly buffer can rebuild (bytes). */
+#ifndef K_SPP_SEGMENT_MAX_RECORD
+#define K_SPP_SEGMENT_MAX_RECORD (1024U)
+#endif
+
+/* ----------------------------------------------------------------
+ * Blackboard constants
+ * ---------------------------------------------------------------- */
+
+/** @brief APIDs the latest-value blackboard can track (at most 32). */
+#ifndef K_SPP_BLACKBOARD_ENTRIES
+#define K_SPP_BLACKBOARD_ENTRIES (4U)
+#endif
+
+/** @brief Payload bytes kept per tracked APID; longer packets are truncated. */
+#ifndef K_SPP_BLACKBOARD_PAYLOAD
+#define K_SPP_BLACKBOARD_PAYLOAD K_SPP_DATABANK_MEDIUM_PAYLOAD
+#endif
+
+/** @brief Attempts a blackboard read makes while a writer keeps overtaking it. */
+#ifndef K_SPP_BLACKBOARD_READ_RETRIES
+#define K_SPP_BLACKBOARD_READ_RETRIES (8U)
+#endif
+
+/* ----------------------------------------------------------------
+ * Timer wheel constants
+ * ---------------------------------------------------------------- */
+
+/** @brief log2 of the slots per timer wheel level (1 ms per level-0 slot). */
+#ifndef K_SPP_TIMER_WHEEL_BITS
+#define K_SPP_TIMER_WHEEL_BITS (6U)
+#endif
+
+/** @brief Timer wheel levels; delays up to 2^(BITS * LEVELS) ms fit. */
+#ifndef K_SPP_TIMER_LEVELS
+#define K_SPP_TIMER_LEVELS (4U)
+#endif
+
 #endif /* SPP_MACROS_H */